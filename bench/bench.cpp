@@ -0,0 +1,1644 @@
+#include "../include/vector.hpp"
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+#include "../include/priority_queue.hpp"
+#include "../include/linkedlist.hpp"
+#include "../include/deque.hpp"
+#include "../include/intrusive.hpp"
+#include "../include/async_channel.hpp"
+#include "../include/queue.hpp"
+#include "../include/compact_tree.hpp"
+#include "../include/bloom_filter.hpp"
+#include "../include/node_allocator.hpp"
+#include "../include/static_map.hpp"
+#include "../include/concurrent_ordered_map.hpp"
+#include "../include/debug.hpp"
+#include "../include/lru_cache.hpp"
+#include "../include/art_map.hpp"
+#include "../include/string_pool.hpp"
+#include "../include/bitmap_set.hpp"
+#include "../include/stack.hpp"
+#include "../include/concurrent_stack.hpp"
+#include "../include/mapped_storage.hpp"
+#include "../include/sparse_map.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <optional>
+#include <cstring>
+#include <fstream>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Runs fn once and returns the elapsed wall-clock time in milliseconds
+template <typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = chrono::steady_clock::now();
+    fn();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void report(const char* name, double ms, size_t checksum) {
+    cout << "  " << name << ": " << ms << " ms (checksum " << checksum << ")\n";
+}
+
+void benchStringLookup() {
+    cout << "\n=== BENCH: STRING-KEYED LOOKUP ===\n";
+    
+    const int N = 200000;
+    const int ROUNDS = 5;
+    
+    // Keys well past the small-string limit so every temporary std::string allocates
+    Vector<string> keys;
+    for (int i = 0; i < N; ++i) {
+        keys.push_back("tenant/eu-west-1/session/" + to_string(i * 7919) + "/profile");
+    }
+    
+    Map<string, int> plain;
+    Map<string, int, std::less<>> transparent;
+    Set<string> plainSet;
+    Set<string, std::less<>> transparentSet;
+    for (int i = 0; i < N; ++i) {
+        plain.insert(keys[i], i);
+        transparent.insert(keys[i], i);
+        plainSet.insert(keys[i]);
+        transparentSet.insert(keys[i]);
+    }
+    
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i)
+                sum += *plain.find(keys[i].c_str());
+    });
+    report("Map<string, int>::find(const char*)", ms, sum);
+    
+    sum = 0;
+    ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i)
+                sum += *transparent.find(keys[i].c_str());
+    });
+    report("Map<string, int, less<>>::find(const char*)", ms, sum);
+    
+    sum = 0;
+    ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i)
+                sum += *transparent.find(string_view(keys[i]));
+    });
+    report("Map<string, int, less<>>::find(string_view)", ms, sum);
+    
+    sum = 0;
+    ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i)
+                sum += plainSet.contains(keys[i].c_str());
+    });
+    report("Set<string>::contains(const char*)", ms, sum);
+    
+    sum = 0;
+    ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i)
+                sum += transparentSet.contains(keys[i].c_str());
+    });
+    report("Set<string, less<>>::contains(const char*)", ms, sum);
+}
+
+void benchPriorityQueue() {
+    cout << "\n=== BENCH: PRIORITY QUEUE ===\n";
+    
+    const int N = 1000000;
+    mt19937 rng(42);
+    Vector<int> input;
+    for (int i = 0; i < N; ++i) input.push_back(static_cast<int>(rng()));
+    
+    auto pushPop = [&](auto& q) {
+        size_t sum = 0;
+        for (int i = 0; i < N; ++i) q.push(input[i]);
+        while (!q.empty()) {
+            sum += static_cast<unsigned>(q.top());
+            q.pop();
+        }
+        return sum;
+    };
+    
+    size_t sum = 0;
+    double ms = timeMs([&] { priority_queue<int> q; sum = pushPop(q); });
+    report("std::priority_queue push/pop", ms, sum);
+    
+    ms = timeMs([&] { PriorityQueue<int, std::less<int>, 2> q; sum = pushPop(q); });
+    report("PriorityQueue<D=2> push/pop", ms, sum);
+    
+    ms = timeMs([&] { PriorityQueue<int, std::less<int>, 4> q; sum = pushPop(q); });
+    report("PriorityQueue<D=4> push/pop", ms, sum);
+    
+    ms = timeMs([&] { PriorityQueue<int, std::less<int>, 8> q; sum = pushPop(q); });
+    report("PriorityQueue<D=8> push/pop", ms, sum);
+    
+    ms = timeMs([&] {
+        PriorityQueue<int> q;
+        q.heapify(&input[0], &input[0] + N);
+        sum = q.size();
+    });
+    report("PriorityQueue<D=4> heapify", ms, sum);
+    
+    // The scheduler workaround: ordered set of (priority, id), largest last
+    ms = timeMs([&] {
+        Set<pair<int, int>> q;
+        for (int i = 0; i < N; ++i) q.insert(make_pair(input[i], i));
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            pair<int, int> top = q.max();
+            sum += static_cast<unsigned>(top.first);
+            q.erase(top);
+        }
+    });
+    report("Set<pair<int,int>> insert/erase-max", ms, sum);
+    
+    // Dijkstra on a random sparse graph: decrease_key vs lazy deletion
+    const int V = 200000;
+    const int E = 8;
+    Vector<int> adj;
+    Vector<int> weight;
+    for (int i = 0; i < V * E; ++i) {
+        adj.push_back(static_cast<int>(rng() % V));
+        weight.push_back(static_cast<int>(rng() % 1000 + 1));
+    }
+    
+    ms = timeMs([&] {
+        Vector<long long> dist;
+        dist.resize(V, -1);
+        IndexedPriorityQueue<long long, std::greater<long long>> q(V);
+        q.push(0, 0LL);
+        while (!q.empty()) {
+            int u = static_cast<int>(q.top());
+            long long d = q.top_priority();
+            q.pop();
+            dist[u] = d;
+            for (int e = u * E; e < (u + 1) * E; ++e) {
+                int v = adj[e];
+                if (dist[v] >= 0) continue;
+                long long nd = d + weight[e];
+                if (!q.contains(v)) q.push(v, nd);
+                else if (nd < q.priority(v)) q.decrease_key(v, nd);
+            }
+        }
+        sum = 0;
+        for (int i = 0; i < V; ++i) sum += static_cast<size_t>(dist[i]);
+    });
+    report("Dijkstra IndexedPriorityQueue decrease_key", ms, sum);
+    
+    ms = timeMs([&] {
+        Vector<long long> dist;
+        dist.resize(V, -1);
+        priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> q;
+        q.push(make_pair(0LL, 0));
+        while (!q.empty()) {
+            pair<long long, int> top = q.top();
+            q.pop();
+            if (dist[top.second] >= 0) continue;
+            dist[top.second] = top.first;
+            for (int e = top.second * E; e < (top.second + 1) * E; ++e) {
+                if (dist[adj[e]] < 0) q.push(make_pair(top.first + weight[e], adj[e]));
+            }
+        }
+        sum = 0;
+        for (int i = 0; i < V; ++i) sum += static_cast<size_t>(dist[i]);
+    });
+    report("Dijkstra std::priority_queue lazy deletion", ms, sum);
+}
+
+void benchClone() {
+    cout << "\n=== BENCH: CLONE VS RE-INSERT ===\n";
+    
+    const int N = 1000000;
+    mt19937 rng(7);
+    Map<int, int> map;
+    Set<int> set;
+    LinkedList<int> list;
+    Vector<int> keys;
+    for (int i = 0; i < N; ++i) {
+        int k = static_cast<int>(rng());
+        keys.push_back(k);
+        map.insert(k, i);
+        set.insert(k);
+        list.push_back(k);
+    }
+    
+    // Re-inserting is the only way to copy without clone(); replay the keys
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        Map<int, int> copy;
+        for (int i = 0; i < N; ++i) copy.insert(keys[i], i);
+        sum = copy.size();
+    });
+    report("Map<int, int> re-insert", ms, sum);
+    
+    ms = timeMs([&] { Map<int, int> copy = map.clone(); sum = copy.size(); });
+    report("Map<int, int>::clone", ms, sum);
+    
+    ms = timeMs([&] {
+        Set<int> copy;
+        for (int i = 0; i < N; ++i) copy.insert(keys[i]);
+        sum = copy.size();
+    });
+    report("Set<int> re-insert", ms, sum);
+    
+    ms = timeMs([&] { Set<int> copy = set.clone(); sum = copy.size(); });
+    report("Set<int>::clone", ms, sum);
+    
+    ms = timeMs([&] {
+        LinkedList<int> copy;
+        for (int i = 0; i < N; ++i) copy.push_back(list[0] + keys[i]);
+        sum = copy.size();
+    });
+    report("LinkedList<int> push_back loop", ms, sum);
+    
+    ms = timeMs([&] { LinkedList<int> copy = list.clone(); sum = copy.size(); });
+    report("LinkedList<int>::clone", ms, sum);
+}
+
+void benchDeque() {
+    cout << "\n=== BENCH: DEQUE ===\n";
+    
+    const int N = 1000000;
+    size_t sum = 0;
+    
+    // FIFO churn: the window slides forward, so blocks are recycled continuously
+    double ms = timeMs([&] {
+        Deque<int> d;
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            d.push_back(i);
+            if (d.size() > 1000) {
+                sum += static_cast<size_t>(d.front());
+                d.pop_front();
+            }
+        }
+    });
+    report("Deque<int> FIFO churn", ms, sum);
+    
+    ms = timeMs([&] {
+        deque<int> d;
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            d.push_back(i);
+            if (d.size() > 1000) {
+                sum += static_cast<size_t>(d.front());
+                d.pop_front();
+            }
+        }
+    });
+    report("std::deque<int> FIFO churn", ms, sum);
+    
+    ms = timeMs([&] {
+        LinkedList<int> d;
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            d.push_back(i);
+            if (d.size() > 1000) {
+                sum += static_cast<size_t>(d.front());
+                d.pop_front();
+            }
+        }
+    });
+    report("LinkedList<int> FIFO churn", ms, sum);
+    
+    // Stack-like use of the back end: pop_back is O(n) on LinkedList
+    const int M = 20000;
+    ms = timeMs([&] {
+        Deque<int> d;
+        for (int i = 0; i < M; ++i) d.push_back(i);
+        sum = 0;
+        while (!d.empty()) {
+            sum += static_cast<size_t>(d.back());
+            d.pop_back();
+        }
+    });
+    report("Deque<int> push_back/pop_back 20k", ms, sum);
+    
+    ms = timeMs([&] {
+        LinkedList<int> d;
+        for (int i = 0; i < M; ++i) d.push_back(i);
+        sum = 0;
+        while (!d.empty()) {
+            sum += static_cast<size_t>(d.back());
+            d.pop_back();
+        }
+    });
+    report("LinkedList<int> push_back/pop_back 20k", ms, sum);
+    
+    // Random access by index
+    Deque<int> d;
+    for (int i = 0; i < N; ++i) d.push_front(i);
+    ms = timeMs([&] {
+        sum = 0;
+        for (int r = 0; r < 10; ++r)
+            for (int i = 0; i < N; ++i) sum += static_cast<size_t>(d[static_cast<size_t>(i)]);
+    });
+    report("Deque<int> operator[] 10M", ms, sum);
+}
+
+void benchNodeTransfer() {
+    cout << "\n=== BENCH: MOVING ENTRIES BETWEEN MAPS ===\n";
+    
+    const int N = 300000;
+    size_t sum = 0;
+    auto fill = [&](Map<int, string>& m) {
+        for (int i = 0; i < N; ++i) m.insert(i, "session-payload-" + to_string(i));
+    };
+    
+    Map<int, string> src;
+    fill(src);
+    double ms = timeMs([&] {
+        Map<int, string> dst;
+        for (int i = 0; i < N; ++i) {
+            string value = *src.find(i);
+            src.erase(i);
+            dst.insert(i, std::move(value));
+        }
+        sum = dst.size();
+    });
+    report("find/copy/erase/insert", ms, sum);
+    
+    Map<int, string> src2;
+    fill(src2);
+    ms = timeMs([&] {
+        Map<int, string> dst;
+        for (int i = 0; i < N; ++i) dst.insert(src2.extract(i));
+        sum = dst.size();
+    });
+    report("extract/insert(node_type)", ms, sum);
+    
+    Map<int, string> src3;
+    fill(src3);
+    ms = timeMs([&] {
+        Map<int, string> dst;
+        dst.merge(src3);
+        sum = dst.size();
+    });
+    report("merge", ms, sum);
+}
+
+struct PooledEntry {
+    int key;
+    int payload;
+    ListHook listHook;
+    MapHook mapHook;
+};
+
+void benchIntrusive() {
+    cout << "\n=== BENCH: INTRUSIVE VS ALLOCATING CONTAINERS ===\n";
+    
+    const int N = 500000;
+    const int ROUNDS = 4;
+    mt19937 rng(13);
+    
+    // Objects already live in a pool; the containers only index them
+    PooledEntry* pool = new PooledEntry[N];
+    for (int i = 0; i < N; ++i) {
+        pool[i].key = static_cast<int>(rng());
+        pool[i].payload = i;
+    }
+    
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; ++r) {
+            IntrusiveList<PooledEntry, &PooledEntry::listHook> list;
+            for (int i = 0; i < N; ++i) list.push_back(pool[i]);
+            while (!list.empty()) {
+                sum += static_cast<size_t>(list.front().payload);
+                list.pop_front();
+            }
+        }
+    });
+    report("IntrusiveList push_back/pop_front", ms, sum);
+    
+    ms = timeMs([&] {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; ++r) {
+            LinkedList<PooledEntry*> list;
+            for (int i = 0; i < N; ++i) list.push_back(&pool[i]);
+            while (!list.empty()) {
+                sum += static_cast<size_t>(list.front()->payload);
+                list.pop_front();
+            }
+        }
+    });
+    report("LinkedList<PooledEntry*> push_back/pop_front", ms, sum);
+    
+    ms = timeMs([&] {
+        IntrusiveMap<int, PooledEntry, &PooledEntry::key, &PooledEntry::mapHook> map;
+        for (int i = 0; i < N; ++i) map.insert(pool[i]);
+        sum = map.size();
+        for (int i = 0; i < N; ++i) map.erase(pool[i]);
+    });
+    report("IntrusiveMap insert/erase", ms, sum);
+    
+    ms = timeMs([&] {
+        Map<int, PooledEntry*> map;
+        for (int i = 0; i < N; ++i) map.insert(pool[i].key, &pool[i]);
+        sum = map.size();
+        for (int i = 0; i < N; ++i) map.erase(pool[i].key);
+    });
+    report("Map<int, PooledEntry*> insert/erase", ms, sum);
+    
+    delete[] pool;
+}
+
+void benchBatchedLookup() {
+    cout << "\n=== BENCH: BATCHED LOOKUP ===\n";
+    
+    // Raise N until the tree (about 48 bytes per entry) dwarfs the last-level
+    // cache of the machine under test; the gap grows with the miss rate
+    const int N = 2000000;
+    mt19937 rng(17);
+    Map<int, int> map;
+    Set<int> set;
+    for (int i = 0; i < N; ++i) {
+        int k = static_cast<int>(rng());
+        map.insert(k, i);
+        set.insert(k);
+    }
+    
+    Vector<int> queries;
+    for (int i = 0; i < N; ++i) queries.push_back(static_cast<int>(rng()));
+    Vector<int*> out;
+    out.resize(N, nullptr);
+    bool* hits = new bool[N];
+    
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < N; ++i) sum += map.find(queries[i]) != nullptr;
+    });
+    report("Map::find loop", ms, sum);
+    
+    ms = timeMs([&] {
+        map.find_batch(&queries[0], N, &out[0]);
+        sum = 0;
+        for (int i = 0; i < N; ++i) sum += out[i] != nullptr;
+    });
+    report("Map::find_batch", ms, sum);
+    
+    ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < N; ++i) sum += set.contains(queries[i]);
+    });
+    report("Set::contains loop", ms, sum);
+    
+    ms = timeMs([&] {
+        set.contains_batch(&queries[0], N, hits);
+        sum = 0;
+        for (int i = 0; i < N; ++i) sum += hits[i];
+    });
+    report("Set::contains_batch", ms, sum);
+    
+    delete[] hits;
+}
+
+Task benchProducer(AsyncChannel<int>& out, int count) {
+    for (int i = 0; i < count; ++i) co_await out.push(i);
+    out.close();
+}
+
+Task benchConsumer(AsyncChannel<int>& in, size_t& sum) {
+    while (optional<int> v = co_await in.pop()) sum += static_cast<size_t>(*v);
+}
+
+void benchAsyncChannel() {
+    cout << "\n=== BENCH: ASYNC CHANNEL HANDOFF ===\n";
+    
+    const int N = 2000000;
+    const size_t CAP = 64;
+    
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        sum = 0;
+        Scheduler scheduler;
+        AsyncChannel<int> channel(scheduler, CAP);
+        spawn(scheduler, benchConsumer(channel, sum));
+        spawn(scheduler, benchProducer(channel, N));
+        scheduler.run();
+    });
+    report("AsyncChannel on Scheduler (coroutines)", ms, sum);
+    
+    ms = timeMs([&] {
+        sum = 0;
+        ThreadPoolExecutor pool(2);
+        AsyncChannel<int> channel(pool, CAP);
+        spawn(pool, benchConsumer(channel, sum));
+        spawn(pool, benchProducer(channel, N));
+        pool.wait_idle();
+    });
+    report("AsyncChannel on ThreadPoolExecutor(2)", ms, sum);
+    
+    // Baseline: bounded Queue guarded by a mutex and two condition variables,
+    // one OS thread per side
+    ms = timeMs([&] {
+        sum = 0;
+        Queue<int> queue;
+        mutex m;
+        condition_variable notFull, notEmpty;
+        bool done = false;
+        thread consumer([&] {
+            unique_lock<mutex> lock(m);
+            while (true) {
+                notEmpty.wait(lock, [&] { return !queue.empty() || done; });
+                if (queue.empty()) break;
+                sum += static_cast<size_t>(queue.front());
+                queue.pop();
+                notFull.notify_one();
+            }
+        });
+        for (int i = 0; i < N; ++i) {
+            unique_lock<mutex> lock(m);
+            notFull.wait(lock, [&] { return queue.size() < CAP; });
+            queue.push(i);
+            notEmpty.notify_one();
+        }
+        {
+            lock_guard<mutex> lock(m);
+            done = true;
+        }
+        notEmpty.notify_one();
+        consumer.join();
+    });
+    report("Queue + mutex/condvar threads", ms, sum);
+}
+
+void benchCompactTree() {
+    cout << "\n=== BENCH: COMPACT TREE FOOTPRINT ===\n";
+    
+    const int N = 2000000;
+    mt19937 rng(19);
+    Vector<int> keys;
+    for (int i = 0; i < N; ++i) keys.push_back(static_cast<int>(rng()));
+    
+    size_t sum = 0;
+    {
+        Set<int> set;
+        double ms = timeMs([&] {
+            for (int i = 0; i < N; ++i) set.insert(keys[i]);
+        });
+        report("Set<int> insert", ms, set.size());
+        ms = timeMs([&] {
+            sum = 0;
+            for (int i = 0; i < N; ++i) sum += set.contains(keys[i] ^ (i & 1));
+        });
+        report("Set<int> contains", ms, sum);
+        MemoryUsage usage = set.memory_usage();
+        cout << "  Set<int> bytes per entry: " << usage.bytes_per_element(set.size()) << "\n";
+    }
+    {
+        CompactSet<int> set;
+        double ms = timeMs([&] {
+            for (int i = 0; i < N; ++i) set.insert(keys[i]);
+        });
+        report("CompactSet<int> insert", ms, set.size());
+        ms = timeMs([&] {
+            sum = 0;
+            for (int i = 0; i < N; ++i) sum += set.contains(keys[i] ^ (i & 1));
+        });
+        report("CompactSet<int> contains", ms, sum);
+        MemoryUsage usage = set.memory_usage();
+        cout << "  CompactSet<int> bytes per entry: " << usage.bytes_per_element(set.size()) << "\n";
+        set.shrink_to_fit();
+        usage = set.memory_usage();
+        cout << "  CompactSet<int> after shrink_to_fit: " << usage.bytes_per_element(set.size()) << "\n";
+    }
+    {
+        Map<int, int> map;
+        CompactMap<int, int> compact;
+        for (int i = 0; i < N; ++i) {
+            map.insert(keys[i], i);
+            compact.insert(keys[i], i);
+        }
+        cout << "  Map<int, int> bytes per entry: " << map.memory_usage().bytes_per_element(map.size()) << "\n";
+        cout << "  CompactMap<int, int> bytes per entry: "
+             << compact.memory_usage().bytes_per_element(compact.size()) << "\n";
+    }
+}
+
+void benchBloomFilter() {
+    cout << "\n=== BENCH: BLOOM FILTER FRONT ON MOSTLY-ABSENT LOOKUPS ===\n";
+    
+    const int N = 1000000;
+    const int Q = 4000000;
+    mt19937 rng(23);
+    Set<int> set;
+    FilteredSet<int> filtered(N, 0.01);
+    Vector<int> keys;
+    for (int i = 0; i < N; ++i) {
+        int k = static_cast<int>(rng() & 0x3ffffffe);   // even keys only
+        keys.push_back(k);
+        set.insert(k);
+        filtered.insert(k);
+    }
+    // 1 query in 20 is a stored key; the rest are odd, so absent, but spread
+    // over the same range so a miss still walks the whole tree
+    Vector<int> queries;
+    for (int i = 0; i < Q; ++i) {
+        if (i % 20 == 0) queries.push_back(keys[rng() % N]);
+        else queries.push_back(static_cast<int>(rng() & 0x3fffffff) | 1);
+    }
+    
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < Q; ++i) sum += set.contains(queries[i]);
+    });
+    report("Set::contains", ms, sum);
+    
+    ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < Q; ++i) sum += filtered.contains(queries[i]);
+    });
+    report("FilteredSet::contains (1% FPR)", ms, sum);
+    
+    filtered.set_false_positive_rate(0.001);
+    ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < Q; ++i) sum += filtered.contains(queries[i]);
+    });
+    report("FilteredSet::contains (0.1% FPR)", ms, sum);
+    cout << "  Filter bytes per key: "
+         << static_cast<double>(filtered.filter_view().bit_count()) / 8 / filtered.size() << "\n";
+}
+
+// Hands batches of node-sized blocks from producer threads to consumer
+// threads, which free them: the cross-thread pattern of a queue handoff
+template <typename Alloc, typename Free>
+double crossThreadChurn(int pairs, int batches, Alloc alloc, Free release) {
+    const size_t BATCH = 256;
+    return timeMs([&] {
+        mutex m;
+        condition_variable ready;
+        RingQueue<void**> handoff;
+        int producersLeft = pairs;
+        Vector<thread> threads;
+        for (int p = 0; p < pairs; ++p) {
+            threads.emplace_back([&] {
+                for (int b = 0; b < batches; ++b) {
+                    void** batch = new void*[BATCH];
+                    for (size_t i = 0; i < BATCH; ++i) batch[i] = alloc();
+                    lock_guard<mutex> lock(m);
+                    handoff.push(batch);
+                    ready.notify_one();
+                }
+                lock_guard<mutex> lock(m);
+                if (--producersLeft == 0) ready.notify_all();
+            });
+            threads.emplace_back([&] {
+                while (true) {
+                    void** batch;
+                    {
+                        unique_lock<mutex> lock(m);
+                        ready.wait(lock, [&] { return !handoff.empty() || producersLeft == 0; });
+                        if (handoff.empty()) return;
+                        batch = handoff.front();
+                        handoff.pop();
+                    }
+                    for (size_t i = 0; i < BATCH; ++i) release(batch[i]);
+                    delete[] batch;
+                }
+            });
+        }
+        for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    });
+}
+
+void benchNodeAllocator() {
+    cout << "\n=== BENCH: NODE ALLOCATOR ===\n";
+    
+    const int N = 4000000;
+    const size_t NODE = 48;   // a Map<int, int> node
+    Vector<void*> blocks;
+    blocks.resize(4096, nullptr);
+    
+    // Same-thread churn: allocate a window of nodes, free it, repeat
+    double ms = timeMs([&] {
+        for (int r = 0; r < N / 4096; ++r) {
+            for (size_t i = 0; i < 4096; ++i) blocks[i] = NodeAllocator::allocate(NODE);
+            for (size_t i = 0; i < 4096; ++i) NodeAllocator::deallocate(blocks[i], NODE);
+        }
+    });
+    report("NodeAllocator same-thread alloc/free", ms, N);
+    
+    ms = timeMs([&] {
+        for (int r = 0; r < N / 4096; ++r) {
+            for (size_t i = 0; i < 4096; ++i) blocks[i] = ::operator new(NODE);
+            for (size_t i = 0; i < 4096; ++i) ::operator delete(blocks[i]);
+        }
+    });
+    report("operator new/delete same-thread alloc/free", ms, N);
+    
+    const int PAIRS = 2;
+    const int BATCHES = N / 256 / PAIRS;
+    ms = crossThreadChurn(PAIRS, BATCHES, [&] { return NodeAllocator::allocate(NODE); },
+                          [&](void* p) { NodeAllocator::deallocate(p, NODE); });
+    report("NodeAllocator producer->consumer (2 pairs)", ms, N);
+    
+    ms = crossThreadChurn(PAIRS, BATCHES, [&] { return ::operator new(NODE); },
+                          [&](void* p) { ::operator delete(p); });
+    report("operator new/delete producer->consumer (2 pairs)", ms, N);
+    
+    // Containers pick the pool up through their nodes
+    ms = timeMs([&] {
+        Map<int, int> map;
+        for (int i = 0; i < N / 4; ++i) map.insert(i * 7919 % (N / 4), i);
+        for (int i = 0; i < N / 4; ++i) map.erase(i);
+    });
+    report("Map<int, int> insert/erase on pooled nodes", ms, N / 4);
+    cout << "  Slab bytes carved so far: " << NodeAllocator::slab_bytes() << "\n";
+}
+
+void benchTracer() {
+    cout << "\n=== BENCH: BINARY TRACE EVENTS VS TEXT TRACING ===\n";
+    
+    const int N = 10000000;
+    Tracer::clear();
+    double ms = timeMs([&] {
+        for (int i = 0; i < N; ++i) Tracer::record(TraceEvent::User, i, N - i);
+    });
+    report("Tracer::record", ms, N);
+    cout << "  ns per binary event: " << ms * 1e6 / N << "\n";
+    
+    Tracer::set_enabled(false);
+    ms = timeMs([&] {
+        for (int i = 0; i < N; ++i) Tracer::record(TraceEvent::User, i, N - i);
+    });
+    Tracer::set_enabled(true);
+    cout << "  ns per event while disabled at run time: " << ms * 1e6 / N << "\n";
+    
+    // What TRACE(msg) costs even before the write() system call its
+    // std::endl adds: formatting the line and flushing the stream
+    const int TEXT = N / 20;
+    ostringstream sink;
+    ms = timeMs([&] {
+        for (int i = 0; i < TEXT; ++i) {
+            sink << "[TRACE] " << __FILE__ << ":" << __LINE__ << " - " << "event " << i << " " << TEXT - i << endl;
+            if ((i & 1023) == 0) sink.str(string());
+        }
+    });
+    report("text trace line into ostringstream", ms, TEXT);
+    cout << "  ns per text event (no I/O): " << ms * 1e6 / TEXT << "\n";
+    Tracer::clear();
+}
+
+// Builds both maps from keys, then looks every probe up; M is Map or ArtMap
+template <typename M, typename Key>
+void mapBuildAndLookup(const char* name, const Vector<Key>& keys, const Vector<Key>& probes) {
+    M map;
+    double ms = timeMs([&] {
+        for (size_t i = 0; i < keys.size(); ++i) map.insert(keys[i], static_cast<int>(i));
+    });
+    report((string(name) + " insert").c_str(), ms, map.size());
+    size_t sum = 0;
+    ms = timeMs([&] {
+        for (size_t i = 0; i < probes.size(); ++i) {
+            if (int* v = map.find(probes[i])) sum += static_cast<size_t>(*v);
+        }
+    });
+    report((string(name) + " lookup").c_str(), ms, sum);
+    cout << "  bytes per entry: " << map.memory_usage().bytes_per_element(map.size()) << "\n";
+}
+
+void benchArtMap() {
+    cout << "\n=== BENCH: ADAPTIVE RADIX TREE VS MAP ===\n";
+    
+    const int N = 200000;
+    mt19937_64 rng(43);
+    
+    // URL-like keys: long shared prefixes, differing towards the end
+    const char* services[] = {"users", "orders", "inventory", "payments"};
+    Vector<string> urls;
+    for (int i = 0; i < N; ++i) {
+        urls.push_back("https://api.example.com/v2/" + string(services[rng() % 4]) + "/" + to_string(rng() % 1000000) +
+                       "/details?format=json");
+    }
+    Vector<string> urlProbes;
+    for (int i = 0; i < N * 2; ++i) urlProbes.push_back(urls[rng() % N]);
+    mapBuildAndLookup<Map<string, int>>("Map<string, int>, URL keys", urls, urlProbes);
+    mapBuildAndLookup<ArtMap<string, int>>("ArtMap<string, int>, URL keys", urls, urlProbes);
+    
+    ArtMap<string, int> routes;
+    for (int i = 0; i < N; ++i) routes.insert(urls[i], i);
+    size_t matched = 0;
+    double ms = timeMs([&] {
+        for (const char* service : services) {
+            routes.for_each_prefix("https://api.example.com/v2/" + string(service) + "/12",
+                                   [&](const string&, int) { ++matched; });
+        }
+    });
+    report("ArtMap prefix scan (4 prefixes)", ms, matched);
+    
+    Vector<uint64_t> ints;
+    for (int i = 0; i < N; ++i) ints.push_back(rng());
+    Vector<uint64_t> intProbes;
+    for (int i = 0; i < N * 2; ++i) intProbes.push_back(i % 2 ? ints[rng() % N] : rng());
+    mapBuildAndLookup<Map<uint64_t, int>>("Map<uint64_t, int>, random keys", ints, intProbes);
+    mapBuildAndLookup<ArtMap<uint64_t, int>>("ArtMap<uint64_t, int>, random keys", ints, intProbes);
+}
+
+// Heap bytes behind a std::string that memory_usage() leaves out
+size_t stringHeapBytes(const string& s) {
+    return s.capacity() > 15 ? heapBlockBytes(s.capacity() + 1) : 0;
+}
+
+void benchStringPool() {
+    cout << "\n=== BENCH: INTERNED KEYS VS STD::STRING KEYS ===\n";
+    
+    // Four maps drawing keys from one 50k vocabulary of long-ish strings,
+    // the duplication interning removes
+    const int VOCABULARY = 50000;
+    const int MAPS = 4;
+    const int PER_MAP = 40000;
+    mt19937 rng(44);
+    Vector<string> words;
+    for (int i = 0; i < VOCABULARY; ++i) words.push_back("tenant-" + to_string(rng() % 100000) + "/session/" + to_string(i));
+    Vector<int> picks;
+    for (int i = 0; i < MAPS * PER_MAP; ++i) picks.push_back(static_cast<int>(rng() % VOCABULARY));
+    
+    Vector<Map<string, int>> plain;
+    double ms = timeMs([&] {
+        for (int m = 0; m < MAPS; ++m) {
+            plain.push_back(Map<string, int>());
+            for (int i = 0; i < PER_MAP; ++i) plain[m].insert(words[picks[m * PER_MAP + i]], i);
+        }
+    });
+    size_t plainBytes = 0, entries = 0;
+    for (int m = 0; m < MAPS; ++m) {
+        plainBytes += plain[m].memory_usage().total();
+        entries += plain[m].size();
+        plain[m].for_each([&](const string& k, int) { plainBytes += stringHeapBytes(k); });
+    }
+    report("4 x Map<string, int> build", ms, entries);
+    cout << "  memory (nodes + string buffers): " << plainBytes / 1024 << " KiB\n";
+    
+    StringPool pool;
+    Vector<InternedMap<int>> interned;
+    ms = timeMs([&] {
+        for (int m = 0; m < MAPS; ++m) {
+            interned.push_back(InternedMap<int>(pool));
+            for (int i = 0; i < PER_MAP; ++i) interned[m].insert(words[picks[m * PER_MAP + i]], i);
+        }
+    });
+    size_t internedBytes = pool.memory_usage().total();
+    for (int m = 0; m < MAPS; ++m) internedBytes += interned[m].memory_usage().total();
+    report("4 x InternedMap<int> build", ms, pool.size());
+    cout << "  memory (nodes + shared pool): " << internedBytes / 1024 << " KiB\n";
+    
+    const int LOOKUPS = 1000000;
+    Vector<int> probes;
+    for (int i = 0; i < LOOKUPS; ++i) probes.push_back(static_cast<int>(rng() % VOCABULARY));
+    size_t sum = 0;
+    ms = timeMs([&] {
+        for (int i = 0; i < LOOKUPS; ++i) {
+            if (int* v = plain[i % MAPS].find(words[probes[i]])) sum += static_cast<size_t>(*v);
+        }
+    });
+    report("Map<string, int> lookup by string", ms, sum);
+    
+    sum = 0;
+    ms = timeMs([&] {
+        for (int i = 0; i < LOOKUPS; ++i) {
+            if (int* v = interned[i % MAPS].find(words[probes[i]])) sum += static_cast<size_t>(*v);
+        }
+    });
+    report("InternedMap<int> lookup by string", ms, sum);
+    
+    // Callers that keep ids around skip the hashing entirely
+    Vector<InternedId> ids;
+    for (int i = 0; i < LOOKUPS; ++i) ids.push_back(pool.intern(words[probes[i]]));
+    sum = 0;
+    ms = timeMs([&] {
+        for (int i = 0; i < LOOKUPS; ++i) {
+            if (int* v = interned[i % MAPS].find(ids[i])) sum += static_cast<size_t>(*v);
+        }
+    });
+    report("InternedMap<int> lookup by id", ms, sum);
+}
+
+void benchBitmapSet() {
+    cout << "\n=== BENCH: BITMAP SET VS SET<INT> ===\n";
+    
+    // Dense-ish ids: about half of [0, 2^22), in clumps
+    const int RANGE = 1 << 22;
+    mt19937 rng(45);
+    Vector<int> ids;
+    for (int v = 0; v < RANGE; ++v) {
+        if ((rng() & 3) != 0 && (v >> 12) % 3 != 1) ids.push_back(v);
+    }
+    Vector<int> others;
+    for (int v = 0; v < RANGE; v += 3) others.push_back(v);
+    
+    Set<int> set, otherSet;
+    double ms = timeMs([&] {
+        for (size_t i = 0; i < ids.size(); ++i) set.insert(ids[i]);
+    });
+    for (size_t i = 0; i < others.size(); ++i) otherSet.insert(others[i]);
+    report("Set<int> insert", ms, set.size());
+    cout << "  bytes per element: " << set.memory_usage().bytes_per_element(set.size()) << "\n";
+    
+    BitmapSet<int> bitmap, otherBitmap;
+    ms = timeMs([&] {
+        for (size_t i = 0; i < ids.size(); ++i) bitmap.insert(ids[i]);
+    });
+    for (size_t i = 0; i < others.size(); ++i) otherBitmap.insert(others[i]);
+    report("BitmapSet<int> insert", ms, bitmap.size());
+    cout << "  bytes per element: " << bitmap.memory_usage().bytes_per_element(bitmap.size()) << "\n";
+    
+    BitmapSet<int> ranged;
+    ms = timeMs([&] { ranged.insert_range(0, RANGE - 1); });
+    report("BitmapSet<int> insert_range (all 2^22)", ms, ranged.size());
+    cout << "  bytes per element: " << ranged.memory_usage().bytes_per_element(ranged.size()) << "\n";
+    
+    const int PROBES = 1000000;
+    Vector<int> probes;
+    for (int i = 0; i < PROBES; ++i) probes.push_back(static_cast<int>(rng() % RANGE));
+    size_t found = 0;
+    ms = timeMs([&] {
+        for (int i = 0; i < PROBES; ++i) found += set.contains(probes[i]);
+    });
+    report("Set<int> contains", ms, found);
+    found = 0;
+    ms = timeMs([&] {
+        for (int i = 0; i < PROBES; ++i) found += bitmap.contains(probes[i]);
+    });
+    report("BitmapSet<int> contains", ms, found);
+    
+    // Intersection size: walk one Set probing the other, against chunk-wise AND + popcount
+    size_t common = 0;
+    ms = timeMs([&] {
+        set.for_each([&](int v) { common += otherSet.contains(v); });
+    });
+    report("Set<int> intersection size", ms, common);
+    ms = timeMs([&] { common = bitmap.intersection_size(otherBitmap); });
+    report("BitmapSet<int> intersection_size", ms, common);
+    ms = timeMs([&] {
+        BitmapSet<int> both = bitmap.clone();
+        both.unite(otherBitmap);
+        common = both.size();
+    });
+    report("BitmapSet<int> clone + unite", ms, common);
+}
+
+// Stack behind one mutex, the usual way to share a free-list
+struct LockedStack {
+    mutex m;
+    Stack<int> stack;
+    
+    void push(int value) {
+        lock_guard<mutex> lock(m);
+        stack.push(value);
+    }
+    optional<int> pop() {
+        lock_guard<mutex> lock(m);
+        if (stack.empty()) return nullopt;
+        int value = stack.top();
+        stack.pop();
+        return value;
+    }
+};
+
+// Each thread runs ops take-and-return pairs against a pool seeded with 64
+// items. Returns the sum of everything taken.
+template <typename S>
+size_t poolChurn(S& pool, int threadCount, int ops) {
+    for (int i = 0; i < 64; ++i) pool.push(i);
+    atomic<size_t> sum(0);
+    Vector<thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            size_t local = 0;
+            for (int i = 0; i < ops; ++i) {
+                optional<int> item = pool.pop();
+                if (!item) continue;
+                local += static_cast<size_t>(*item);
+                pool.push(*item);
+            }
+            sum.fetch_add(local);
+        });
+    }
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    return sum.load();
+}
+
+void benchConcurrentStack() {
+    cout << "\n=== BENCH: LOCK-FREE STACK VS MUTEX-WRAPPED STACK ===\n";
+    cout << "  (" << thread::hardware_concurrency() << " hardware threads)\n";
+    
+    const int TOTAL_OPS = 4000000;
+    for (int threadCount : {1, 2, 4, 8}) {
+        int ops = TOTAL_OPS / threadCount;
+        string label = to_string(threadCount) + (threadCount == 1 ? " thread" : " threads");
+        
+        LockedStack locked;
+        size_t sum = 0;
+        double ms = timeMs([&] { sum = poolChurn(locked, threadCount, ops); });
+        report(("mutex + Stack, pop/push pairs, " + label).c_str(), ms, sum);
+        
+        ConcurrentStack<int> lockFree;
+        ms = timeMs([&] { sum = poolChurn(lockFree, threadCount, ops); });
+        report(("ConcurrentStack, pop/push pairs, " + label).c_str(), ms, sum);
+    }
+    
+    // Moving 32 items at a time: one CAS per chain instead of one per item
+    const int BATCH = 32;
+    const int ROUNDS = TOTAL_OPS / BATCH;
+    ConcurrentStack<int> single;
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            for (int i = 0; i < BATCH; ++i) single.push(i);
+            for (int i = 0; i < BATCH; ++i) sum += static_cast<size_t>(*single.pop());
+        }
+    });
+    report("ConcurrentStack, 32 single push + 32 single pop", ms, sum);
+    
+    ConcurrentStack<int> batched;
+    sum = 0;
+    ms = timeMs([&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            auto chain = batched.make_chain(BATCH);
+            for (int i = 0; i < BATCH; ++i) chain.push(i);
+            batched.push_chain(std::move(chain));
+            auto taken = batched.pop_batch(BATCH);
+            while (optional<int> item = taken.pop()) sum += static_cast<size_t>(*item);
+        }
+    });
+    report("ConcurrentStack, push_chain + pop_batch of 32", ms, sum);
+}
+
+// Random inserts and erases over a fixed key range keep the tree at about
+// half full, so every update rebalances somewhere
+template <typename M>
+void treeChurn(const char* name, const Vector<int>& keys, const Vector<int>& probes) {
+    M map;
+    double ms = timeMs([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] & 1) map.erase(keys[i] >> 1);
+            else map.insert(keys[i] >> 1, static_cast<int>(i));
+        }
+    });
+    const TreeStats& stats = map.balance_stats();
+    report((string(name) + " insert/erase churn").c_str(), ms, map.size());
+    cout << "  " << static_cast<double>(stats.rotations) / keys.size() << " rotations and "
+         << static_cast<double>(stats.rank_updates) / keys.size() << " rank updates per update, height "
+         << map.height() << "\n";
+    
+    size_t hits = 0;
+    ms = timeMs([&] {
+        for (size_t i = 0; i < probes.size(); ++i) hits += map.contains(probes[i]) ? 1 : 0;
+    });
+    report((string(name) + " lookups").c_str(), ms, hits);
+}
+
+void benchBalancePolicies() {
+    cout << "\n=== BENCH: TREE BALANCING POLICIES ===\n";
+    
+    const int UPDATES = 2000000;
+    const int KEYS = 500000;
+    mt19937 rng(47);
+    Vector<int> keys;
+    Vector<int> probes;
+    for (int i = 0; i < UPDATES; ++i) keys.push_back(static_cast<int>(rng() % (2 * KEYS)));
+    for (int i = 0; i < UPDATES; ++i) probes.push_back(static_cast<int>(rng() % KEYS));
+    
+    treeChurn<Map<int, int, less<int>, AvlBalance>>("AVL", keys, probes);
+    treeChurn<Map<int, int, less<int>, WavlBalance>>("WAVL", keys, probes);
+    treeChurn<Map<int, int, less<int>, RedBlackBalance>>("Red-black", keys, probes);
+}
+
+// Process-wide memory counters for the growth benchmark, read from /proc;
+// zero where unavailable
+size_t procKb(const char* path, const char* field) {
+    ifstream in(path);
+    string line;
+    size_t length = strlen(field);
+    while (getline(in, line)) {
+        if (line.compare(0, length, field) == 0) return stoul(line.substr(length));
+    }
+    return 0;
+}
+
+// Restarts the VmHWM peak-RSS high-water mark at the current RSS
+void resetPeakRss() {
+    ofstream("/proc/self/clear_refs") << "5";
+}
+
+size_t minorFaults() {
+#if defined(__linux__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_minflt);
+#else
+    return 0;
+#endif
+}
+
+// Counts data-TLB load misses in this thread while alive; works only where
+// the kernel exposes a hardware PMU to perf_event_open
+class DtlbMissCounter {
+private:
+    int fd;
+
+public:
+    DtlbMissCounter() : fd(-1) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    bool available() const { return fd >= 0; }
+
+    size_t read() const {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fd >= 0 && ::read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return static_cast<size_t>(count);
+    }
+
+    ~DtlbMissCounter() {
+#if defined(__linux__)
+        if (fd >= 0) close(fd);
+#endif
+    }
+};
+
+// Grows a vector to n elements one push_back at a time, then reads it at
+// random, reporting time, peak RSS, page faults, huge-page backing and TLB
+// misses
+template <typename V>
+void vectorGrowth(const char* name, size_t n) {
+    size_t sum = 0;
+    {
+        V v;
+        resetPeakRss();
+        size_t baseKb = procKb("/proc/self/status", "VmRSS:");
+        size_t faults = minorFaults();
+        double ms = timeMs([&] {
+            for (size_t i = 0; i < n; ++i) v.push_back(static_cast<uint32_t>(i));
+        });
+        report((string(name) + " grow").c_str(), ms, v.size());
+        cout << "  peak RSS +" << (procKb("/proc/self/status", "VmHWM:") - baseKb) / 1024 << " MiB for "
+             << n * sizeof(uint32_t) / (1024 * 1024) << " MiB of data, " << minorFaults() - faults
+             << " page faults, " << procKb("/proc/self/smaps_rollup", "AnonHugePages:") / 1024
+             << " MiB on huge pages\n";
+        
+        const size_t READS = 20000000;
+        uint64_t x = 48;
+        DtlbMissCounter tlb;
+        size_t before = tlb.read();
+        ms = timeMs([&] {
+            for (size_t i = 0; i < READS; ++i) {
+                x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+                sum += v[(x >> 33) % n];
+            }
+        });
+        report((string(name) + " random reads").c_str(), ms, sum);
+        if (tlb.available()) cout << "  " << tlb.read() - before << " dTLB load misses\n";
+        else cout << "  dTLB load misses: unavailable (no hardware PMU for perf_event_open)\n";
+    }
+}
+
+void benchVectorGrowth() {
+    cout << "\n=== BENCH: HUGE VECTOR GROWTH, HEAP VS MMAP/MREMAP ===\n";
+    
+    const size_t N = 200000000;   // 800 MB of uint32_t
+    vectorGrowth<Vector<uint32_t>>("Vector<uint32_t> (heap)", N);
+    vectorGrowth<Vector<uint32_t, MappedStorage<>>>("Vector<uint32_t, MappedStorage<>>", N);
+    vectorGrowth<Vector<uint32_t, MappedStorage<true>>>("Vector<uint32_t, MappedStorage<true>> (prefault)", N);
+}
+
+struct Position {
+    float x, y, z;
+};
+
+struct Velocity {
+    float dx, dy, dz;
+};
+
+template <typename M>
+void resetTable(M& table) {
+    if constexpr (requires { table.clear(); }) table.clear();
+    else table = M();
+}
+
+// An ECS-style frame loop over component tables keyed by entity id: every
+// moving entity's position is updated through a lookup by id, a few
+// entities die and are respawned, and a per-frame scratch table of
+// collisions is filled and cleared
+template <typename PositionTable, typename VelocityTable, typename ScratchTable>
+void ecsFrames(const char* name, int entities, int frames) {
+    PositionTable positions;
+    VelocityTable velocities;
+    ScratchTable contacts;
+    mt19937 rng(49);
+    for (int id = 0; id < entities; ++id) {
+        float f = static_cast<float>(id);
+        positions.insert(id, Position{f, f, f});
+        if (id % 4) velocities.insert(id, Velocity{1.0f, 0.5f, 0.25f});
+    }
+    
+    double ms = timeMs([&] {
+        for (int frame = 0; frame < frames; ++frame) {
+            velocities.for_each([&](auto id, Velocity& v) {
+                if (Position* p = positions.find(id)) {
+                    p->x += v.dx;
+                    p->y += v.dy;
+                    p->z += v.dz;
+                }
+            });
+            for (int i = 0; i < entities / 100; ++i) {
+                int id = static_cast<int>(rng() % entities);
+                positions.erase(id);
+                velocities.erase(id);
+                positions.insert(id, Position{0.0f, 0.0f, 0.0f});
+                velocities.insert(id, Velocity{-1.0f, 0.0f, 0.0f});
+            }
+            for (int i = 0; i < entities / 20; ++i) contacts.insert(static_cast<int>(rng() % entities), frame);
+            resetTable(contacts);
+        }
+    });
+    double sum = 0;
+    positions.for_each([&](auto, Position& p) { sum += p.x + p.y + p.z; });
+    report(name, ms, static_cast<size_t>(sum));
+    cout << "  positions: " << positions.memory_usage().total() / positions.size() << " bytes per entity\n";
+}
+
+void benchSparseMap() {
+    cout << "\n=== BENCH: SPARSE MAP VS MAP FOR DENSE ENTITY IDS ===\n";
+    
+    const int ENTITIES = 100000;
+    const int FRAMES = 100;
+    ecsFrames<Map<int, Position>, Map<int, Velocity>, Map<int, int>>("Map<int, V>, 100 ECS frames", ENTITIES, FRAMES);
+    ecsFrames<SparseMap<Position>, SparseMap<Velocity>, SparseMap<int>>("SparseMap<V>, 100 ECS frames", ENTITIES,
+                                                                       FRAMES);
+    
+    // Plain random lookups by id, without the iteration
+    Map<int, int> map;
+    SparseMap<int> sparse;
+    for (int id = 0; id < ENTITIES; ++id) {
+        map.insert(id, id);
+        sparse.insert(id, id);
+    }
+    Vector<int> probes;
+    mt19937 rng(50);
+    for (int i = 0; i < 4000000; ++i) probes.push_back(static_cast<int>(rng() % ENTITIES));
+    size_t sum = 0;
+    double ms = timeMs([&] {
+        for (size_t i = 0; i < probes.size(); ++i) sum += static_cast<size_t>(*map.find(probes[i]));
+    });
+    report("Map<int, int>::find", ms, sum);
+    sum = 0;
+    ms = timeMs([&] {
+        for (size_t i = 0; i < probes.size(); ++i) sum += static_cast<size_t>(*sparse.find(probes[i]));
+    });
+    report("SparseMap<int>::find", ms, sum);
+}
+
+// The hand-built cache LruCache replaces: a Map for the values and a
+// LinkedList of keys for recency, most recent first. LinkedList has no way
+// to unlink a known node, so a hit rebuilds the list around the key.
+struct MapListCache {
+    Map<int, int> values;
+    LinkedList<int> recency;
+    size_t capacity;
+    
+    explicit MapListCache(size_t cap) : capacity(cap) {}
+    
+    int* get(int key) {
+        int* v = values.find(key);
+        if (!v) return nullptr;
+        for (size_t i = recency.size(); i > 0; --i) {
+            int k = recency.front();
+            recency.pop_front();
+            if (k != key) recency.push_back(k);
+        }
+        recency.push_front(key);
+        return v;
+    }
+    
+    void put(int key, int value) {
+        if (values.size() == capacity) {
+            values.erase(recency.back());
+            recency.pop_back();
+        }
+        values.insert(key, value);
+        recency.push_front(key);
+    }
+};
+
+// Skewed keys over [0, keySpace): small keys are much more popular
+Vector<int> skewedKeys(int n, int keySpace, unsigned seed) {
+    mt19937 rng(seed);
+    Vector<int> keys;
+    for (int i = 0; i < n; ++i) keys.push_back(static_cast<int>(rng() % (rng() % keySpace + 1)));
+    return keys;
+}
+
+// Read-through: a miss "loads" the value and puts it
+template <typename Cache>
+size_t readThrough(Cache& cache, const Vector<int>& keys) {
+    size_t sum = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (int* v = cache.get(keys[i])) {
+            sum += static_cast<size_t>(*v);
+        } else {
+            cache.put(keys[i], keys[i] * 3);
+        }
+    }
+    return sum;
+}
+
+void benchLruCache() {
+    cout << "\n=== BENCH: LRU CACHE VS MAP + LINKEDLIST ===\n";
+    
+    const int CAPACITY = 1024;
+    const int KEY_SPACE = 8192;
+    const int N = 2000000;
+    Vector<int> keys = skewedKeys(N, KEY_SPACE, 42);
+    
+    // Each hit costs a pass over the whole list, so the baseline runs fewer
+    const int SLOW_N = N / 100;
+    Vector<int> slowKeys = skewedKeys(SLOW_N, KEY_SPACE, 42);
+    MapListCache handBuilt(CAPACITY);
+    size_t sum = 0;
+    double ms = timeMs([&] { sum = readThrough(handBuilt, slowKeys); });
+    report("Map + LinkedList cache (1/100 of the accesses)", ms, sum);
+    cout << "  ns per access: " << ms * 1e6 / SLOW_N << "\n";
+    
+    LruCache<int, int> lru(CacheCapacity::entries(CAPACITY));
+    ms = timeMs([&] { sum = readThrough(lru, keys); });
+    report("LruCache", ms, sum);
+    cout << "  ns per access: " << ms * 1e6 / N << ", hit rate " << lru.hit_rate() << "\n";
+    
+    ClockCache<int, int> clock(CacheCapacity::entries(CAPACITY));
+    ms = timeMs([&] { sum = readThrough(clock, keys); });
+    report("ClockCache", ms, sum);
+    cout << "  ns per access: " << ms * 1e6 / N << ", hit rate " << clock.hit_rate() << "\n";
+    
+    // Many threads through one front end
+    for (int threadCount : {1, 4}) {
+        ShardedLruCache<int, int> sharded(CacheCapacity::entries(CAPACITY));
+        atomic<size_t> total(0);
+        ms = timeMs([&] {
+            Vector<thread> threads;
+            for (int t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&, t] {
+                    size_t local = 0;
+                    for (int i = t; i < N; i += threadCount) {
+                        if (optional<int> v = sharded.get(keys[i])) local += static_cast<size_t>(*v);
+                        else sharded.put(keys[i], keys[i] * 3);
+                    }
+                    total.fetch_add(local);
+                });
+            }
+            for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+        });
+        report(("ShardedLruCache, " + to_string(threadCount) + (threadCount == 1 ? " thread" : " threads")).c_str(),
+               ms, total.load());
+    }
+}
+
+// Map behind one mutex: the baseline a concurrent map has to beat
+struct LockedMap {
+    mutex m;
+    Map<int, int> map;
+    
+    bool find(int key) {
+        lock_guard<mutex> lock(m);
+        return map.contains(key);
+    }
+    void insert(int key, int value) {
+        lock_guard<mutex> lock(m);
+        map.insert(key, value);
+    }
+    void erase(int key) {
+        lock_guard<mutex> lock(m);
+        map.erase(key);
+    }
+};
+
+// Each thread runs ops operations over keys [0, keys): 80% lookups, 10%
+// inserts, 10% erases. Returns the number of successful lookups.
+template <typename M>
+size_t mixedWorkload(M& map, int threadCount, int ops, int keys) {
+    atomic<size_t> hits(0);
+    Vector<thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            mt19937 rng(40 + t);
+            size_t found = 0;
+            for (int i = 0; i < ops; ++i) {
+                int key = static_cast<int>(rng() % keys);
+                unsigned op = rng() % 10;
+                if (op == 0) map.insert(key, i);
+                else if (op == 1) map.erase(key);
+                else found += map.find(key) ? 1 : 0;
+            }
+            hits.fetch_add(found);
+        });
+    }
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    return hits.load();
+}
+
+void benchConcurrentOrderedMap() {
+    cout << "\n=== BENCH: CONCURRENT ORDERED MAP VS MUTEX-WRAPPED MAP ===\n";
+    cout << "  (" << thread::hardware_concurrency() << " hardware threads)\n";
+    
+    const int KEYS = 100000;
+    const int TOTAL_OPS = 2000000;
+    for (int threadCount : {1, 2, 4, 8}) {
+        int ops = TOTAL_OPS / threadCount;
+        string label = to_string(threadCount) + (threadCount == 1 ? " thread" : " threads");
+        
+        LockedMap locked;
+        for (int k = 0; k < KEYS; k += 2) locked.map.insert(k, k);
+        size_t hits = 0;
+        double ms = timeMs([&] { hits = mixedWorkload(locked, threadCount, ops, KEYS); });
+        report(("mutex + Map, 80/10/10 mix, " + label).c_str(), ms, hits);
+        
+        ConcurrentOrderedMap<int, int> concurrent;
+        for (int k = 0; k < KEYS; k += 2) concurrent.insert(k, k);
+        ms = timeMs([&] { hits = mixedWorkload(concurrent, threadCount, ops, KEYS); });
+        report(("ConcurrentOrderedMap, 80/10/10 mix, " + label).c_str(), ms, hits);
+    }
+    EpochDomain::global().reclaim();
+}
+
+// An int with a user-written move, which hides its trivial relocatability and
+// forces Vector back onto element-by-element shifting
+struct ShiftedInt {
+    int value;
+    
+    ShiftedInt(int v) : value(v) {}
+    ShiftedInt(const ShiftedInt& other) : value(other.value) {}
+    ShiftedInt(ShiftedInt&& other) noexcept : value(other.value) {}
+    ShiftedInt& operator=(const ShiftedInt& other) {
+        value = other.value;
+        return *this;
+    }
+    ShiftedInt& operator=(ShiftedInt&& other) noexcept {
+        value = other.value;
+        return *this;
+    }
+};
+
+template <typename T>
+size_t insertEraseChurn(Vector<T>& v, const Vector<size_t>& positions, int rounds) {
+    T batch[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (int r = 0; r < rounds; ++r) {
+        size_t pos = positions[r] % v.size();
+        v.insert(pos, batch, batch + 8);
+        v.erase(pos / 2, pos / 2 + 8);
+    }
+    size_t sum = 0;
+    for (size_t i = 0; i < v.size(); i += 97) sum += static_cast<size_t>(v[i].value);
+    return sum;
+}
+
+void benchVectorInsertErase() {
+    cout << "\n=== BENCH: VECTOR MIDDLE INSERT/ERASE ===\n";
+    
+    const int SIZE = 100000;
+    const int ROUNDS = 20000;
+    mt19937 rng(39);
+    Vector<size_t> positions;
+    for (int i = 0; i < ROUNDS; ++i) positions.push_back(rng());
+    
+    struct Plain {
+        int value;
+        Plain(int v) : value(v) {}
+    };
+    Vector<Plain> plain;
+    Vector<ShiftedInt> shifted;
+    for (int i = 0; i < SIZE; ++i) {
+        plain.push_back(i);
+        shifted.push_back(i);
+    }
+    size_t sum = 0;
+    double ms = timeMs([&] { sum = insertEraseChurn(plain, positions, ROUNDS); });
+    report("Vector<trivially relocatable> insert 8 + erase 8 (memmove)", ms, sum);
+    ms = timeMs([&] { sum = insertEraseChurn(shifted, positions, ROUNDS); });
+    report("Vector<user-defined move> insert 8 + erase 8 (element-wise)", ms, sum);
+    
+    // Growth: one memcpy per reallocation against a move per element
+    ms = timeMs([&] {
+        Vector<Plain> grow;
+        for (int i = 0; i < SIZE * 40; ++i) grow.push_back(i);
+        sum = grow.size();
+    });
+    report("Vector<trivially relocatable> push_back growth", ms, sum);
+    ms = timeMs([&] {
+        Vector<ShiftedInt> grow;
+        for (int i = 0; i < SIZE * 40; ++i) grow.push_back(i);
+        sum = grow.size();
+    });
+    report("Vector<user-defined move> push_back growth", ms, sum);
+}
+
+// 512 distinct keys, sorted into the table by the compiler
+constexpr int STATIC_ENTRIES = 512;
+constexpr int staticKey(int i) { return i * 7919 % 100003; }
+
+constexpr auto staticTable = [] {
+    pair<int, int> entries[STATIC_ENTRIES] = {};
+    for (int i = 0; i < STATIC_ENTRIES; ++i) entries[i] = {staticKey(i), i};
+    return StaticMap<int, int, STATIC_ENTRIES>(entries);
+}();
+
+void benchStaticMap() {
+    cout << "\n=== BENCH: COMPILE-TIME TABLE VS MAP BUILT AT STARTUP ===\n";
+    
+    const int N = 4000000;
+    Vector<int> probes;
+    for (int i = 0; i < N; ++i) probes.push_back(i % 2 ? staticKey(i % STATIC_ENTRIES) : i % 100003);
+    
+    // The startup cost a StaticMap removes
+    Map<int, int> map;
+    double ms = timeMs([&] {
+        for (int i = 0; i < STATIC_ENTRIES; ++i) map.insert(staticKey(i), i);
+    });
+    report("Map<int, int> build at startup (512 entries)", ms, map.size());
+    report("StaticMap<int, int, 512> build at startup", 0.0, staticTable.size());
+    
+    size_t sum = 0;
+    ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            if (int* v = map.find(probes[i])) sum += *v;
+        }
+    });
+    report("Map<int, int> lookup", ms, sum);
+    
+    ms = timeMs([&] {
+        sum = 0;
+        for (int i = 0; i < N; ++i) {
+            if (const int* v = staticTable.find(probes[i])) sum += *v;
+        }
+    });
+    report("StaticMap<int, int, 512> lookup", ms, sum);
+}
+
+int main() {
+    cout << "========================================\n";
+    cout << "    CUSTOM CONTAINER LIBRARY BENCHMARKS\n";
+    cout << "========================================\n";
+    
+    benchStringLookup();
+    benchPriorityQueue();
+    benchDeque();
+    benchClone();
+    benchNodeTransfer();
+    benchIntrusive();
+    benchBatchedLookup();
+    benchAsyncChannel();
+    benchCompactTree();
+    benchBloomFilter();
+    benchNodeAllocator();
+    benchStaticMap();
+    benchVectorInsertErase();
+    benchConcurrentOrderedMap();
+    benchTracer();
+    benchLruCache();
+    benchArtMap();
+    benchStringPool();
+    benchBitmapSet();
+    benchConcurrentStack();
+    benchBalancePolicies();
+    benchVectorGrowth();
+    benchSparseMap();
+    
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,834 @@
+// File: include/art_map.hpp
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
+// How ArtMap turns a key into the bytes it branches on. Comparing two keys'
+// bytes lexicographically (as unsigned, a proper prefix first) must give the
+// key order. Provided for integers and for anything convertible to
+// std::string_view; specialize it for other key types.
+template <typename K, typename = void>
+struct ArtKeyTraits;
+
+// Big-endian with the sign bit flipped, so byte order is numeric order
+template <typename K>
+struct ArtKeyTraits<K, std::enable_if_t<std::is_integral_v<K>>> {
+    using View = K;
+
+    static View view(K key) { return key; }
+    static size_t size(View) { return sizeof(K); }
+
+    static unsigned char at(View key, size_t i) {
+        using U = std::make_unsigned_t<K>;
+        U bits = static_cast<U>(key);
+        if constexpr (std::is_signed_v<K>) bits = static_cast<U>(bits ^ (U(1) << (sizeof(K) * 8 - 1)));
+        return static_cast<unsigned char>(bits >> ((sizeof(K) - 1 - i) * 8));
+    }
+};
+
+template <typename K>
+struct ArtKeyTraits<K, std::enable_if_t<std::is_convertible_v<const K&, std::string_view>>> {
+    using View = std::string_view;
+
+    static View view(const K& key) { return std::string_view(key); }
+    static size_t size(View key) { return key.size(); }
+    static unsigned char at(View key, size_t i) { return static_cast<unsigned char>(key[i]); }
+};
+
+// Ordered map over an adaptive radix tree. Each inner node branches on one
+// byte of the key, so a lookup costs one small step per key byte instead of
+// a full key comparison per tree level: keys sharing a long prefix (URLs,
+// paths) are told apart at the first differing byte. Nodes come in four
+// sizes and change size as children come and go:
+//   Node4, Node16   sorted byte arrays; Node16 is searched with one SSE2
+//                   compare where available
+//   Node48          a 256-entry byte index into 48 child slots
+//   Node256         a plain array of 256 children
+// Runs of bytes with a single child are collapsed into the node's prefix.
+// Only its first MAX_PREFIX bytes are stored; longer prefixes are skipped
+// on the way down and checked against the full key kept in the leaf.
+//
+// A key that is a proper prefix of another (say "/api" and "/api/v1") ends
+// at an inner node and is held in that node's terminal slot, which sorts
+// before all of its children.
+template <typename K, typename V>
+class ArtMap {
+private:
+    using Traits = ArtKeyTraits<K>;
+    using View = typename Traits::View;
+
+    static constexpr size_t MAX_PREFIX = 8;
+
+    enum NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+    struct Node : PooledNode {
+        uint8_t type;
+
+        explicit Node(uint8_t t) : type(t) {}
+    };
+
+    struct Leaf : Node {
+        K key;
+        V value;
+
+        template<typename KType, typename VType>
+        Leaf(KType&& k, VType&& v) : Node(LEAF), key(std::forward<KType>(k)), value(std::forward<VType>(v)) {}
+    };
+
+    struct Inner : Node {
+        uint16_t count;
+        uint32_t prefixLen;
+        unsigned char prefix[MAX_PREFIX];
+        Leaf* terminal;   // the entry whose key ends at this node
+
+        explicit Inner(uint8_t t) : Node(t), count(0), prefixLen(0), prefix(), terminal(nullptr) {}
+    };
+
+    struct Node4 : Inner {
+        unsigned char keys[4];
+        Node* children[4];
+
+        Node4() : Inner(NODE4), keys(), children() {}
+    };
+
+    struct Node16 : Inner {
+        unsigned char keys[16];
+        Node* children[16];
+
+        Node16() : Inner(NODE16), keys(), children() {}
+    };
+
+    struct Node48 : Inner {
+        unsigned char slotOf[256];   // child slot + 1, or 0 for no child
+        Node* children[48];
+
+        Node48() : Inner(NODE48), slotOf(), children() {}
+    };
+
+    struct Node256 : Inner {
+        Node* children[256];
+
+        Node256() : Inner(NODE256), children() {}
+    };
+
+    Node* root;
+    size_t sz;
+    size_t innerCount[NODE256 + 1];   // live inner nodes by type, for memory_usage()
+
+    static View keyOf(const Leaf* leaf) { return Traits::view(leaf->key); }
+
+    template<typename T>
+    T* newInner() {
+        T* n = new T();
+        ++innerCount[n->type];
+        return n;
+    }
+
+    void freeNode(Node* n) {
+        if (n->type != LEAF) --innerCount[n->type];
+        switch (n->type) {
+            case LEAF: delete static_cast<Leaf*>(n); break;
+            case NODE4: delete static_cast<Node4*>(n); break;
+            case NODE16: delete static_cast<Node16*>(n); break;
+            case NODE48: delete static_cast<Node48*>(n); break;
+            default: delete static_cast<Node256*>(n); break;
+        }
+    }
+
+    static void copyHeader(Inner* to, const Inner* from) {
+        to->count = from->count;
+        to->prefixLen = from->prefixLen;
+        std::memcpy(to->prefix, from->prefix, MAX_PREFIX);
+        to->terminal = from->terminal;
+    }
+
+    static void setPrefix(Inner* n, View key, size_t from, size_t len) {
+        n->prefixLen = static_cast<uint32_t>(len);
+        for (size_t i = 0; i < len && i < MAX_PREFIX; ++i) n->prefix[i] = Traits::at(key, from + i);
+    }
+
+    static int findKey16(const Node16* n, unsigned char b) {
+#if defined(__SSE2__)
+        __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys));
+        __m128i hits = _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(b)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)) & ((1u << n->count) - 1);
+        return mask ? std::countr_zero(mask) : -1;
+#else
+        for (int i = 0; i < n->count; ++i) {
+            if (n->keys[i] == b) return i;
+        }
+        return -1;
+#endif
+    }
+
+    // The slot holding the child for byte b, or nullptr
+    static Node** findChild(Inner* n, unsigned char b) {
+        switch (n->type) {
+            case NODE4: {
+                Node4* n4 = static_cast<Node4*>(n);
+                for (int i = 0; i < n4->count; ++i) {
+                    if (n4->keys[i] == b) return &n4->children[i];
+                }
+                return nullptr;
+            }
+            case NODE16: {
+                Node16* n16 = static_cast<Node16*>(n);
+                int i = findKey16(n16, b);
+                return i >= 0 ? &n16->children[i] : nullptr;
+            }
+            case NODE48: {
+                Node48* n48 = static_cast<Node48*>(n);
+                return n48->slotOf[b] ? &n48->children[n48->slotOf[b] - 1] : nullptr;
+            }
+            default: {
+                Node256* n256 = static_cast<Node256*>(n);
+                return n256->children[b] ? &n256->children[b] : nullptr;
+            }
+        }
+    }
+
+    // Sorted insert into a Node4 or Node16 known to have room
+    template<typename T>
+    static void addSorted(T* n, unsigned char b, Node* child) {
+        int i = n->count;
+        while (i > 0 && n->keys[i - 1] > b) {
+            n->keys[i] = n->keys[i - 1];
+            n->children[i] = n->children[i - 1];
+            --i;
+        }
+        n->keys[i] = b;
+        n->children[i] = child;
+        ++n->count;
+    }
+
+    // Adds child under byte b, which must be absent, moving the node at ref
+    // to the next size up if it is full
+    void addChild(Node*& ref, unsigned char b, Node* child) {
+        Inner* n = static_cast<Inner*>(ref);
+        switch (n->type) {
+            case NODE4: {
+                Node4* n4 = static_cast<Node4*>(n);
+                if (n4->count < 4) {
+                    addSorted(n4, b, child);
+                    return;
+                }
+                Node16* grown = newInner<Node16>();
+                copyHeader(grown, n4);
+                std::memcpy(grown->keys, n4->keys, 4);
+                std::memcpy(grown->children, n4->children, 4 * sizeof(Node*));
+                addSorted(grown, b, child);
+                ref = grown;
+                freeNode(n4);
+                return;
+            }
+            case NODE16: {
+                Node16* n16 = static_cast<Node16*>(n);
+                if (n16->count < 16) {
+                    addSorted(n16, b, child);
+                    return;
+                }
+                Node48* grown = newInner<Node48>();
+                copyHeader(grown, n16);
+                for (int i = 0; i < 16; ++i) {
+                    grown->children[i] = n16->children[i];
+                    grown->slotOf[n16->keys[i]] = static_cast<unsigned char>(i + 1);
+                }
+                grown->children[16] = child;
+                grown->slotOf[b] = 17;
+                ++grown->count;
+                ref = grown;
+                freeNode(n16);
+                return;
+            }
+            case NODE48: {
+                Node48* n48 = static_cast<Node48*>(n);
+                if (n48->count < 48) {
+                    int slot = 0;
+                    while (n48->children[slot]) ++slot;
+                    n48->children[slot] = child;
+                    n48->slotOf[b] = static_cast<unsigned char>(slot + 1);
+                    ++n48->count;
+                    return;
+                }
+                Node256* grown = newInner<Node256>();
+                copyHeader(grown, n48);
+                for (int k = 0; k < 256; ++k) {
+                    if (n48->slotOf[k]) grown->children[k] = n48->children[n48->slotOf[k] - 1];
+                }
+                grown->children[b] = child;
+                ++grown->count;
+                ref = grown;
+                freeNode(n48);
+                return;
+            }
+            default: {
+                Node256* n256 = static_cast<Node256*>(n);
+                n256->children[b] = child;
+                ++n256->count;
+                return;
+            }
+        }
+    }
+
+    static void removeChild(Inner* n, unsigned char b) {
+        switch (n->type) {
+            case NODE4:
+            case NODE16: {
+                unsigned char* keys = n->type == NODE4 ? static_cast<Node4*>(n)->keys : static_cast<Node16*>(n)->keys;
+                Node** children = n->type == NODE4 ? static_cast<Node4*>(n)->children : static_cast<Node16*>(n)->children;
+                int i = 0;
+                while (keys[i] != b) ++i;
+                for (; i + 1 < n->count; ++i) {
+                    keys[i] = keys[i + 1];
+                    children[i] = children[i + 1];
+                }
+                break;
+            }
+            case NODE48: {
+                Node48* n48 = static_cast<Node48*>(n);
+                n48->children[n48->slotOf[b] - 1] = nullptr;
+                n48->slotOf[b] = 0;
+                break;
+            }
+            default:
+                static_cast<Node256*>(n)->children[b] = nullptr;
+                break;
+        }
+        --n->count;
+    }
+
+    // After a removal, moves the node at ref to the next size down once it
+    // is well under capacity (with some slack, so a key added and removed at
+    // the boundary does not resize every time), or dissolves a Node4 left
+    // with a single entry
+    void shrink(Node*& ref) {
+        Inner* n = static_cast<Inner*>(ref);
+        switch (n->type) {
+            case NODE4: {
+                Node4* n4 = static_cast<Node4*>(n);
+                if (n4->count == 0) {
+                    ref = n4->terminal;
+                    freeNode(n4);
+                } else if (n4->count == 1 && !n4->terminal) {
+                    Node* child = n4->children[0];
+                    if (child->type != LEAF) {
+                        // The child absorbs this node's prefix and the branching byte
+                        Inner* c = static_cast<Inner*>(child);
+                        unsigned char merged[MAX_PREFIX];
+                        size_t len = n4->prefixLen < MAX_PREFIX ? n4->prefixLen : MAX_PREFIX;
+                        std::memcpy(merged, n4->prefix, len);
+                        if (len < MAX_PREFIX) merged[len++] = n4->keys[0];
+                        for (size_t i = 0; len < MAX_PREFIX && i < c->prefixLen; ++i) merged[len++] = c->prefix[i];
+                        std::memcpy(c->prefix, merged, len);
+                        c->prefixLen += n4->prefixLen + 1;
+                    }
+                    ref = child;
+                    freeNode(n4);
+                }
+                return;
+            }
+            case NODE16: {
+                Node16* n16 = static_cast<Node16*>(n);
+                if (n16->count > 3) return;
+                Node4* smaller = newInner<Node4>();
+                copyHeader(smaller, n16);
+                std::memcpy(smaller->keys, n16->keys, n16->count);
+                std::memcpy(smaller->children, n16->children, n16->count * sizeof(Node*));
+                ref = smaller;
+                freeNode(n16);
+                return;
+            }
+            case NODE48: {
+                Node48* n48 = static_cast<Node48*>(n);
+                if (n48->count > 12) return;
+                Node16* smaller = newInner<Node16>();
+                copyHeader(smaller, n48);
+                int i = 0;
+                for (int k = 0; k < 256; ++k) {
+                    if (!n48->slotOf[k]) continue;
+                    smaller->keys[i] = static_cast<unsigned char>(k);
+                    smaller->children[i++] = n48->children[n48->slotOf[k] - 1];
+                }
+                ref = smaller;
+                freeNode(n48);
+                return;
+            }
+            default: {
+                Node256* n256 = static_cast<Node256*>(n);
+                if (n256->count > 37) return;
+                Node48* smaller = newInner<Node48>();
+                copyHeader(smaller, n256);
+                int slot = 0;
+                for (int k = 0; k < 256; ++k) {
+                    if (!n256->children[k]) continue;
+                    smaller->children[slot] = n256->children[k];
+                    smaller->slotOf[k] = static_cast<unsigned char>(++slot);
+                }
+                ref = smaller;
+                freeNode(n256);
+                return;
+            }
+        }
+    }
+
+    // Smallest entry under n: the terminal if there is one, else the
+    // smallest entry of the first child
+    static Leaf* minimumLeaf(Node* n) {
+        while (n->type != LEAF) {
+            Inner* in = static_cast<Inner*>(n);
+            if (in->terminal) return in->terminal;
+            switch (in->type) {
+                case NODE4: n = static_cast<Node4*>(in)->children[0]; break;
+                case NODE16: n = static_cast<Node16*>(in)->children[0]; break;
+                case NODE48: {
+                    Node48* n48 = static_cast<Node48*>(in);
+                    int k = 0;
+                    while (!n48->slotOf[k]) ++k;
+                    n = n48->children[n48->slotOf[k] - 1];
+                    break;
+                }
+                default: {
+                    Node256* n256 = static_cast<Node256*>(in);
+                    int k = 0;
+                    while (!n256->children[k]) ++k;
+                    n = n256->children[k];
+                    break;
+                }
+            }
+        }
+        return static_cast<Leaf*>(n);
+    }
+
+    // Byte i of n's prefix, which starts at key depth `depth`
+    static unsigned char prefixByte(Inner* n, size_t depth, size_t i) {
+        return i < MAX_PREFIX ? n->prefix[i] : Traits::at(keyOf(minimumLeaf(n)), depth + i);
+    }
+
+    // How many bytes of n's prefix key matches from depth on
+    static size_t prefixMatch(Inner* n, View key, size_t depth) {
+        size_t len = Traits::size(key);
+        size_t i = 0;
+        for (; i < n->prefixLen && i < MAX_PREFIX; ++i) {
+            if (depth + i >= len || n->prefix[i] != Traits::at(key, depth + i)) return i;
+        }
+        if (n->prefixLen > MAX_PREFIX) {
+            View full = keyOf(minimumLeaf(n));
+            for (; i < n->prefixLen; ++i) {
+                if (depth + i >= len || Traits::at(full, depth + i) != Traits::at(key, depth + i)) return i;
+            }
+        }
+        return i;
+    }
+
+    Leaf* findLeaf(View key) const {
+        size_t len = Traits::size(key);
+        size_t depth = 0;
+        Node* n = root;
+        while (n) {
+            if (n->type == LEAF) {
+                Leaf* leaf = static_cast<Leaf*>(n);
+                return keyOf(leaf) == key ? leaf : nullptr;
+            }
+            Inner* in = static_cast<Inner*>(n);
+            if (in->prefixLen) {
+                // Only the stored bytes are checked; the leaf confirms the rest
+                if (depth + in->prefixLen > len) return nullptr;
+                for (size_t i = 0; i < in->prefixLen && i < MAX_PREFIX; ++i) {
+                    if (in->prefix[i] != Traits::at(key, depth + i)) return nullptr;
+                }
+                depth += in->prefixLen;
+            }
+            if (depth == len) return in->terminal && keyOf(in->terminal) == key ? in->terminal : nullptr;
+            Node** child = findChild(in, Traits::at(key, depth));
+            if (!child) return nullptr;
+            n = *child;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    // Links leaf, whose key must not be present, into the tree
+    void insertLeaf(Leaf* leaf) {
+        View key = keyOf(leaf);
+        size_t len = Traits::size(key);
+        size_t depth = 0;
+        Node** ref = &root;
+        while (true) {
+            if (!*ref) {
+                *ref = leaf;
+                return;
+            }
+            if ((*ref)->type == LEAF) {
+                // Two keys under one slot: branch where they first differ
+                Leaf* other = static_cast<Leaf*>(*ref);
+                View otherKey = keyOf(other);
+                size_t otherLen = Traits::size(otherKey);
+                size_t common = 0;
+                while (depth + common < len && depth + common < otherLen &&
+                       Traits::at(key, depth + common) == Traits::at(otherKey, depth + common))
+                    ++common;
+                Node4* n = newInner<Node4>();
+                setPrefix(n, key, depth, common);
+                Node* fresh = n;
+                placeLeaf(fresh, other, otherKey, depth + common);
+                placeLeaf(fresh, leaf, key, depth + common);
+                *ref = fresh;
+                return;
+            }
+            Inner* in = static_cast<Inner*>(*ref);
+            if (in->prefixLen) {
+                size_t match = prefixMatch(in, key, depth);
+                if (match < in->prefixLen) {
+                    // Split the prefix: a new Node4 takes the matching part
+                    // and in keeps what follows the byte where key diverges
+                    Node4* n = newInner<Node4>();
+                    setPrefix(n, key, depth, match);
+                    unsigned char edge = prefixByte(in, depth, match);
+                    size_t rest = in->prefixLen - match - 1;
+                    if (in->prefixLen <= MAX_PREFIX) {
+                        std::memmove(in->prefix, in->prefix + match + 1, rest);
+                        in->prefixLen = static_cast<uint32_t>(rest);
+                    } else {
+                        setPrefix(in, keyOf(minimumLeaf(in)), depth + match + 1, rest);
+                    }
+                    Node* fresh = n;
+                    addChild(fresh, edge, in);
+                    placeLeaf(fresh, leaf, key, depth + match);
+                    *ref = fresh;
+                    return;
+                }
+                depth += in->prefixLen;
+            }
+            if (depth == len) {
+                in->terminal = leaf;
+                return;
+            }
+            unsigned char b = Traits::at(key, depth);
+            Node** child = findChild(in, b);
+            if (!child) {
+                addChild(*ref, b, leaf);
+                return;
+            }
+            ref = child;
+            ++depth;
+        }
+    }
+
+    // Hangs leaf off the node at ref, whose prefix ends at key depth `depth`
+    void placeLeaf(Node*& ref, Leaf* leaf, View key, size_t depth) {
+        if (Traits::size(key) == depth) static_cast<Inner*>(ref)->terminal = leaf;
+        else addChild(ref, Traits::at(key, depth), leaf);
+    }
+
+    bool eraseKey(View key) {
+        if (!root) return false;
+        if (root->type == LEAF) {
+            if (!(keyOf(static_cast<Leaf*>(root)) == key)) return false;
+            freeNode(root);
+            root = nullptr;
+            --sz;
+            return true;
+        }
+        size_t len = Traits::size(key);
+        size_t depth = 0;
+        Node** ref = &root;
+        while (true) {
+            Inner* in = static_cast<Inner*>(*ref);
+            if (in->prefixLen) {
+                if (depth + in->prefixLen > len) return false;
+                for (size_t i = 0; i < in->prefixLen && i < MAX_PREFIX; ++i) {
+                    if (in->prefix[i] != Traits::at(key, depth + i)) return false;
+                }
+                depth += in->prefixLen;
+            }
+            if (depth == len) {
+                Leaf* leaf = in->terminal;
+                if (!leaf || !(keyOf(leaf) == key)) return false;
+                in->terminal = nullptr;
+                freeNode(leaf);
+                --sz;
+                shrink(*ref);
+                return true;
+            }
+            unsigned char b = Traits::at(key, depth);
+            Node** child = findChild(in, b);
+            if (!child) return false;
+            if ((*child)->type == LEAF) {
+                Leaf* leaf = static_cast<Leaf*>(*child);
+                if (!(keyOf(leaf) == key)) return false;
+                removeChild(in, b);
+                freeNode(leaf);
+                --sz;
+                shrink(*ref);
+                return true;
+            }
+            ref = child;
+            ++depth;
+        }
+    }
+
+    // Calls fn(byte, child) for each child of n in byte order
+    template<typename Fn>
+    static void forEachChild(Inner* n, Fn&& fn) {
+        switch (n->type) {
+            case NODE4: {
+                Node4* n4 = static_cast<Node4*>(n);
+                for (int i = 0; i < n4->count; ++i) fn(n4->keys[i], n4->children[i]);
+                break;
+            }
+            case NODE16: {
+                Node16* n16 = static_cast<Node16*>(n);
+                for (int i = 0; i < n16->count; ++i) fn(n16->keys[i], n16->children[i]);
+                break;
+            }
+            case NODE48: {
+                Node48* n48 = static_cast<Node48*>(n);
+                for (int k = 0; k < 256; ++k) {
+                    if (n48->slotOf[k]) fn(static_cast<unsigned char>(k), n48->children[n48->slotOf[k] - 1]);
+                }
+                break;
+            }
+            default: {
+                Node256* n256 = static_cast<Node256*>(n);
+                for (int k = 0; k < 256; ++k) {
+                    if (n256->children[k]) fn(static_cast<unsigned char>(k), n256->children[k]);
+                }
+                break;
+            }
+        }
+    }
+
+    template<typename Fn>
+    static void visit(Node* n, Fn& fn) {
+        if (n->type == LEAF) {
+            Leaf* leaf = static_cast<Leaf*>(n);
+            fn(static_cast<const K&>(leaf->key), leaf->value);
+            return;
+        }
+        Inner* in = static_cast<Inner*>(n);
+        if (in->terminal) fn(static_cast<const K&>(in->terminal->key), in->terminal->value);
+        forEachChild(in, [&](unsigned char, Node* child) { visit(child, fn); });
+    }
+
+    template<typename Fn>
+    void visitPrefix(View prefix, Fn& fn) const {
+        size_t len = Traits::size(prefix);
+        size_t depth = 0;
+        Node* n = root;
+        while (n) {
+            if (n->type == LEAF) {
+                View key = keyOf(static_cast<Leaf*>(n));
+                if (Traits::size(key) < len) return;
+                for (size_t i = depth; i < len; ++i) {
+                    if (Traits::at(key, i) != Traits::at(prefix, i)) return;
+                }
+                visit(n, fn);
+                return;
+            }
+            Inner* in = static_cast<Inner*>(n);
+            for (size_t i = 0; i < in->prefixLen && depth + i < len; ++i) {
+                if (prefixByte(in, depth, i) != Traits::at(prefix, depth + i)) return;
+            }
+            depth += in->prefixLen;
+            if (depth >= len) {
+                // Everything below shares the prefix
+                visit(n, fn);
+                return;
+            }
+            Node** child = findChild(in, Traits::at(prefix, depth));
+            if (!child) return;
+            n = *child;
+            ++depth;
+        }
+    }
+
+    // Copies n's subtree node-for-node; frees the partial copy if a copy throws
+    Node* cloneTree(Node* n) {
+        if (n->type == LEAF) {
+            Leaf* leaf = static_cast<Leaf*>(n);
+            return new Leaf(leaf->key, leaf->value);
+        }
+        Inner* in = static_cast<Inner*>(n);
+        Inner* copy;
+        switch (in->type) {
+            case NODE4: copy = newInner<Node4>(); break;
+            case NODE16: copy = newInner<Node16>(); break;
+            case NODE48: copy = newInner<Node48>(); break;
+            default: copy = newInner<Node256>(); break;
+        }
+        copyHeader(copy, in);
+        copy->terminal = nullptr;
+        copy->count = 0;
+        Node* ref = copy;
+        try {
+            if (in->terminal) copy->terminal = static_cast<Leaf*>(cloneTree(in->terminal));
+            // Re-adding children in order reproduces the layout, Node48 slots included
+            forEachChild(in, [&](unsigned char b, Node* child) {
+                Node* c = cloneTree(child);
+                addChild(ref, b, c);
+            });
+        } catch (...) {
+            destroyTree(ref);
+            throw;
+        }
+        return ref;
+    }
+
+    void destroyTree(Node* n) {
+        if (!n) return;
+        if (n->type != LEAF) {
+            Inner* in = static_cast<Inner*>(n);
+            if (in->terminal) freeNode(in->terminal);
+            forEachChild(in, [&](unsigned char, Node* child) { destroyTree(child); });
+        }
+        freeNode(n);
+    }
+
+    template<typename Key>
+    using EnableIfView = std::enable_if_t<std::is_same_v<typename ArtKeyTraits<Key>::View, View>>;
+
+public:
+    ArtMap() : root(nullptr), sz(0), innerCount() {}
+
+    ArtMap(ArtMap&& other) noexcept : root(other.root), sz(other.sz), innerCount() {
+        std::memcpy(innerCount, other.innerCount, sizeof(innerCount));
+        other.root = nullptr;
+        other.sz = 0;
+        std::memset(other.innerCount, 0, sizeof(other.innerCount));
+    }
+
+    ArtMap& operator=(ArtMap&& other) noexcept {
+        if (this != &other) {
+            destroyTree(root);
+            root = other.root;
+            sz = other.sz;
+            std::memcpy(innerCount, other.innerCount, sizeof(innerCount));
+            other.root = nullptr;
+            other.sz = 0;
+            std::memset(other.innerCount, 0, sizeof(other.innerCount));
+        }
+        return *this;
+    }
+
+    // Inserts key, or overwrites its value if already present
+    template<typename KType, typename VType>
+    void insert(KType&& key, VType&& value) {
+        if constexpr (!std::is_same_v<std::decay_t<KType>, K>) {
+            insert(K(std::forward<KType>(key)), std::forward<VType>(value));
+        } else {
+            if (Leaf* leaf = findLeaf(Traits::view(key))) {
+                leaf->value = std::forward<VType>(value);
+                return;
+            }
+            insertLeaf(new Leaf(std::forward<KType>(key), std::forward<VType>(value)));
+            ++sz;
+        }
+    }
+
+    void erase(const K& key) { eraseKey(Traits::view(key)); }
+
+    template<typename Key, typename = EnableIfView<Key>>
+    void erase(const Key& key) { eraseKey(ArtKeyTraits<Key>::view(key)); }
+
+    V* find(const K& key) {
+        Leaf* leaf = findLeaf(Traits::view(key));
+        return leaf ? &leaf->value : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        Leaf* leaf = findLeaf(Traits::view(key));
+        return leaf ? &leaf->value : nullptr;
+    }
+
+    // Any key type with the same byte view, e.g. a std::string_view or a
+    // string literal for ArtMap<std::string, V>, without building a K
+    template<typename Key, typename = EnableIfView<Key>>
+    V* find(const Key& key) {
+        Leaf* leaf = findLeaf(ArtKeyTraits<Key>::view(key));
+        return leaf ? &leaf->value : nullptr;
+    }
+
+    template<typename Key, typename = EnableIfView<Key>>
+    const V* find(const Key& key) const {
+        Leaf* leaf = findLeaf(ArtKeyTraits<Key>::view(key));
+        return leaf ? &leaf->value : nullptr;
+    }
+
+    bool contains(const K& key) const { return findLeaf(Traits::view(key)) != nullptr; }
+
+    template<typename Key, typename = EnableIfView<Key>>
+    bool contains(const Key& key) const { return findLeaf(ArtKeyTraits<Key>::view(key)) != nullptr; }
+
+    V& operator[](const K& key) {
+        if (Leaf* leaf = findLeaf(Traits::view(key))) return leaf->value;
+        Leaf* leaf = new Leaf(key, V{});
+        insertLeaf(leaf);
+        ++sz;
+        return leaf->value;
+    }
+
+    ArtMap clone() const {
+        ArtMap copy;
+        if (root) copy.root = copy.cloneTree(root);
+        copy.sz = sz;
+        return copy;
+    }
+
+    // Visits entries in key order as fn(key, value); fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        if (root) visit(root, fn);
+    }
+
+    // Visits, in key order, the entries whose key starts with prefix. Costs
+    // one step per prefix byte to reach the subtree, then only what it holds.
+    template<typename Fn>
+    void for_each_prefix(const K& prefix, Fn&& fn) {
+        visitPrefix(Traits::view(prefix), fn);
+    }
+
+    template<typename Key, typename Fn, typename = EnableIfView<Key>>
+    void for_each_prefix(const Key& prefix, Fn&& fn) {
+        visitPrefix(ArtKeyTraits<Key>::view(prefix), fn);
+    }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    // One block per entry plus the inner nodes; payload is the key and value
+    MemoryUsage memory_usage() const {
+        size_t heap = sz * nodeBlockBytes(sizeof(Leaf)) + innerCount[NODE4] * nodeBlockBytes(sizeof(Node4)) +
+                      innerCount[NODE16] * nodeBlockBytes(sizeof(Node16)) +
+                      innerCount[NODE48] * nodeBlockBytes(sizeof(Node48)) +
+                      innerCount[NODE256] * nodeBlockBytes(sizeof(Node256));
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(K) + sizeof(V), heap);
+    }
+
+    void print() const {
+        std::cout << "ArtMap: ";
+        auto show = [](const K& k, const V& v) { std::cout << "{" << k << ": " << v << "} "; };
+        if (root) visit(root, show);
+        std::cout << "\n";
+    }
+
+    ~ArtMap() {
+        destroyTree(root);
+    }
+
+    // Delete copy constructor and copy assignment
+    ArtMap(const ArtMap&) = delete;
+    ArtMap& operator=(const ArtMap&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,203 @@
+// File: include/async_channel.hpp
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "executor.hpp"
+#include "intrusive.hpp"
+#include "queue.hpp"
+
+// Bounded multi-producer/multi-consumer channel for coroutines:
+//
+//     co_await ch.push(x);                       // false once the channel is closed
+//     std::optional<T> item = co_await ch.pop(); // empty once closed and drained
+//
+// A push into a full channel parks the producer until a consumer makes room
+// (backpressure); a pop from an empty one parks the consumer. Parked
+// coroutines are not threads: each is a suspended frame linked into a wait
+// list through a hook in its awaiter, and is handed back to the channel's
+// executor when it can continue. Items are buffered in a RingQueue reserved
+// to the capacity up front, so steady-state traffic allocates nothing. A
+// capacity of 0 makes every push wait for a matching pop (rendezvous).
+template <typename T>
+class AsyncChannel {
+public:
+    class PushAwaiter {
+    private:
+        friend class AsyncChannel;
+
+        AsyncChannel& channel;
+        T value;
+        std::coroutine_handle<> waiter;
+        bool accepted;
+
+    public:
+        ListHook hook;
+
+        template<typename U>
+        PushAwaiter(AsyncChannel& ch, U&& v)
+            : channel(ch), value(std::forward<U>(v)), waiter(), accepted(false), hook() {}
+
+        bool await_ready() const noexcept { return false; }
+
+        // Decides under the lock whether to hand off, buffer, or park; returning
+        // false resumes the caller immediately without a trip through the executor
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(channel.mutex);
+            if (channel.closed) return false;
+            if (!channel.poppers.empty()) {
+                PopAwaiter& consumer = channel.poppers.front();
+                channel.poppers.pop_front();
+                consumer.result.emplace(std::move(value));
+                channel.executor.post(consumer.waiter);
+                accepted = true;
+                return false;
+            }
+            if (channel.buffer.size() < channel.capacity) {
+                channel.buffer.push(std::move(value));
+                accepted = true;
+                return false;
+            }
+            waiter = h;
+            channel.pushers.push_back(*this);
+            return true;
+        }
+
+        bool await_resume() const noexcept { return accepted; }
+    };
+
+    class PopAwaiter {
+    private:
+        friend class AsyncChannel;
+
+        AsyncChannel& channel;
+        std::optional<T> result;
+        std::coroutine_handle<> waiter;
+
+    public:
+        ListHook hook;
+
+        explicit PopAwaiter(AsyncChannel& ch) : channel(ch), result(), waiter(), hook() {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(channel.mutex);
+            if (channel.takeLocked(result)) return false;
+            if (channel.closed) return false;
+            waiter = h;
+            channel.poppers.push_back(*this);
+            return true;
+        }
+
+        std::optional<T> await_resume() { return std::move(result); }
+    };
+
+private:
+    Executor& executor;
+    size_t capacity;
+    std::mutex mutex;
+    RingQueue<T> buffer;
+    IntrusiveList<PushAwaiter, &PushAwaiter::hook> pushers;
+    IntrusiveList<PopAwaiter, &PopAwaiter::hook> poppers;
+    bool closed;
+
+    // Takes the next item, refilling the buffer from the first parked producer
+    bool takeLocked(std::optional<T>& out) {
+        if (!buffer.empty()) {
+            out.emplace(std::move(buffer.front()));
+            buffer.pop();
+            if (!pushers.empty()) {
+                PushAwaiter& producer = pushers.front();
+                pushers.pop_front();
+                buffer.push(std::move(producer.value));
+                producer.accepted = true;
+                executor.post(producer.waiter);
+            }
+            return true;
+        }
+        if (!pushers.empty()) {
+            // Only reachable with capacity 0: take straight from the producer
+            PushAwaiter& producer = pushers.front();
+            pushers.pop_front();
+            out.emplace(std::move(producer.value));
+            producer.accepted = true;
+            executor.post(producer.waiter);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    AsyncChannel(Executor& ex, size_t cap)
+        : executor(ex), capacity(cap), mutex(), buffer(), pushers(), poppers(), closed(false) {
+        buffer.reserve(cap);
+    }
+
+    template<typename U>
+    PushAwaiter push(U&& value) {
+        return PushAwaiter(*this, std::forward<U>(value));
+    }
+
+    PopAwaiter pop() {
+        return PopAwaiter(*this);
+    }
+
+    // Non-suspending variants for callers outside a coroutine
+    template<typename U>
+    bool try_push(U&& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) return false;
+        if (!poppers.empty()) {
+            PopAwaiter& consumer = poppers.front();
+            poppers.pop_front();
+            consumer.result.emplace(std::forward<U>(value));
+            executor.post(consumer.waiter);
+            return true;
+        }
+        if (buffer.size() >= capacity) return false;
+        buffer.push(std::forward<U>(value));
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::optional<T> out;
+        takeLocked(out);
+        return out;
+    }
+
+    // Rejects further pushes and wakes every parked coroutine: producers see
+    // false, consumers drain what is buffered and then see an empty optional
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        while (!pushers.empty()) {
+            PushAwaiter& producer = pushers.front();
+            pushers.pop_front();
+            executor.post(producer.waiter);
+        }
+        while (!poppers.empty()) {
+            PopAwaiter& consumer = poppers.front();
+            poppers.pop_front();
+            executor.post(consumer.waiter);
+        }
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return buffer.size();
+    }
+
+    bool is_closed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+    AsyncChannel(const AsyncChannel&) = delete;
+    AsyncChannel& operator=(const AsyncChannel&) = delete;
+};
\ No newline at end of file
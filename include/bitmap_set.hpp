@@ -0,0 +1,665 @@
+// File: include/bitmap_set.hpp
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memory_usage.hpp"
+#include "vector.hpp"
+
+// Compressed set of integers of up to 32 bits, after Roaring bitmaps. The
+// value space is cut into chunks of 65536 by the high 16 bits, and each
+// chunk present stores its low 16 bits in whichever of three forms suits it:
+//   array   sorted uint16_t values, for up to 4096 of them (2 bytes each)
+//   bitmap  65536 bits (8 KiB), once a chunk holds more than 4096
+//   run     sorted (start, length - 1) pairs, 4 bytes per run of
+//           consecutive values; made by insert_range() and optimize()
+// So a sparse set costs about 2 bytes per value, a dense one at most one bit
+// per value, and long ranges almost nothing, against 40-odd bytes per value
+// in Set<int>. Chunk headers sit in one sorted Vector searched by binary
+// search.
+//
+// Union, intersection and their sizes work chunk by chunk; bitmaps are
+// combined 128 bits at a time with SSE2 where available.
+template <typename T = uint32_t>
+class BitmapSet {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= 4, "BitmapSet holds integers of up to 32 bits");
+
+private:
+    static constexpr uint32_t ARRAY_MAX = 4096;     // beyond this a bitmap is smaller
+    static constexpr size_t WORDS = 65536 / 64;
+
+    enum Kind : uint8_t { ARRAY, BITMAP, RUN };
+
+    struct Chunk {
+        uint16_t key;           // high 16 bits shared by the chunk's values
+        uint8_t kind;
+        uint32_t cardinality;
+        uint32_t size;          // values of an array, pairs of a run
+        uint32_t capacity;      // in the same unit
+        void* data;
+
+        uint16_t* values() const { return static_cast<uint16_t*>(data); }
+        uint64_t* words() const { return static_cast<uint64_t*>(data); }
+        uint16_t* runs() const { return static_cast<uint16_t*>(data); }   // start, length - 1, ...
+    };
+
+    Vector<Chunk> chunks;   // sorted by key
+    size_t sz;
+
+    // Order-preserving map to and from unsigned 32-bit: flip the sign bit
+    static uint32_t toBits(T value) {
+        using U = std::make_unsigned_t<T>;
+        U u = static_cast<U>(value);
+        if constexpr (std::is_signed_v<T>) u = static_cast<U>(u ^ (U(1) << (sizeof(T) * 8 - 1)));
+        return static_cast<uint32_t>(u);
+    }
+
+    static T fromBits(uint32_t bits) {
+        using U = std::make_unsigned_t<T>;
+        U u = static_cast<U>(bits);
+        if constexpr (std::is_signed_v<T>) u = static_cast<U>(u ^ (U(1) << (sizeof(T) * 8 - 1)));
+        return static_cast<T>(u);
+    }
+
+    static size_t dataBytes(const Chunk& c) {
+        if (c.kind == BITMAP) return WORDS * sizeof(uint64_t);
+        return c.capacity * (c.kind == RUN ? 2 : 1) * sizeof(uint16_t);
+    }
+
+    // Data bytes of cardinality values as an array or bitmap, whichever is smaller
+    static size_t plainBytes(uint32_t cardinality) {
+        return cardinality > ARRAY_MAX ? WORDS * sizeof(uint64_t) : cardinality * sizeof(uint16_t);
+    }
+
+    static void freeChunk(Chunk& c) {
+        ::operator delete(c.data);
+        c.data = nullptr;
+    }
+
+    static Chunk makeChunk(uint16_t key, uint8_t kind, uint32_t capacity) {
+        Chunk c{key, kind, 0, 0, capacity, nullptr};
+        c.data = ::operator new(dataBytes(c));
+        return c;
+    }
+
+    // Index of the chunk for key, or where it would be inserted
+    size_t chunkIndex(uint16_t key) const {
+        size_t first = 0, n = chunks.size();
+        while (n > 0) {
+            size_t half = n / 2;
+            if (chunks[first + half].key < key) {
+                first += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        return first;
+    }
+
+    static bool chunkContains(const Chunk& c, uint16_t low) {
+        switch (c.kind) {
+            case ARRAY: return std::binary_search(c.values(), c.values() + c.size, low);
+            case BITMAP: return (c.words()[low >> 6] >> (low & 63)) & 1;
+            default: {
+                // Last run starting at or before low
+                const uint16_t* r = c.runs();
+                size_t first = 0, n = c.size;
+                while (n > 0) {
+                    size_t half = n / 2;
+                    if (r[2 * (first + half)] <= low) {
+                        first += half + 1;
+                        n -= half + 1;
+                    } else {
+                        n = half;
+                    }
+                }
+                return first > 0 && low <= r[2 * (first - 1)] + r[2 * (first - 1) + 1];
+            }
+        }
+    }
+
+    // Writes c's values as a bitmap into out
+    static void fillBitmap(const Chunk& c, uint64_t* out) {
+        if (c.kind == BITMAP) {
+            std::memcpy(out, c.words(), WORDS * sizeof(uint64_t));
+            return;
+        }
+        std::memset(out, 0, WORDS * sizeof(uint64_t));
+        if (c.kind == ARRAY) {
+            for (uint32_t i = 0; i < c.size; ++i) out[c.values()[i] >> 6] |= uint64_t(1) << (c.values()[i] & 63);
+        } else {
+            for (uint32_t i = 0; i < c.size; ++i) setRange(out, c.runs()[2 * i], uint32_t(c.runs()[2 * i]) + c.runs()[2 * i + 1]);
+        }
+    }
+
+    // Sets bits [first, last] of a bitmap
+    static void setRange(uint64_t* words, uint32_t first, uint32_t last) {
+        uint32_t fw = first >> 6, lw = last >> 6;
+        uint64_t head = ~uint64_t(0) << (first & 63);
+        uint64_t tail = ~uint64_t(0) >> (63 - (last & 63));
+        if (fw == lw) {
+            words[fw] |= head & tail;
+            return;
+        }
+        words[fw] |= head;
+        for (uint32_t w = fw + 1; w < lw; ++w) words[w] = ~uint64_t(0);
+        words[lw] |= tail;
+    }
+
+    static uint32_t popcountWords(const uint64_t* words) {
+        uint32_t n = 0;
+        for (size_t i = 0; i < WORDS; ++i) n += static_cast<uint32_t>(std::popcount(words[i]));
+        return n;
+    }
+
+    // dst = a & b or a | b; returns the population of dst
+    template<bool Union>
+    static uint32_t combineWords(uint64_t* dst, const uint64_t* a, const uint64_t* b) {
+#if defined(__SSE2__)
+        for (size_t i = 0; i < WORDS; i += 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            __m128i r = Union ? _mm_or_si128(x, y) : _mm_and_si128(x, y);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), r);
+        }
+#else
+        for (size_t i = 0; i < WORDS; ++i) dst[i] = Union ? a[i] | b[i] : a[i] & b[i];
+#endif
+        return popcountWords(dst);
+    }
+
+    static uint32_t andCount(const uint64_t* a, const uint64_t* b) {
+        uint32_t n = 0;
+        for (size_t i = 0; i < WORDS; ++i) n += static_cast<uint32_t>(std::popcount(a[i] & b[i]));
+        return n;
+    }
+
+    // Chunk holding the cardinality values set in words, as an array when
+    // that is smaller
+    static Chunk chunkFromBitmap(uint16_t key, const uint64_t* words, uint32_t cardinality) {
+        if (cardinality > ARRAY_MAX) {
+            Chunk c = makeChunk(key, BITMAP, 0);
+            std::memcpy(c.words(), words, WORDS * sizeof(uint64_t));
+            c.cardinality = cardinality;
+            return c;
+        }
+        Chunk c = makeChunk(key, ARRAY, cardinality ? cardinality : 1);
+        for (size_t w = 0; w < WORDS; ++w) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                c.values()[c.size++] = static_cast<uint16_t>(w * 64 + static_cast<size_t>(std::countr_zero(bits)));
+            }
+        }
+        c.cardinality = c.size;
+        return c;
+    }
+
+    // Turns a run chunk into an array or bitmap, whichever fits
+    static void unpackRuns(Chunk& c) {
+        uint64_t words[WORDS];
+        fillBitmap(c, words);
+        Chunk plain = chunkFromBitmap(c.key, words, c.cardinality);
+        freeChunk(c);
+        c = plain;
+    }
+
+    static void arrayToBitmap(Chunk& c) {
+        uint64_t words[WORDS];
+        fillBitmap(c, words);
+        Chunk bitmap = makeChunk(c.key, BITMAP, 0);
+        std::memcpy(bitmap.words(), words, sizeof(words));
+        bitmap.cardinality = c.cardinality;
+        freeChunk(c);
+        c = bitmap;
+    }
+
+    static void grow(Chunk& c, uint32_t needed, uint32_t unit) {
+        if (needed <= c.capacity) return;
+        uint32_t cap = c.capacity * 2 > needed ? c.capacity * 2 : needed;
+        void* data = ::operator new(cap * unit * sizeof(uint16_t));
+        std::memcpy(data, c.data, c.size * unit * sizeof(uint16_t));
+        ::operator delete(c.data);
+        c.data = data;
+        c.capacity = cap;
+    }
+
+    // Gives a mostly empty array back half of its room
+    static void shrinkArray(Chunk& c) {
+        uint32_t cap = c.size * 2;
+        void* data = ::operator new(cap * sizeof(uint16_t));
+        std::memcpy(data, c.data, c.size * sizeof(uint16_t));
+        ::operator delete(c.data);
+        c.data = data;
+        c.capacity = cap;
+    }
+
+    // Adds low to c; returns false if it was already there
+    static bool chunkInsert(Chunk& c, uint16_t low) {
+        switch (c.kind) {
+            case ARRAY: {
+                uint16_t* end = c.values() + c.size;
+                uint16_t* pos = std::lower_bound(c.values(), end, low);
+                if (pos != end && *pos == low) return false;
+                if (c.size == ARRAY_MAX) {
+                    arrayToBitmap(c);
+                    return chunkInsert(c, low);
+                }
+                size_t at = static_cast<size_t>(pos - c.values());
+                grow(c, c.size + 1, 1);
+                std::memmove(c.values() + at + 1, c.values() + at, (c.size - at) * sizeof(uint16_t));
+                c.values()[at] = low;
+                ++c.size;
+                ++c.cardinality;
+                return true;
+            }
+            case BITMAP: {
+                uint64_t& word = c.words()[low >> 6];
+                uint64_t bit = uint64_t(1) << (low & 63);
+                if (word & bit) return false;
+                word |= bit;
+                ++c.cardinality;
+                return true;
+            }
+            default: {
+                // First run starting after low, by binary search
+                uint16_t* r = c.runs();
+                size_t i = 0, n = c.size;
+                while (n > 0) {
+                    size_t half = n / 2;
+                    if (r[2 * (i + half)] <= low) {
+                        i += half + 1;
+                        n -= half + 1;
+                    } else {
+                        n = half;
+                    }
+                }
+                if (i > 0 && low <= uint32_t(r[2 * (i - 1)]) + r[2 * (i - 1) + 1]) return false;
+                bool joinPrev = i > 0 && uint32_t(r[2 * (i - 1)]) + r[2 * (i - 1) + 1] + 1 == low;
+                bool joinNext = i < c.size && uint32_t(low) + 1 == r[2 * i];
+                if (joinPrev && joinNext) {
+                    r[2 * (i - 1) + 1] = static_cast<uint16_t>(r[2 * (i - 1) + 1] + r[2 * i + 1] + 2);
+                    std::memmove(r + 2 * i, r + 2 * (i + 1), (c.size - i - 1) * 2 * sizeof(uint16_t));
+                    --c.size;
+                } else if (joinPrev) {
+                    ++r[2 * (i - 1) + 1];
+                } else if (joinNext) {
+                    --r[2 * i];
+                    ++r[2 * i + 1];
+                } else {
+                    grow(c, c.size + 1, 2);
+                    r = c.runs();
+                    std::memmove(r + 2 * (i + 1), r + 2 * i, (c.size - i) * 2 * sizeof(uint16_t));
+                    r[2 * i] = low;
+                    r[2 * i + 1] = 0;
+                    ++c.size;
+                }
+                ++c.cardinality;
+                // Scattered inserts can make runs the largest form; switch
+                // before they cost more than an array or bitmap would
+                if (c.size * 2 * sizeof(uint16_t) > plainBytes(c.cardinality)) unpackRuns(c);
+                return true;
+            }
+        }
+    }
+
+    // Removes low from c; returns false if it was absent
+    static bool chunkErase(Chunk& c, uint16_t low) {
+        if (c.kind == RUN) {
+            if (!chunkContains(c, low)) return false;
+            unpackRuns(c);
+        }
+        if (c.kind == ARRAY) {
+            uint16_t* end = c.values() + c.size;
+            uint16_t* pos = std::lower_bound(c.values(), end, low);
+            if (pos == end || *pos != low) return false;
+            std::memmove(pos, pos + 1, static_cast<size_t>(end - pos - 1) * sizeof(uint16_t));
+            --c.size;
+            --c.cardinality;
+            if (c.size * 4 < c.capacity && c.capacity > 16) shrinkArray(c);
+            return true;
+        }
+        uint64_t& word = c.words()[low >> 6];
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (!(word & bit)) return false;
+        word &= ~bit;
+        if (--c.cardinality == ARRAY_MAX) {
+            Chunk array = chunkFromBitmap(c.key, c.words(), c.cardinality);
+            freeChunk(c);
+            c = array;
+        }
+        return true;
+    }
+
+    // Result chunk of a | b or a & b (same key); cardinality 0 means empty
+    template<bool Union>
+    static Chunk combine(const Chunk& a, const Chunk& b) {
+        if (a.kind == ARRAY && b.kind == ARRAY && (!Union || a.cardinality + b.cardinality <= ARRAY_MAX)) {
+            Chunk c = makeChunk(a.key, ARRAY, Union ? a.size + b.size : std::min(a.size, b.size) + 1);
+            uint16_t* out = c.values();
+            uint16_t* end = Union ? std::set_union(a.values(), a.values() + a.size, b.values(), b.values() + b.size, out)
+                                  : std::set_intersection(a.values(), a.values() + a.size, b.values(),
+                                                          b.values() + b.size, out);
+            c.size = c.cardinality = static_cast<uint32_t>(end - out);
+            return c;
+        }
+        if (!Union && (a.kind == ARRAY || b.kind == ARRAY)) {
+            // Probe the other chunk for each of the array's values
+            const Chunk& small = a.kind == ARRAY ? a : b;
+            const Chunk& other = a.kind == ARRAY ? b : a;
+            Chunk c = makeChunk(a.key, ARRAY, small.size);
+            for (uint32_t i = 0; i < small.size; ++i) {
+                if (chunkContains(other, small.values()[i])) c.values()[c.size++] = small.values()[i];
+            }
+            c.cardinality = c.size;
+            return c;
+        }
+        uint64_t x[WORDS], y[WORDS];
+        fillBitmap(a, x);
+        fillBitmap(b, y);
+        uint32_t cardinality = combineWords<Union>(x, x, y);
+        return chunkFromBitmap(a.key, x, cardinality);
+    }
+
+    static uint32_t intersectionCount(const Chunk& a, const Chunk& b) {
+        if (a.kind == ARRAY || b.kind == ARRAY) {
+            const Chunk& small = a.kind == ARRAY && (b.kind != ARRAY || a.size <= b.size) ? a : b;
+            const Chunk& other = &small == &a ? b : a;
+            uint32_t n = 0;
+            for (uint32_t i = 0; i < small.size; ++i) n += chunkContains(other, small.values()[i]);
+            return n;
+        }
+        if (a.kind == BITMAP && b.kind == BITMAP) return andCount(a.words(), b.words());
+        uint64_t x[WORDS], y[WORDS];
+        fillBitmap(a, x);
+        fillBitmap(b, y);
+        return andCount(x, y);
+    }
+
+    static Chunk copyChunk(const Chunk& c) {
+        Chunk copy = makeChunk(c.key, c.kind, c.capacity);
+        std::memcpy(copy.data, c.data, dataBytes(c));
+        copy.cardinality = c.cardinality;
+        copy.size = c.size;
+        return copy;
+    }
+
+    template<typename Fn>
+    static void visitChunk(const Chunk& c, Fn& fn) {
+        uint32_t base = uint32_t(c.key) << 16;
+        switch (c.kind) {
+            case ARRAY:
+                for (uint32_t i = 0; i < c.size; ++i) fn(fromBits(base | c.values()[i]));
+                break;
+            case BITMAP:
+                for (size_t w = 0; w < WORDS; ++w) {
+                    for (uint64_t bits = c.words()[w]; bits; bits &= bits - 1) {
+                        fn(fromBits(base | static_cast<uint32_t>(w * 64 + static_cast<size_t>(std::countr_zero(bits)))));
+                    }
+                }
+                break;
+            default:
+                for (uint32_t i = 0; i < c.size; ++i) {
+                    uint32_t first = c.runs()[2 * i];
+                    uint32_t last = first + c.runs()[2 * i + 1];
+                    for (uint32_t v = first; v <= last; ++v) fn(fromBits(base | v));
+                }
+                break;
+        }
+    }
+
+    void release() {
+        for (size_t i = 0; i < chunks.size(); ++i) freeChunk(chunks[i]);
+    }
+
+public:
+    BitmapSet() : chunks(), sz(0) {}
+
+    BitmapSet(BitmapSet&& other) noexcept : chunks(std::move(other.chunks)), sz(other.sz) {
+        other.sz = 0;
+    }
+
+    BitmapSet& operator=(BitmapSet&& other) noexcept {
+        if (this != &other) {
+            release();
+            chunks = std::move(other.chunks);
+            sz = other.sz;
+            other.sz = 0;
+        }
+        return *this;
+    }
+
+    // Returns false if value was already present
+    bool insert(T value) {
+        uint32_t bits = toBits(value);
+        uint16_t key = static_cast<uint16_t>(bits >> 16);
+        size_t i = chunkIndex(key);
+        if (i == chunks.size() || chunks[i].key != key) chunks.insert(i, makeChunk(key, ARRAY, 4));
+        bool added = chunkInsert(chunks[i], static_cast<uint16_t>(bits));
+        sz += added;
+        return added;
+    }
+
+    // Inserts every value in [first, last]. Whole chunks the range covers
+    // become single runs.
+    void insert_range(T first, T last) {
+        if (last < first) return;
+        uint32_t lo = toBits(first), hi = toBits(last);
+        for (uint32_t key = lo >> 16; key <= (hi >> 16); ++key) {
+            uint32_t from = key == (lo >> 16) ? lo & 0xFFFF : 0;
+            uint32_t to = key == (hi >> 16) ? hi & 0xFFFF : 0xFFFF;
+            size_t i = chunkIndex(static_cast<uint16_t>(key));
+            if (i == chunks.size() || chunks[i].key != key) {
+                Chunk c = makeChunk(static_cast<uint16_t>(key), RUN, 1);
+                c.runs()[0] = static_cast<uint16_t>(from);
+                c.runs()[1] = static_cast<uint16_t>(to - from);
+                c.size = 1;
+                c.cardinality = to - from + 1;
+                chunks.insert(i, c);
+                sz += c.cardinality;
+            } else {
+                Chunk& c = chunks[i];
+                uint64_t words[WORDS];
+                fillBitmap(c, words);
+                setRange(words, from, to);
+                uint32_t cardinality = popcountWords(words);
+                sz += cardinality - c.cardinality;
+                Chunk merged = chunkFromBitmap(c.key, words, cardinality);
+                freeChunk(c);
+                c = merged;
+            }
+        }
+    }
+
+    // Returns false if value was absent
+    bool erase(T value) {
+        uint32_t bits = toBits(value);
+        uint16_t key = static_cast<uint16_t>(bits >> 16);
+        size_t i = chunkIndex(key);
+        if (i == chunks.size() || chunks[i].key != key) return false;
+        if (!chunkErase(chunks[i], static_cast<uint16_t>(bits))) return false;
+        --sz;
+        if (chunks[i].cardinality == 0) {
+            freeChunk(chunks[i]);
+            chunks.erase(i);
+        }
+        return true;
+    }
+
+    bool contains(T value) const {
+        uint32_t bits = toBits(value);
+        uint16_t key = static_cast<uint16_t>(bits >> 16);
+        size_t i = chunkIndex(key);
+        return i < chunks.size() && chunks[i].key == key && chunkContains(chunks[i], static_cast<uint16_t>(bits));
+    }
+
+    // Keeps the values also in other
+    void intersect(const BitmapSet& other) {
+        Vector<Chunk> result;
+        size_t j = 0;
+        sz = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            while (j < other.chunks.size() && other.chunks[j].key < chunks[i].key) ++j;
+            if (j < other.chunks.size() && other.chunks[j].key == chunks[i].key) {
+                Chunk c = combine<false>(chunks[i], other.chunks[j]);
+                if (c.cardinality) {
+                    sz += c.cardinality;
+                    result.push_back(c);
+                } else {
+                    freeChunk(c);
+                }
+            }
+            freeChunk(chunks[i]);
+        }
+        chunks = std::move(result);
+    }
+
+    // Adds every value of other
+    void unite(const BitmapSet& other) {
+        Vector<Chunk> result;
+        size_t i = 0, j = 0;
+        sz = 0;
+        while (i < chunks.size() || j < other.chunks.size()) {
+            Chunk c;
+            if (j == other.chunks.size() || (i < chunks.size() && chunks[i].key < other.chunks[j].key)) {
+                c = chunks[i++];
+            } else if (i == chunks.size() || other.chunks[j].key < chunks[i].key) {
+                c = copyChunk(other.chunks[j++]);
+            } else {
+                c = combine<true>(chunks[i], other.chunks[j++]);
+                freeChunk(chunks[i++]);
+            }
+            sz += c.cardinality;
+            result.push_back(c);
+        }
+        chunks = std::move(result);
+    }
+
+    // |this & other| without building it
+    size_t intersection_size(const BitmapSet& other) const {
+        size_t n = 0, j = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            while (j < other.chunks.size() && other.chunks[j].key < chunks[i].key) ++j;
+            if (j < other.chunks.size() && other.chunks[j].key == chunks[i].key) {
+                n += intersectionCount(chunks[i], other.chunks[j]);
+            }
+        }
+        return n;
+    }
+
+    size_t union_size(const BitmapSet& other) const { return sz + other.sz - intersection_size(other); }
+
+    // Re-encodes each chunk in its smallest form, turning chunks made of few
+    // long runs into run chunks. Worth calling once a set is built.
+    void optimize() {
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            Chunk& c = chunks[i];
+            uint64_t words[WORDS];
+            fillBitmap(c, words);
+            uint32_t runs = 0;
+            for (size_t w = 0; w < WORDS; ++w) {
+                // A run starts at each set bit whose lower neighbour is clear
+                uint64_t carry = w ? words[w - 1] >> 63 : 0;
+                runs += static_cast<uint32_t>(std::popcount(words[w] & ~((words[w] << 1) | carry)));
+            }
+            size_t runBytes = runs * 2 * sizeof(uint16_t);
+            Chunk best;
+            if (runBytes < plainBytes(c.cardinality)) {
+                best = makeChunk(c.key, RUN, runs);
+                for (uint32_t v = 0; v < 65536;) {
+                    if (!((words[v >> 6] >> (v & 63)) & 1)) {
+                        ++v;
+                        continue;
+                    }
+                    uint32_t start = v;
+                    while (v < 65536 && ((words[v >> 6] >> (v & 63)) & 1)) ++v;
+                    best.runs()[2 * best.size] = static_cast<uint16_t>(start);
+                    best.runs()[2 * best.size + 1] = static_cast<uint16_t>(v - 1 - start);
+                    ++best.size;
+                }
+                best.cardinality = c.cardinality;
+            } else {
+                best = chunkFromBitmap(c.key, words, c.cardinality);
+            }
+            freeChunk(c);
+            c = best;
+        }
+    }
+
+    // Visits values in ascending order
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < chunks.size(); ++i) visitChunk(chunks[i], fn);
+    }
+
+    // Smallest and largest values; the set must not be empty
+    T min() const {
+        const Chunk& c = chunks[0];
+        uint32_t base = uint32_t(c.key) << 16;
+        if (c.kind == ARRAY) return fromBits(base | c.values()[0]);
+        if (c.kind == RUN) return fromBits(base | c.runs()[0]);
+        size_t w = 0;
+        while (!c.words()[w]) ++w;
+        return fromBits(base | static_cast<uint32_t>(w * 64 + static_cast<size_t>(std::countr_zero(c.words()[w]))));
+    }
+
+    T max() const {
+        const Chunk& c = chunks[chunks.size() - 1];
+        uint32_t base = uint32_t(c.key) << 16;
+        if (c.kind == ARRAY) return fromBits(base | c.values()[c.size - 1]);
+        if (c.kind == RUN) return fromBits(base | (uint32_t(c.runs()[2 * (c.size - 1)]) + c.runs()[2 * (c.size - 1) + 1]));
+        size_t w = WORDS - 1;
+        while (!c.words()[w]) --w;
+        return fromBits(base | static_cast<uint32_t>(w * 64 + 63 - static_cast<size_t>(std::countl_zero(c.words()[w]))));
+    }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    void clear() {
+        release();
+        chunks.clear();
+        sz = 0;
+    }
+
+    BitmapSet clone() const {
+        BitmapSet copy;
+        for (size_t i = 0; i < chunks.size(); ++i) copy.chunks.push_back(copyChunk(chunks[i]));
+        copy.sz = sz;
+        return copy;
+    }
+
+    // Payload would be sizeof(T) per value, but a dense set takes less than
+    // that in total, so the payload is capped at the total and compression
+    // shows as bytes_per_element() below sizeof(T)
+    MemoryUsage memory_usage() const {
+        size_t total = sizeof(*this) + chunks.memory_usage().total() - sizeof(chunks);
+        for (size_t i = 0; i < chunks.size(); ++i) total += heapBlockBytes(dataBytes(chunks[i]));
+        size_t payload = std::min(sz * sizeof(T), total);
+        return MemoryUsage(payload, total - payload);
+    }
+
+    void print() const {
+        std::cout << "BitmapSet: ";
+        for_each([](T v) { std::cout << +v << " "; });
+        std::cout << "\n";
+    }
+
+    ~BitmapSet() {
+        release();
+    }
+
+    // Delete copy constructor and copy assignment
+    BitmapSet(const BitmapSet&) = delete;
+    BitmapSet& operator=(const BitmapSet&) = delete;
+};
\ No newline at end of file
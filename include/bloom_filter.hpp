@@ -0,0 +1,511 @@
+// File: include/bloom_filter.hpp
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "map.hpp"
+#include "memory_usage.hpp"
+#include "set.hpp"
+
+// Blocked Bloom filter over 64-bit hashes. A key selects one 64-byte block,
+// one cache line, and sets k bits inside it, so a query touches exactly one
+// line whatever k is. The price is a slightly higher false-positive rate than
+// a classic Bloom filter of the same size, which the sizing below allows for.
+// A "no" is definite; a "yes" means "probably".
+//
+// The filter stores no keys and can be written out with save() and read back
+// with load(), e.g. next to a snapshot so a restarted process can reject
+// misses before the snapshot itself is loaded.
+class BlockedBloomFilter {
+private:
+    static constexpr size_t WORDS = 8;             // 8 x 64 bits = one 64-byte line
+    static constexpr size_t BLOCK_BITS = WORDS * 64;
+    static constexpr size_t MAX_HASHES = 16;
+    static constexpr size_t LOAD_STEP = 16384;     // blocks read per step by load(): 1 MiB
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+    static constexpr char MAGIC[8] = {'S', 'T', 'L', 'B', 'L', 'O', 'O', 'M'};
+
+    struct alignas(64) Block {
+        std::uint64_t words[WORDS];
+    };
+
+    Block* blocks;
+    size_t blockCount;
+    size_t hashCount;
+    size_t added;
+
+    // Spreads weak hashes (std::hash<int> is the identity) over all 64 bits
+    static std::uint64_t mix(std::uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // The high half of h picks the block; the in-block probes are 9-bit
+    // slices of a second, independent mix
+    const Block& blockFor(std::uint64_t h) const {
+        return blocks[((h >> 32) * blockCount) >> 32];
+    }
+
+    Block& blockFor(std::uint64_t h) {
+        return blocks[((h >> 32) * blockCount) >> 32];
+    }
+
+    void allocate(size_t count) {
+        blockCount = count < 1 ? 1 : count;
+        blocks = static_cast<Block*>(::operator new(sizeof(Block) * blockCount, std::align_val_t(alignof(Block))));
+        std::memset(static_cast<void*>(blocks), 0, sizeof(Block) * blockCount);
+    }
+
+    // Reallocates to count blocks, keeping the first min(count, blockCount)
+    // and zeroing the rest
+    void resize(size_t count) {
+        Block* old = blocks;
+        size_t kept = count < blockCount ? count : blockCount;
+        allocate(count);
+        if (old) {
+            std::memcpy(static_cast<void*>(blocks), old, sizeof(Block) * kept);
+            ::operator delete(old, std::align_val_t(alignof(Block)));
+        }
+    }
+
+    void release() {
+        if (blocks) ::operator delete(blocks, std::align_val_t(alignof(Block)));
+        blocks = nullptr;
+        blockCount = 0;
+    }
+
+    static double clampRate(double fpr) {
+        if (fpr < 1e-9) return 1e-9;
+        if (fpr > 0.5) return 0.5;
+        return fpr;
+    }
+
+    // Keys crowd unevenly into blocks, which hurts more the lower the target
+    // rate; measured, 5% extra bits per decade of rate makes up for it
+    static double blockingFactor(double fpr) {
+        return 1.0 + 0.05 * std::log10(1.0 / fpr);
+    }
+
+public:
+    // Bits per key for a target false-positive rate: the textbook optimum
+    // -ln(p) / ln(2)^2, widened for blocking
+    static double bitsPerKey(double fpr) {
+        fpr = clampRate(fpr);
+        return -std::log(fpr) / (std::log(2.0) * std::log(2.0)) * blockingFactor(fpr);
+    }
+
+    BlockedBloomFilter() : blocks(nullptr), blockCount(0), hashCount(1), added(0) {
+        allocate(1);
+    }
+
+    // Sized for expectedKeys at roughly the given false-positive rate
+    BlockedBloomFilter(size_t expectedKeys, double fpr) : blocks(nullptr), blockCount(0), hashCount(1), added(0) {
+        fpr = clampRate(fpr);
+        double bits = bitsPerKey(fpr);
+        size_t k = static_cast<size_t>(std::lround(bits / blockingFactor(fpr) * std::log(2.0)));
+        hashCount = k < 1 ? 1 : (k > MAX_HASHES ? MAX_HASHES : k);
+        double totalBits = bits * static_cast<double>(expectedKeys ? expectedKeys : 1);
+        allocate(static_cast<size_t>(std::ceil(totalBits / BLOCK_BITS)));
+    }
+
+    BlockedBloomFilter(BlockedBloomFilter&& other) noexcept
+        : blocks(other.blocks), blockCount(other.blockCount), hashCount(other.hashCount), added(other.added) {
+        other.blocks = nullptr;
+        other.blockCount = 0;
+        other.added = 0;
+    }
+
+    BlockedBloomFilter& operator=(BlockedBloomFilter&& other) noexcept {
+        if (this != &other) {
+            release();
+            blocks = other.blocks;
+            blockCount = other.blockCount;
+            hashCount = other.hashCount;
+            added = other.added;
+            other.blocks = nullptr;
+            other.blockCount = 0;
+            other.added = 0;
+        }
+        return *this;
+    }
+
+    // A moved-from filter has no blocks: it ignores adds and answers every
+    // query with "maybe", which is never wrong
+    void add_hash(std::uint64_t hash) {
+        if (blockCount == 0) return;
+        std::uint64_t h = mix(hash);
+        Block& block = blockFor(h);
+        std::uint64_t bits = mix(h + 0x9e3779b97f4a7c15ULL);
+        for (size_t i = 0; i < hashCount; ++i) {
+            if (i != 0 && i % 7 == 0) bits = mix(bits);
+            std::uint32_t bit = static_cast<std::uint32_t>(bits >> (9 * (i % 7))) & 511;
+            block.words[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+        }
+        ++added;
+    }
+
+    bool may_contain_hash(std::uint64_t hash) const {
+        if (blockCount == 0) return true;
+        std::uint64_t h = mix(hash);
+        const Block& block = blockFor(h);
+        std::uint64_t bits = mix(h + 0x9e3779b97f4a7c15ULL);
+        for (size_t i = 0; i < hashCount; ++i) {
+            if (i != 0 && i % 7 == 0) bits = mix(bits);
+            std::uint32_t bit = static_cast<std::uint32_t>(bits >> (9 * (i % 7))) & 511;
+            if (!(block.words[bit >> 6] & (std::uint64_t(1) << (bit & 63)))) return false;
+        }
+        return true;
+    }
+
+    template<typename T, typename Hash = std::hash<T>>
+    void add(const T& key, const Hash& hash = Hash()) {
+        add_hash(static_cast<std::uint64_t>(hash(key)));
+    }
+
+    template<typename T, typename Hash = std::hash<T>>
+    bool may_contain(const T& key, const Hash& hash = Hash()) const {
+        return may_contain_hash(static_cast<std::uint64_t>(hash(key)));
+    }
+
+    void clear() {
+        if (blocks) std::memset(static_cast<void*>(blocks), 0, sizeof(Block) * blockCount);
+        added = 0;
+    }
+
+    size_t hash_count() const { return hashCount; }
+    size_t bit_count() const { return blockCount * BLOCK_BITS; }
+    size_t added_count() const { return added; }
+
+    // Expected false-positive rate from the fraction of bits already set
+    double estimated_fpr() const {
+        if (blockCount == 0) return 1.0;
+        size_t set = 0;
+        for (size_t b = 0; b < blockCount; ++b)
+            for (size_t w = 0; w < WORDS; ++w) set += static_cast<size_t>(std::popcount(blocks[b].words[w]));
+        double fill = static_cast<double>(set) / static_cast<double>(bit_count());
+        return std::pow(fill, static_cast<double>(hashCount));
+    }
+
+    // Writes a self-describing image: magic, version, geometry, then the raw
+    // blocks in host byte order
+    bool save(std::ostream& out) const {
+        std::uint32_t version = FORMAT_VERSION;
+        std::uint64_t header[3] = {blockCount, hashCount, added};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(blocks), static_cast<std::streamsize>(sizeof(Block) * blockCount));
+        return static_cast<bool>(out);
+    }
+
+    // Replaces this filter with one written by save(); on a malformed or
+    // truncated image returns false and leaves the filter unchanged
+    bool load(std::istream& in) {
+        char magic[sizeof(MAGIC)];
+        std::uint32_t version = 0;
+        std::uint64_t header[3];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+        if (!in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != FORMAT_VERSION) return false;
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] == 0 || header[0] > SIZE_MAX / sizeof(Block) || header[1] == 0 || header[1] > MAX_HASHES)
+            return false;
+
+        // Grow the buffer only as blocks actually arrive, so a corrupt count
+        // fails on the short read instead of allocating all it claims
+        size_t count = static_cast<size_t>(header[0]);
+        BlockedBloomFilter loaded;
+        loaded.release();
+        size_t have = 0;
+        while (have < count) {
+            size_t step = count - have < LOAD_STEP ? count - have : LOAD_STEP;
+            if (have + step > loaded.blockCount) {
+                size_t room = loaded.blockCount * 2;
+                loaded.resize(room < have + step ? have + step : (room > count ? count : room));
+            }
+            if (!in.read(reinterpret_cast<char*>(loaded.blocks + have), static_cast<std::streamsize>(sizeof(Block) * step)))
+                return false;
+            have += step;
+        }
+        loaded.hashCount = static_cast<size_t>(header[1]);
+        loaded.added = static_cast<size_t>(header[2]);
+        *this = std::move(loaded);
+        return true;
+    }
+
+    MemoryUsage memory_usage() const {
+        return MemoryUsage(0, sizeof(*this) + sizeof(Block) * blockCount);
+    }
+
+    void print() const {
+        std::cout << "BlockedBloomFilter: " << bit_count() << " bits, " << hashCount << " hashes, "
+                  << added << " keys added\n";
+    }
+
+    ~BlockedBloomFilter() {
+        release();
+    }
+
+    // Delete copy constructor and copy assignment
+    BlockedBloomFilter(const BlockedBloomFilter&) = delete;
+    BlockedBloomFilter& operator=(const BlockedBloomFilter&) = delete;
+};
+
+// Set with a Bloom filter in front of contains(), for workloads where most
+// queries miss: a definite miss costs one hash and one cache line instead of
+// a full tree descent. Inserts update the filter. Erases cannot clear bits,
+// so the filter is rebuilt from the set once erased keys make up half of what
+// it holds, and it is resized whenever the set outgrows the size it was built
+// for. Transparent lookups need both a transparent Compare and a transparent
+// Hash that hashes equal keys of either type alike.
+template <typename T, typename Compare = std::less<T>, typename Hash = std::hash<T>>
+class FilteredSet {
+private:
+    Set<T, Compare> set;
+    BlockedBloomFilter filter;
+    Hash hash;
+    double fpr;
+    size_t capacity;   // keys the filter was sized for
+    size_t stale;      // erased keys whose bits are still set
+
+    std::uint64_t hashOf(const T& value) const { return static_cast<std::uint64_t>(hash(value)); }
+
+    template<typename Key>
+    std::uint64_t hashOf(const Key& key) const { return static_cast<std::uint64_t>(hash(key)); }
+
+    void noteErase() {
+        if (++stale * 2 > filter.added_count()) rebuild();
+    }
+
+public:
+    explicit FilteredSet(size_t expected = 1024, double falsePositiveRate = 0.01)
+        : set(), filter(expected, falsePositiveRate), hash(), fpr(falsePositiveRate),
+          capacity(expected ? expected : 1), stale(0) {}
+
+    FilteredSet(FilteredSet&& other) noexcept = default;
+    FilteredSet& operator=(FilteredSet&& other) noexcept = default;
+
+    template<typename U>
+    void insert(U&& value) {
+        if constexpr (!std::is_same_v<std::decay_t<U>, T>) {
+            insert(T(std::forward<U>(value)));   // hash and insert the same converted key
+        } else {
+            size_t before = set.size();
+            std::uint64_t h = hashOf(value);
+            set.insert(std::forward<U>(value));
+            if (set.size() == before) return;
+            if (set.size() > capacity) {
+                capacity *= 2;
+                rebuild();
+            } else {
+                filter.add_hash(h);
+            }
+        }
+    }
+
+    void erase(const T& value) {
+        size_t before = set.size();
+        set.erase(value);
+        if (set.size() != before) noteErase();
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    void erase(const Key& key) {
+        size_t before = set.size();
+        set.erase(key);
+        if (set.size() != before) noteErase();
+    }
+
+    bool contains(const T& value) const {
+        return filter.may_contain_hash(hashOf(value)) && set.contains(value);
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    bool contains(const Key& key) const {
+        return filter.may_contain_hash(hashOf(key)) && set.contains(key);
+    }
+
+    // Re-sizes the filter for the current capacity and target rate and
+    // re-adds every element, dropping the bits of erased ones
+    void rebuild() {
+        BlockedBloomFilter fresh(capacity, fpr);
+        set.for_each([&](const T& value) { fresh.add_hash(hashOf(value)); });
+        filter = std::move(fresh);
+        stale = 0;
+    }
+
+    // Trades memory for fewer false positives; takes effect immediately
+    void set_false_positive_rate(double falsePositiveRate) {
+        fpr = falsePositiveRate;
+        rebuild();
+    }
+
+    double false_positive_rate() const { return fpr; }
+    const BlockedBloomFilter& filter_view() const { return filter; }
+    const Set<T, Compare>& underlying() const { return set; }
+
+    size_t size() const { return set.size(); }
+    bool empty() const { return set.empty(); }
+
+    MemoryUsage memory_usage() const {
+        MemoryUsage usage = set.memory_usage();
+        usage.overhead += filter.memory_usage().total() + sizeof(*this) - sizeof(set) - sizeof(filter);
+        return usage;
+    }
+
+    void print() const {
+        std::cout << "Filtered";
+        set.print();
+    }
+
+    // Delete copy constructor and copy assignment
+    FilteredSet(const FilteredSet&) = delete;
+    FilteredSet& operator=(const FilteredSet&) = delete;
+};
+
+// Map counterpart of FilteredSet: find() and contains() consult the filter
+// before the tree
+template <typename K, typename V, typename Compare = std::less<K>, typename Hash = std::hash<K>>
+class FilteredMap {
+private:
+    Map<K, V, Compare> map;
+    BlockedBloomFilter filter;
+    Hash hash;
+    double fpr;
+    size_t capacity;
+    size_t stale;
+
+    template<typename Key>
+    std::uint64_t hashOf(const Key& key) const { return static_cast<std::uint64_t>(hash(key)); }
+
+    void noteErase() {
+        if (++stale * 2 > filter.added_count()) rebuild();
+    }
+
+    void noteInsert(std::uint64_t h) {
+        if (map.size() > capacity) {
+            capacity *= 2;
+            rebuild();
+        } else {
+            filter.add_hash(h);
+        }
+    }
+
+public:
+    explicit FilteredMap(size_t expected = 1024, double falsePositiveRate = 0.01)
+        : map(), filter(expected, falsePositiveRate), hash(), fpr(falsePositiveRate),
+          capacity(expected ? expected : 1), stale(0) {}
+
+    FilteredMap(FilteredMap&& other) noexcept = default;
+    FilteredMap& operator=(FilteredMap&& other) noexcept = default;
+
+    template<typename KType, typename VType>
+    void insert(KType&& key, VType&& value) {
+        if constexpr (!std::is_same_v<std::decay_t<KType>, K>) {
+            insert(K(std::forward<KType>(key)), std::forward<VType>(value));
+        } else {
+            size_t before = map.size();
+            std::uint64_t h = hashOf(key);
+            map.insert(std::forward<KType>(key), std::forward<VType>(value));
+            if (map.size() != before) noteInsert(h);
+        }
+    }
+
+    void erase(const K& key) {
+        size_t before = map.size();
+        map.erase(key);
+        if (map.size() != before) noteErase();
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    void erase(const Key& key) {
+        size_t before = map.size();
+        map.erase(key);
+        if (map.size() != before) noteErase();
+    }
+
+    V* find(const K& key) {
+        return filter.may_contain_hash(hashOf(key)) ? map.find(key) : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        return filter.may_contain_hash(hashOf(key)) ? map.find(key) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    V* find(const Key& key) {
+        return filter.may_contain_hash(hashOf(key)) ? map.find(key) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    const V* find(const Key& key) const {
+        return filter.may_contain_hash(hashOf(key)) ? map.find(key) : nullptr;
+    }
+
+    bool contains(const K& key) const {
+        return filter.may_contain_hash(hashOf(key)) && map.contains(key);
+    }
+
+    template<typename Key, typename C = Compare, typename H = Hash,
+             typename = typename C::is_transparent, typename = typename H::is_transparent>
+    bool contains(const Key& key) const {
+        return filter.may_contain_hash(hashOf(key)) && map.contains(key);
+    }
+
+    V& operator[](const K& key) {
+        size_t before = map.size();
+        V& value = map[key];
+        if (map.size() != before) noteInsert(hashOf(key));
+        return value;   // map nodes never move, so a rebuild leaves this valid
+    }
+
+    void rebuild() {
+        BlockedBloomFilter fresh(capacity, fpr);
+        map.for_each([&](const K& key, V&) { fresh.add_hash(hashOf(key)); });
+        filter = std::move(fresh);
+        stale = 0;
+    }
+
+    void set_false_positive_rate(double falsePositiveRate) {
+        fpr = falsePositiveRate;
+        rebuild();
+    }
+
+    double false_positive_rate() const { return fpr; }
+    const BlockedBloomFilter& filter_view() const { return filter; }
+
+    size_t size() const { return map.size(); }
+    bool empty() const { return map.empty(); }
+
+    MemoryUsage memory_usage() const {
+        MemoryUsage usage = map.memory_usage();
+        usage.overhead += filter.memory_usage().total() + sizeof(*this) - sizeof(map) - sizeof(filter);
+        return usage;
+    }
+
+    void print() const {
+        std::cout << "Filtered";
+        map.print();
+    }
+
+    // Delete copy constructor and copy assignment
+    FilteredMap(const FilteredMap&) = delete;
+    FilteredMap& operator=(const FilteredMap&) = delete;
+};
\ No newline at end of file
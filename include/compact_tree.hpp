@@ -0,0 +1,607 @@
+// File: include/compact_tree.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "compare.hpp"
+#include "memory_usage.hpp"
+
+// AVL tree for large sets of small keys. Nodes live in one contiguous pool and
+// link to each other by 32-bit index rather than by pointer, and the balance
+// factor (-1, 0, +1) rides in the top two bits of the left link, so a node is
+// just the element plus 8 bytes. For int keys that is 12 bytes per entry
+// against Set's 24-byte node plus its malloc header. The pool grows by half
+// its size, so expect up to a third of it to be spare unless reserve() was
+// called up front. Erased slots are recycled through a free list threaded
+// through the right link.
+//
+// Growing the pool relocates the elements, so pointers returned by find()
+// are only valid until the next insertion.
+template <typename Slot, typename KeyOf, typename Compare>
+class CompactTree {
+public:
+    using Index = std::uint32_t;
+    static constexpr Index NIL = (Index(1) << 30) - 1;
+    static constexpr size_t MAX_NODES = NIL;
+
+private:
+    static constexpr Index LINK_MASK = NIL;
+    static constexpr Index FREE_TAG = Index(3) << 30;   // balance bits of a slot on the free list
+
+    struct Node {
+        alignas(Slot) unsigned char storage[sizeof(Slot)];
+        Index leftAndBalance;   // low 30 bits: left child; high 2 bits: balance + 1
+        Index right;
+    };
+
+    Node* pool;
+    size_t used;    // slots [0, used) have been handed out, live or free
+    size_t cap;
+    Index root;
+    Index freeHead;
+    size_t sz;
+    Compare comp;
+
+    Slot& slot(Index n) { return *std::launder(reinterpret_cast<Slot*>(pool[n].storage)); }
+    const Slot& slot(Index n) const { return *std::launder(reinterpret_cast<const Slot*>(pool[n].storage)); }
+    const auto& keyAt(Index n) const { return KeyOf::get(slot(n)); }
+
+    bool isFree(Index n) const { return (pool[n].leftAndBalance & FREE_TAG) == FREE_TAG; }
+
+    Index left(Index n) const { return pool[n].leftAndBalance & LINK_MASK; }
+    Index right(Index n) const { return pool[n].right; }
+    int balance(Index n) const { return static_cast<int>(pool[n].leftAndBalance >> 30) - 1; }
+
+    void setLeft(Index n, Index child) {
+        pool[n].leftAndBalance = (pool[n].leftAndBalance & ~LINK_MASK) | child;
+    }
+
+    void setRight(Index n, Index child) { pool[n].right = child; }
+
+    // balance is height(right) - height(left)
+    void setBalance(Index n, int b) {
+        pool[n].leftAndBalance = (pool[n].leftAndBalance & LINK_MASK) | (static_cast<Index>(b + 1) << 30);
+    }
+
+    // Moves every live element into a pool of new_cap slots; indices are kept
+    void relocate(size_t new_cap) {
+        Node* fresh = static_cast<Node*>(::operator new(sizeof(Node) * new_cap));
+        size_t i = 0;
+        try {
+            for (; i < used; ++i) {
+                fresh[i].leftAndBalance = pool[i].leftAndBalance;
+                fresh[i].right = pool[i].right;
+                if (!isFree(static_cast<Index>(i)))
+                    new (fresh[i].storage) Slot(std::move(slot(static_cast<Index>(i))));
+            }
+        } catch (...) {
+            while (i-- > 0) {
+                if (!isFree(static_cast<Index>(i)))
+                    std::launder(reinterpret_cast<Slot*>(fresh[i].storage))->~Slot();
+            }
+            ::operator delete(fresh);
+            throw;
+        }
+        destroyAll();
+        ::operator delete(pool);
+        pool = fresh;
+        cap = new_cap;
+    }
+
+    void destroyAll() {
+        if constexpr (!std::is_trivially_destructible_v<Slot>) {
+            for (size_t i = 0; i < used; ++i) {
+                if (!isFree(static_cast<Index>(i))) slot(static_cast<Index>(i)).~Slot();
+            }
+        }
+    }
+
+    template<typename... Args>
+    Index allocate(Args&&... args) {
+        Index n;
+        if (freeHead != NIL) {
+            n = freeHead;
+            new (pool[n].storage) Slot(std::forward<Args>(args)...);
+            freeHead = pool[n].right;
+        } else {
+            if (used == MAX_NODES) throw std::length_error("CompactTree: node limit reached");
+            if (used == cap) {
+                size_t grown = cap ? cap + (cap > 1 ? cap / 2 : 1) : 16;
+                relocate(grown < MAX_NODES ? grown : MAX_NODES);
+            }
+            n = static_cast<Index>(used);
+            new (pool[n].storage) Slot(std::forward<Args>(args)...);
+            ++used;
+        }
+        pool[n].leftAndBalance = NIL | (Index(1) << 30);   // no children, balance 0
+        pool[n].right = NIL;
+        return n;
+    }
+
+    void release(Index n) {
+        slot(n).~Slot();
+        pool[n].leftAndBalance = FREE_TAG;
+        pool[n].right = freeHead;
+        freeHead = n;
+    }
+
+    // Rotates a subtree whose left side is two levels taller (n's stored
+    // balance still reads -1). dropped reports whether the subtree ended up
+    // one level shorter than before the rotation, which matters on erase.
+    Index fixLeftHeavy(Index n, bool& dropped) {
+        Index l = left(n);
+        int lb = balance(l);
+        if (lb <= 0) {
+            setLeft(n, right(l));
+            setRight(l, n);
+            setBalance(n, lb == 0 ? -1 : 0);
+            setBalance(l, lb == 0 ? 1 : 0);
+            dropped = lb != 0;
+            return l;
+        }
+        Index g = right(l);
+        int gb = balance(g);
+        setRight(l, left(g));
+        setLeft(n, right(g));
+        setLeft(g, l);
+        setRight(g, n);
+        setBalance(l, gb == 1 ? -1 : 0);
+        setBalance(n, gb == -1 ? 1 : 0);
+        setBalance(g, 0);
+        dropped = true;
+        return g;
+    }
+
+    Index fixRightHeavy(Index n, bool& dropped) {
+        Index r = right(n);
+        int rb = balance(r);
+        if (rb >= 0) {
+            setRight(n, left(r));
+            setLeft(r, n);
+            setBalance(n, rb == 0 ? 1 : 0);
+            setBalance(r, rb == 0 ? -1 : 0);
+            dropped = rb != 0;
+            return r;
+        }
+        Index g = left(r);
+        int gb = balance(g);
+        setLeft(r, right(g));
+        setRight(n, left(g));
+        setLeft(g, n);
+        setRight(g, r);
+        setBalance(r, gb == -1 ? 1 : 0);
+        setBalance(n, gb == 1 ? -1 : 0);
+        setBalance(g, 0);
+        dropped = true;
+        return g;
+    }
+
+    // Descends by key and, if it is absent, links the node make() returns.
+    // Nothing compares key after make() runs, so make may consume it.
+    template<typename Key, typename Make>
+    Index insertAt(Index n, const Key& key, Make& make, bool& grew, Index& hit, bool& inserted) {
+        if (n == NIL) {
+            hit = make();
+            ++sz;
+            grew = true;
+            inserted = true;
+            return hit;
+        }
+
+        if (comp(key, keyAt(n))) {
+            Index child = insertAt(left(n), key, make, grew, hit, inserted);
+            setLeft(n, child);
+            if (!grew) return n;
+            int b = balance(n);
+            if (b == 1) { setBalance(n, 0); grew = false; return n; }
+            if (b == 0) { setBalance(n, -1); return n; }
+            grew = false;
+            bool dropped;
+            return fixLeftHeavy(n, dropped);
+        }
+        if (comp(keyAt(n), key)) {
+            Index child = insertAt(right(n), key, make, grew, hit, inserted);
+            setRight(n, child);
+            if (!grew) return n;
+            int b = balance(n);
+            if (b == -1) { setBalance(n, 0); grew = false; return n; }
+            if (b == 0) { setBalance(n, 1); return n; }
+            grew = false;
+            bool dropped;
+            return fixRightHeavy(n, dropped);
+        }
+
+        grew = false;
+        hit = n;
+        return n;
+    }
+
+    // n's left subtree just lost a level; shrunk reports whether n's did too
+    Index leftShrunk(Index n, bool& shrunk) {
+        int b = balance(n);
+        if (b == -1) { setBalance(n, 0); return n; }
+        if (b == 0) { setBalance(n, 1); shrunk = false; return n; }
+        return fixRightHeavy(n, shrunk);
+    }
+
+    Index rightShrunk(Index n, bool& shrunk) {
+        int b = balance(n);
+        if (b == 1) { setBalance(n, 0); return n; }
+        if (b == 0) { setBalance(n, -1); shrunk = false; return n; }
+        return fixLeftHeavy(n, shrunk);
+    }
+
+    Index detachMin(Index n, Index& min, bool& shrunk) {
+        if (left(n) == NIL) {
+            min = n;
+            shrunk = true;
+            return right(n);
+        }
+        Index child = detachMin(left(n), min, shrunk);
+        setLeft(n, child);
+        return shrunk ? leftShrunk(n, shrunk) : n;
+    }
+
+    // Unlinks the node matching key into removed (left NIL if absent)
+    template<typename Key>
+    Index detach(Index n, const Key& key, bool& shrunk, Index& removed) {
+        if (n == NIL) {
+            shrunk = false;
+            return NIL;
+        }
+
+        if (comp(key, keyAt(n))) {
+            Index child = detach(left(n), key, shrunk, removed);
+            setLeft(n, child);
+            return shrunk ? leftShrunk(n, shrunk) : n;
+        }
+        if (comp(keyAt(n), key)) {
+            Index child = detach(right(n), key, shrunk, removed);
+            setRight(n, child);
+            return shrunk ? rightShrunk(n, shrunk) : n;
+        }
+
+        removed = n;
+        Index l = left(n);
+        Index r = right(n);
+        shrunk = true;
+        if (l == NIL) return r;
+        if (r == NIL) return l;
+        Index min = NIL;
+        Index rest = detachMin(r, min, shrunk);
+        setLeft(min, l);
+        setRight(min, rest);
+        setBalance(min, balance(n));
+        return shrunk ? rightShrunk(min, shrunk) : min;
+    }
+
+    template<typename Fn>
+    void inorder(Index n, Fn& fn) {
+        if (n != NIL) {
+            inorder(left(n), fn);
+            fn(slot(n));
+            inorder(right(n), fn);
+        }
+    }
+
+    template<typename Fn>
+    void inorder(Index n, Fn& fn) const {
+        if (n != NIL) {
+            inorder(left(n), fn);
+            fn(slot(n));
+            inorder(right(n), fn);
+        }
+    }
+
+    void reset() {
+        destroyAll();
+        used = 0;
+        root = NIL;
+        freeHead = NIL;
+        sz = 0;
+    }
+
+public:
+    CompactTree() : pool(nullptr), used(0), cap(0), root(NIL), freeHead(NIL), sz(0), comp() {}
+
+    explicit CompactTree(const Compare& c)
+        : pool(nullptr), used(0), cap(0), root(NIL), freeHead(NIL), sz(0), comp(c) {}
+
+    CompactTree(CompactTree&& other) noexcept
+        : pool(other.pool), used(other.used), cap(other.cap), root(other.root),
+          freeHead(other.freeHead), sz(other.sz), comp(std::move(other.comp)) {
+        other.pool = nullptr;
+        other.used = other.cap = other.sz = 0;
+        other.root = other.freeHead = NIL;
+    }
+
+    CompactTree& operator=(CompactTree&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ::operator delete(pool);
+            pool = other.pool;
+            used = other.used;
+            cap = other.cap;
+            root = other.root;
+            freeHead = other.freeHead;
+            sz = other.sz;
+            comp = std::move(other.comp);
+            other.pool = nullptr;
+            other.used = other.cap = other.sz = 0;
+            other.root = other.freeHead = NIL;
+        }
+        return *this;
+    }
+
+    // Returns the slot holding key, creating it with make() if absent
+    template<typename Key, typename Make>
+    Slot& emplace(const Key& key, Make&& make, bool& inserted) {
+        bool grew = false;
+        Index hit = NIL;
+        inserted = false;
+        root = insertAt(root, key, make, grew, hit, inserted);
+        return slot(hit);
+    }
+
+    template<typename... Args>
+    Index allocateNode(Args&&... args) {
+        return allocate(std::forward<Args>(args)...);
+    }
+
+    template<typename Key>
+    bool erase(const Key& key) {
+        bool shrunk = false;
+        Index removed = NIL;
+        root = detach(root, key, shrunk, removed);
+        if (removed == NIL) return false;
+        release(removed);
+        --sz;
+        return true;
+    }
+
+    template<typename Key>
+    Slot* find(const Key& key) {
+        Index n = root;
+        while (n != NIL) {
+            if (comp(key, keyAt(n))) n = left(n);
+            else if (comp(keyAt(n), key)) n = right(n);
+            else return &slot(n);
+        }
+        return nullptr;
+    }
+
+    template<typename Key>
+    const Slot* find(const Key& key) const {
+        return const_cast<CompactTree*>(this)->find(key);
+    }
+
+    // Visits elements in key order; fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) { inorder(root, fn); }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const { inorder(root, fn); }
+
+    // Makes room for n elements in total, so the pool stops reallocating
+    void reserve(size_t n) {
+        if (n > MAX_NODES) throw std::length_error("CompactTree: node limit reached");
+        if (n > cap) relocate(n);
+    }
+
+    // Drops spare capacity past the highest slot ever used
+    void shrink_to_fit() {
+        if (used == 0) {
+            ::operator delete(pool);
+            pool = nullptr;
+            cap = 0;
+        } else if (used < cap) {
+            relocate(used);
+        }
+    }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+    size_t capacity() const { return cap; }
+
+    // Destroys every element but keeps the pool for reuse
+    void clear() { reset(); }
+
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(Slot), cap ? heapBlockBytes(cap * sizeof(Node)) : 0);
+    }
+
+    ~CompactTree() {
+        destroyAll();
+        ::operator delete(pool);
+    }
+
+    // Delete copy constructor and copy assignment
+    CompactTree(const CompactTree&) = delete;
+    CompactTree& operator=(const CompactTree&) = delete;
+};
+
+// Ordered set with the same interface as Set's core, stored as a CompactTree
+template <typename T, typename Compare = std::less<T>>
+class CompactSet {
+private:
+    struct KeyOf {
+        static const T& get(const T& value) { return value; }
+    };
+
+    CompactTree<T, KeyOf, Compare> tree;
+
+public:
+    CompactSet() : tree() {}
+
+    explicit CompactSet(const Compare& c) : tree(c) {}
+
+    CompactSet(CompactSet&& other) noexcept = default;
+    CompactSet& operator=(CompactSet&& other) noexcept = default;
+
+    // Returns false if an equal element is already present
+    template<typename U>
+    bool insert(U&& value) {
+        bool inserted = false;
+        if constexpr (is_transparent_v<Compare> || std::is_same_v<std::decay_t<U>, T>) {
+            auto make = [&] { return tree.allocateNode(std::forward<U>(value)); };
+            tree.emplace(value, make, inserted);
+        } else {
+            T converted(std::forward<U>(value));
+            auto make = [&] { return tree.allocateNode(std::move(converted)); };
+            tree.emplace(converted, make, inserted);
+        }
+        return inserted;
+    }
+
+    bool erase(const T& value) { return tree.erase(value); }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool erase(const Key& key) { return tree.erase(key); }
+
+    bool contains(const T& value) const { return tree.find(value) != nullptr; }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const { return tree.find(key) != nullptr; }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const { tree.for_each(fn); }
+
+    void reserve(size_t n) { tree.reserve(n); }
+    void shrink_to_fit() { tree.shrink_to_fit(); }
+    void clear() { tree.clear(); }
+
+    size_t size() const { return tree.size(); }
+    bool empty() const { return tree.empty(); }
+    size_t capacity() const { return tree.capacity(); }
+
+    MemoryUsage memory_usage() const { return tree.memory_usage(); }
+
+    void print() const {
+        std::cout << "CompactSet: { ";
+        tree.for_each([](const T& value) { std::cout << value << " "; });
+        std::cout << "}\n";
+    }
+
+    // Delete copy constructor and copy assignment
+    CompactSet(const CompactSet&) = delete;
+    CompactSet& operator=(const CompactSet&) = delete;
+};
+
+// Ordered map with the same interface as Map's core, stored as a CompactTree
+template <typename K, typename V, typename Compare = std::less<K>>
+class CompactMap {
+private:
+    struct Entry {
+        K key;
+        V value;
+
+        template<typename KType, typename VType>
+        Entry(KType&& k, VType&& v) : key(std::forward<KType>(k)), value(std::forward<VType>(v)) {}
+    };
+
+    struct KeyOf {
+        static const K& get(const Entry& entry) { return entry.key; }
+    };
+
+    CompactTree<Entry, KeyOf, Compare> tree;
+
+public:
+    CompactMap() : tree() {}
+
+    explicit CompactMap(const Compare& c) : tree(c) {}
+
+    CompactMap(CompactMap&& other) noexcept = default;
+    CompactMap& operator=(CompactMap&& other) noexcept = default;
+
+    // Maps key to value, replacing the value of an existing key
+    template<typename KType, typename VType>
+    void insert(KType&& key, VType&& value) {
+        bool inserted = false;
+        if constexpr (is_transparent_v<Compare> || std::is_same_v<std::decay_t<KType>, K>) {
+            auto make = [&] { return tree.allocateNode(std::forward<KType>(key), std::forward<VType>(value)); };
+            Entry& entry = tree.emplace(key, make, inserted);
+            if (!inserted) entry.value = std::forward<VType>(value);
+        } else {
+            K converted(std::forward<KType>(key));
+            auto make = [&] { return tree.allocateNode(std::move(converted), std::forward<VType>(value)); };
+            Entry& entry = tree.emplace(converted, make, inserted);
+            if (!inserted) entry.value = std::forward<VType>(value);
+        }
+    }
+
+    bool erase(const K& key) { return tree.erase(key); }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool erase(const Key& key) { return tree.erase(key); }
+
+    V* find(const K& key) {
+        Entry* entry = tree.find(key);
+        return entry ? &(entry->value) : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        const Entry* entry = tree.find(key);
+        return entry ? &(entry->value) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    V* find(const Key& key) {
+        Entry* entry = tree.find(key);
+        return entry ? &(entry->value) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const V* find(const Key& key) const {
+        const Entry* entry = tree.find(key);
+        return entry ? &(entry->value) : nullptr;
+    }
+
+    bool contains(const K& key) const { return tree.find(key) != nullptr; }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const { return tree.find(key) != nullptr; }
+
+    V& operator[](const K& key) {
+        bool inserted = false;
+        auto make = [&] { return tree.allocateNode(key, V{}); };
+        return tree.emplace(key, make, inserted).value;
+    }
+
+    // Visits entries in key order as fn(key, value)
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        tree.for_each([&](Entry& entry) { fn(static_cast<const K&>(entry.key), entry.value); });
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        tree.for_each([&](const Entry& entry) { fn(entry.key, entry.value); });
+    }
+
+    void reserve(size_t n) { tree.reserve(n); }
+    void shrink_to_fit() { tree.shrink_to_fit(); }
+    void clear() { tree.clear(); }
+
+    size_t size() const { return tree.size(); }
+    bool empty() const { return tree.empty(); }
+    size_t capacity() const { return tree.capacity(); }
+
+    MemoryUsage memory_usage() const { return tree.memory_usage(); }
+
+    void print() const {
+        std::cout << "CompactMap: ";
+        tree.for_each([](const Entry& entry) { std::cout << "{" << entry.key << ": " << entry.value << "} "; });
+        std::cout << "\n";
+    }
+
+    // Delete copy constructor and copy assignment
+    CompactMap(const CompactMap&) = delete;
+    CompactMap& operator=(const CompactMap&) = delete;
+};
\ No newline at end of file
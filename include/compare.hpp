@@ -0,0 +1,15 @@
+// File: include/compare.hpp
+#pragma once
+
+#include <type_traits>
+
+// True when Compare declares `is_transparent` (e.g. std::less<>), meaning it can
+// compare the stored key type against other key-like types directly.
+template <typename Compare, typename = void>
+struct is_transparent : std::false_type {};
+
+template <typename Compare>
+struct is_transparent<Compare, std::void_t<typename Compare::is_transparent>> : std::true_type {};
+
+template <typename Compare>
+inline constexpr bool is_transparent_v = is_transparent<Compare>::value;
\ No newline at end of file
@@ -0,0 +1,436 @@
+// File: include/concurrent_ordered_map.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "epoch.hpp"
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
+// Ordered map safe for any number of concurrent readers and writers: a lazy
+// skip list (Herlihy, Lev, Luchangco and Shavit). Lookups and scans take no
+// locks and write nothing shared beyond their epoch guard. insert and erase
+// lock only the few predecessor nodes they relink, after checking that
+// nothing changed between the lock-free search and the locking, so writers
+// on different parts of the key space never contend.
+//
+// A node is logically removed the moment it is marked and physically
+// unlinked right after; a reader that was already standing on it simply
+// walks on, because an unlinked node's links are never changed again. The
+// node's memory goes back through the epoch domain once no reader can still
+// reach it.
+//
+// Entries are immutable once published. insert() on a present key swaps in a
+// new node holding the new value, so a reader always sees a whole value,
+// never a torn one, and find() returns a copy for the same reason.
+//
+// Scans (for_each, for_each_in, lower_bound) walk the bottom level in key
+// order and are weakly consistent: every key present for the whole scan is
+// visited exactly once, keys inserted or erased meanwhile may or may not be.
+template <typename K, typename V, typename Compare = std::less<K>>
+class ConcurrentOrderedMap {
+private:
+    static constexpr int MAX_LEVEL = 16;   // 4^16 entries before towers stop growing usefully
+
+    class SpinLock {
+    private:
+        std::atomic<bool> held{false};
+
+    public:
+        void lock() {
+            while (held.exchange(true, std::memory_order_acquire)) {
+                while (held.load(std::memory_order_relaxed)) std::this_thread::yield();
+            }
+        }
+
+        void unlock() { held.store(false, std::memory_order_release); }
+    };
+
+    // Shared by the head sentinel and the nodes; the head has no key
+    struct Link {
+        std::atomic<Link*>* next;
+        int height;
+        SpinLock lock;
+        std::atomic<bool> marked;        // logically removed
+        std::atomic<bool> replaced;      // removed by an insert that put a newer node in its place
+        std::atomic<bool> fullyLinked;   // reachable at every level it has
+
+        Link(std::atomic<Link*>* n, int h)
+            : next(n), height(h), lock(), marked(false), replaced(false), fullyLinked(false) {}
+    };
+
+    struct Node : Link {
+        K key;
+        V value;
+
+        template<typename KType, typename VType>
+        Node(std::atomic<Link*>* n, int h, KType&& k, VType&& v)
+            : Link(n, h), key(std::forward<KType>(k)), value(std::forward<VType>(v)) {}
+    };
+
+    // A node and its tower of next pointers share one block
+    static constexpr size_t TOWER_OFFSET =
+        (sizeof(Node) + alignof(std::atomic<Link*>) - 1) / alignof(std::atomic<Link*>) * alignof(std::atomic<Link*>);
+
+    static size_t nodeBytes(int height) {
+        return TOWER_OFFSET + static_cast<size_t>(height) * sizeof(std::atomic<Link*>);
+    }
+
+    Link head;
+    std::atomic<Link*> headTower[MAX_LEVEL];
+    std::atomic<size_t> count;
+    Compare comp;
+
+    template<typename KType, typename VType>
+    static Node* createNode(int height, KType&& key, VType&& value) {
+        static_assert(alignof(Node) <= alignof(std::max_align_t), "over-aligned keys or values are not supported");
+        char* block = static_cast<char*>(nodeAllocate(nodeBytes(height)));
+        auto* tower = reinterpret_cast<std::atomic<Link*>*>(block + TOWER_OFFSET);
+        for (int i = 0; i < height; ++i) new (tower + i) std::atomic<Link*>(nullptr);
+        try {
+            return new (block) Node(tower, height, std::forward<KType>(key), std::forward<VType>(value));
+        } catch (...) {
+            nodeDeallocate(block, nodeBytes(height));
+            throw;
+        }
+    }
+
+    static void destroyNode(void* p) {
+        Node* node = static_cast<Node*>(p);
+        int height = node->height;
+        node->~Node();
+        nodeDeallocate(p, nodeBytes(height));
+    }
+
+    static const K& keyOf(Link* link) { return static_cast<Node*>(link)->key; }
+
+    // Towers of height h occur with probability 4^-(h-1)
+    static int randomLevel() {
+        thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) * 0x9E3779B97F4A7C15ULL | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int level = 1;
+        for (uint64_t bits = state; level < MAX_LEVEL && (bits & 3) == 0; bits >>= 2) ++level;
+        return level;
+    }
+
+    // Visible to lookups: published, and either live or superseded by a
+    // replacement (whose old value is still a correct answer for a reader
+    // that reached it before the swap)
+    static bool visible(Link* link) {
+        return link->fullyLinked.load(std::memory_order_acquire) &&
+               (!link->marked.load(std::memory_order_acquire) || link->replaced.load(std::memory_order_acquire));
+    }
+
+    // Fills preds/succs with the neighbours of key at every level and returns
+    // the highest level at which a node with key was found, or -1
+    template<typename Key>
+    int search(const Key& key, Link** preds, Link** succs) const {
+        int found = -1;
+        Link* pred = const_cast<Link*>(&head);
+        for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+            Link* curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr && comp(keyOf(curr), key)) {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+            if (found == -1 && curr && !comp(key, keyOf(curr))) found = level;
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return found;
+    }
+
+    // First node whose key is not less than key, found without recording
+    // predecessors
+    template<typename Key>
+    Link* seek(const Key& key) const {
+        Link* pred = const_cast<Link*>(&head);
+        Link* curr = nullptr;
+        for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+            curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr && comp(keyOf(curr), key)) {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+        }
+        return curr;
+    }
+
+    template<typename Key>
+    Node* findVisible(const Key& key) const {
+        Link* node = seek(key);
+        return node && !comp(key, keyOf(node)) && visible(node) ? static_cast<Node*>(node) : nullptr;
+    }
+
+    // Releases the distinct predecessors locked for levels [0, levels)
+    static void unlockPreds(Link** preds, int levels) {
+        Link* prev = nullptr;
+        for (int level = 0; level < levels; ++level) {
+            if (preds[level] != prev) {
+                preds[level]->lock.unlock();
+                prev = preds[level];
+            }
+        }
+    }
+
+    // Locks predecessors bottom-up (highest key first, the order every writer
+    // uses) and checks each still links to expected[level], which must not be
+    // marked unless it is the caller's own victim. Returns the number of
+    // levels locked, all of them if valid is set.
+    static int lockPreds(Link** preds, Link* const* expected, int levels, const Link* victim, bool& valid) {
+        Link* prev = nullptr;
+        valid = true;
+        int level = 0;
+        for (; valid && level < levels; ++level) {
+            Link* pred = preds[level];
+            if (pred != prev) {
+                pred->lock.lock();
+                prev = pred;
+            }
+            Link* succ = expected[level];
+            valid = !pred->marked.load(std::memory_order_relaxed) &&
+                    (!succ || succ == victim || !succ->marked.load(std::memory_order_relaxed)) &&
+                    pred->next[level].load(std::memory_order_relaxed) == succ;
+        }
+        return level;
+    }
+
+    template<typename Fn>
+    static void visitFrom(Link* node, Fn& fn) {
+        for (; node; node = node->next[0].load(std::memory_order_acquire)) {
+            if (!visible(node)) continue;
+            Node* n = static_cast<Node*>(node);
+            if (!fn(n->key, n->value)) return;
+        }
+    }
+
+public:
+    ConcurrentOrderedMap() : ConcurrentOrderedMap(Compare()) {}
+
+    explicit ConcurrentOrderedMap(const Compare& c) : head(headTower, MAX_LEVEL), count(0), comp(c) {
+        for (int i = 0; i < MAX_LEVEL; ++i) headTower[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Adds key or replaces its value. Returns true if the key was new.
+    template<typename KType, typename VType>
+    bool insert(KType&& key, VType&& value) {
+        EpochDomain::Guard guard;
+        int height = randomLevel();
+        Node* fresh = createNode(height, std::forward<KType>(key), std::forward<VType>(value));
+        Link* preds[MAX_LEVEL];
+        Link* succs[MAX_LEVEL];
+        Link* expected[MAX_LEVEL];
+        while (true) {
+            int found = search(fresh->key, preds, succs);
+            Link* victim = nullptr;
+            if (found != -1) {
+                victim = succs[found];
+                if (victim->marked.load(std::memory_order_acquire)) continue;   // being removed; look again
+                while (!victim->fullyLinked.load(std::memory_order_acquire)) std::this_thread::yield();
+                victim->lock.lock();
+                if (victim->marked.load(std::memory_order_relaxed)) {
+                    victim->lock.unlock();
+                    continue;
+                }
+            }
+
+            // A replacement takes the victim's place at the victim's levels
+            // and is inserted normally at any levels above them
+            int victimHeight = victim ? victim->height : 0;
+            int levels = height > victimHeight ? height : victimHeight;
+            for (int level = 0; level < levels; ++level) expected[level] = level < victimHeight ? victim : succs[level];
+            bool valid;
+            int locked = lockPreds(preds, expected, levels, nullptr, valid);
+            if (!valid) {
+                unlockPreds(preds, locked);
+                if (victim) victim->lock.unlock();
+                continue;
+            }
+
+            for (int level = 0; level < height; ++level) {
+                Link* after = level < victimHeight ? victim->next[level].load(std::memory_order_relaxed) : succs[level];
+                fresh->next[level].store(after, std::memory_order_relaxed);
+            }
+            if (victim) {
+                // Published top-down and fully linked from the start: once the
+                // bottom level swings, no new search can reach the victim
+                fresh->fullyLinked.store(true, std::memory_order_release);
+                for (int level = levels - 1; level >= 0; --level) {
+                    Link* target = level < height ? fresh : victim->next[level].load(std::memory_order_relaxed);
+                    preds[level]->next[level].store(target, std::memory_order_release);
+                }
+                victim->replaced.store(true, std::memory_order_release);
+                victim->marked.store(true, std::memory_order_release);
+            } else {
+                for (int level = 0; level < height; ++level) {
+                    preds[level]->next[level].store(fresh, std::memory_order_release);
+                }
+                fresh->fullyLinked.store(true, std::memory_order_release);
+            }
+            unlockPreds(preds, levels);
+            if (victim) {
+                victim->lock.unlock();
+                EpochDomain::global().retire(victim, &ConcurrentOrderedMap::destroyNode);
+                return false;
+            }
+            count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Returns false if key was not present
+    bool erase(const K& key) {
+        EpochDomain::Guard guard;
+        Link* preds[MAX_LEVEL];
+        Link* succs[MAX_LEVEL];
+        Link* expected[MAX_LEVEL];
+        Link* victim = nullptr;
+        while (true) {
+            int found = search(key, preds, succs);
+            if (!victim) {
+                if (found == -1) return false;
+                Link* candidate = succs[found];
+                if (!candidate->fullyLinked.load(std::memory_order_acquire)) return false;   // insert not yet done
+                candidate->lock.lock();
+                if (candidate->marked.load(std::memory_order_relaxed)) {
+                    bool replaced = candidate->replaced.load(std::memory_order_relaxed);
+                    candidate->lock.unlock();
+                    if (replaced) continue;   // the key lives on in a newer node
+                    return false;
+                }
+                candidate->marked.store(true, std::memory_order_release);
+                victim = candidate;
+            }
+
+            int levels = victim->height;
+            for (int level = 0; level < levels; ++level) expected[level] = victim;
+            bool valid;
+            int locked = lockPreds(preds, expected, levels, victim, valid);
+            if (!valid) {
+                // A replacement insert can still be linking this node higher up
+                unlockPreds(preds, locked);
+                continue;
+            }
+            for (int level = levels - 1; level >= 0; --level) {
+                preds[level]->next[level].store(victim->next[level].load(std::memory_order_relaxed),
+                                                std::memory_order_release);
+            }
+            unlockPreds(preds, levels);
+            victim->lock.unlock();
+            EpochDomain::global().retire(victim, &ConcurrentOrderedMap::destroyNode);
+            count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Copies the value out, since another thread may erase the entry
+    // the moment the lookup returns
+    std::optional<V> find(const K& key) const {
+        EpochDomain::Guard guard;
+        Node* node = findVisible(key);
+        return node ? std::optional<V>(node->value) : std::nullopt;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    std::optional<V> find(const Key& key) const {
+        EpochDomain::Guard guard;
+        Node* node = findVisible(key);
+        return node ? std::optional<V>(node->value) : std::nullopt;
+    }
+
+    bool contains(const K& key) const {
+        EpochDomain::Guard guard;
+        return findVisible(key) != nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const {
+        EpochDomain::Guard guard;
+        return findVisible(key) != nullptr;
+    }
+
+    // First entry whose key is not less than key
+    std::optional<std::pair<K, V>> lower_bound(const K& key) const {
+        EpochDomain::Guard guard;
+        std::optional<std::pair<K, V>> result;
+        auto take = [&](const K& k, const V& v) {
+            result.emplace(k, v);
+            return false;
+        };
+        visitFrom(seek(key), take);
+        return result;
+    }
+
+    // Visits entries in key order as fn(key, value). The references are valid
+    // only during the call. fn must not modify this map.
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        EpochDomain::Guard guard;
+        auto visitAll = [&](const K& k, const V& v) {
+            fn(k, v);
+            return true;
+        };
+        visitFrom(head.next[0].load(std::memory_order_acquire), visitAll);
+    }
+
+    // Visits the entries with keys in [from, to) in order
+    template<typename Fn>
+    void for_each_in(const K& from, const K& to, Fn&& fn) const {
+        EpochDomain::Guard guard;
+        auto visitRange = [&](const K& k, const V& v) {
+            if (!comp(k, to)) return false;
+            fn(k, v);
+            return true;
+        };
+        visitFrom(seek(from), visitRange);
+    }
+
+    // Exact when no writer is active
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    // Payload is each entry's key and value; overhead is the towers, locks
+    // and flags. Walks every node, and is only meaningful while no other
+    // thread uses the map. Erased nodes still waiting for the epoch domain
+    // to free them are not counted.
+    MemoryUsage memory_usage() const {
+        size_t nodes = 0, heap = 0;
+        for (Link* node = head.next[0].load(std::memory_order_acquire); node;
+             node = node->next[0].load(std::memory_order_acquire)) {
+            ++nodes;
+            heap += nodeBlockBytes(nodeBytes(node->height));
+        }
+        return makeMemoryUsage(sizeof(*this), nodes, sizeof(K) + sizeof(V), heap);
+    }
+
+    void print() const {
+        std::cout << "ConcurrentOrderedMap: ";
+        for_each([](const K& k, const V& v) { std::cout << "(" << k << ": " << v << ") "; });
+        std::cout << "\n";
+    }
+
+    // No other thread may be using the map. Nodes already retired are freed
+    // by the epoch domain.
+    ~ConcurrentOrderedMap() {
+        Link* node = head.next[0].load(std::memory_order_relaxed);
+        while (node) {
+            Link* next = node->next[0].load(std::memory_order_relaxed);
+            destroyNode(node);
+            node = next;
+        }
+    }
+
+    // Delete copy constructor and copy assignment
+    ConcurrentOrderedMap(const ConcurrentOrderedMap&) = delete;
+    ConcurrentOrderedMap& operator=(const ConcurrentOrderedMap&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,292 @@
+// File: include/concurrent_stack.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+#include "tagged_stack.hpp"
+
+// Lock-free LIFO stack for any number of pushing and popping threads, such
+// as a shared free-list of reusable buffers. push and pop are a single CAS
+// on a tagged top pointer against ABA (see TaggedStack for the tag width on
+// each target and what it leaves open). Nodes are never freed while the
+// stack lives: a popped node goes on an internal lock-free spare list and is
+// reused by the next push, so a thread still reading it after losing a race
+// reads valid memory. The node count therefore stays at the high-water mark
+// until the stack is destroyed.
+//
+// Batches move as pre-linked chains with one CAS each: build a Chain
+// locally with make_chain() and push_chain() it, or take many values at once
+// with pop_batch() / pop_all(). A chain keeps the nodes it pops for its own
+// pushes and returns the rest in one step, so a batch round trip costs a
+// handful of CASes rather than one per value. A Chain must not outlive its
+// stack.
+template <typename T>
+class ConcurrentStack {
+private:
+    struct Node : PooledNode {
+        std::atomic<Node*> next;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        Node() : next(nullptr) {}
+
+        T& value() { return *std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    TaggedStack<Node> items;
+    TaggedStack<Node> spare;      // nodes with no value, reused before allocating
+    std::atomic<size_t> nodeCount;
+
+    Node* takeNode() {
+        if (Node* n = spare.pop()) return n;
+        nodeCount.fetch_add(1, std::memory_order_relaxed);
+        return new Node();
+    }
+
+    // Builds a value in a fresh node; the node goes back on failure
+    template<typename... Args>
+    Node* makeNode(Args&&... args) {
+        Node* n = takeNode();
+        try {
+            ::new (static_cast<void*>(n->storage)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            spare.push(n);
+            throw;
+        }
+        return n;
+    }
+
+    // Moves the value out of a node the caller owns and recycles the node
+    std::optional<T> takeValue(Node* n) {
+        std::optional<T> out(std::move(n->value()));
+        n->value().~T();
+        spare.push(n);
+        return out;
+    }
+
+    static void deleteChain(Node* n, bool withValues) {
+        while (n) {
+            Node* next = n->next.load(std::memory_order_relaxed);
+            if (withValues) n->value().~T();
+            delete n;
+            n = next;
+        }
+    }
+
+public:
+    // A run of values linked locally, top first, that moves into or out of
+    // the stack as a unit. Not thread-safe itself: one thread builds or
+    // drains it.
+    class Chain {
+    private:
+        ConcurrentStack* owner;
+        Node* first;
+        Node* last;
+        size_t count;
+        Node* spareFirst;     // emptied nodes kept for this chain's pushes
+        Node* spareLast;
+
+        friend class ConcurrentStack;
+        Chain(ConcurrentStack* o, Node* f, Node* l, size_t n)
+            : owner(o), first(f), last(l), count(n), spareFirst(nullptr), spareLast(nullptr) {}
+
+        void keepNode(Node* n) {
+            n->next.store(spareFirst, std::memory_order_relaxed);
+            spareFirst = n;
+            if (!spareLast) spareLast = n;
+        }
+
+        Node* takeNode() {
+            Node* n = spareFirst;
+            if (!n) return owner->takeNode();
+            spareFirst = n->next.load(std::memory_order_relaxed);
+            if (!spareFirst) spareLast = nullptr;
+            return n;
+        }
+
+        void releaseSpare() {
+            if (spareFirst) owner->spare.push_chain(spareFirst, spareLast);
+            spareFirst = spareLast = nullptr;
+        }
+
+    public:
+        Chain(Chain&& other) noexcept
+            : owner(other.owner), first(other.first), last(other.last), count(other.count),
+              spareFirst(other.spareFirst), spareLast(other.spareLast) {
+            other.first = other.last = other.spareFirst = other.spareLast = nullptr;
+            other.count = 0;
+        }
+
+        Chain& operator=(Chain&& other) noexcept {
+            if (this != &other) {
+                clear();
+                releaseSpare();
+                owner = other.owner;
+                first = other.first;
+                last = other.last;
+                count = other.count;
+                spareFirst = other.spareFirst;
+                spareLast = other.spareLast;
+                other.first = other.last = other.spareFirst = other.spareLast = nullptr;
+                other.count = 0;
+            }
+            return *this;
+        }
+
+        // Adds value on top of the chain
+        template<typename U>
+        void push(U&& value) {
+            Node* n = takeNode();
+            try {
+                ::new (static_cast<void*>(n->storage)) T(std::forward<U>(value));
+            } catch (...) {
+                keepNode(n);
+                throw;
+            }
+            n->next.store(first, std::memory_order_relaxed);
+            first = n;
+            if (!last) last = n;
+            ++count;
+        }
+
+        std::optional<T> pop() {
+            if (!first) return std::nullopt;
+            Node* n = first;
+            first = n->next.load(std::memory_order_relaxed);
+            if (!first) last = nullptr;
+            --count;
+            std::optional<T> out(std::move(n->value()));
+            n->value().~T();
+            keepNode(n);
+            return out;
+        }
+
+        T& top() { return first->value(); }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        // Visits values top to bottom
+        template<typename Fn>
+        void for_each(Fn&& fn) {
+            for (Node* n = first; n; n = n->next.load(std::memory_order_relaxed)) fn(n->value());
+        }
+
+        // Destroys the values; their nodes stay with the chain for reuse
+        void clear() {
+            if (!first) return;
+            for (Node* n = first; n; n = n->next.load(std::memory_order_relaxed)) n->value().~T();
+            last->next.store(spareFirst, std::memory_order_relaxed);
+            if (!spareLast) spareLast = last;
+            spareFirst = first;
+            first = last = nullptr;
+            count = 0;
+        }
+
+        // Hands every node back to the stack's spare list in one step
+        ~Chain() {
+            clear();
+            releaseSpare();
+        }
+
+        // Delete copy constructor and copy assignment
+        Chain(const Chain&) = delete;
+        Chain& operator=(const Chain&) = delete;
+    };
+
+    ConcurrentStack() : items(), spare(), nodeCount(0) {}
+
+    template<typename U>
+    void push(U&& value) {
+        items.push(makeNode(std::forward<U>(value)));
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        items.push(makeNode(std::forward<Args>(args)...));
+    }
+
+    // Returns the top value, or nothing if the stack was empty
+    std::optional<T> pop() {
+        Node* n = items.pop();
+        if (!n) return std::nullopt;
+        return takeValue(n);
+    }
+
+    // An empty chain to fill and push_chain(), holding up to reserve spare
+    // nodes taken in one step so its first pushes need no CAS
+    Chain make_chain(size_t reserve = 0) {
+        Chain chain(this, nullptr, nullptr, 0);
+        size_t n = 0;
+        if (reserve) chain.spareFirst = spare.pop_chain(reserve, chain.spareLast, n);
+        return chain;
+    }
+
+    // Pushes the whole chain with one CAS; its top becomes the stack's top
+    void push_chain(Chain&& chain) {
+        if (!chain.first) return;
+        items.push_chain(chain.first, chain.last);
+        chain.first = chain.last = nullptr;
+        chain.count = 0;
+    }
+
+    // Takes up to max values from the top with one CAS, top first
+    Chain pop_batch(size_t max) {
+        Node* last = nullptr;
+        size_t n = 0;
+        Node* first = max ? items.pop_chain(max, last, n) : nullptr;
+        return Chain(this, first, last, n);
+    }
+
+    // Takes every value with one exchange
+    Chain pop_all() {
+        Node* first = items.pop_all();
+        Node* last = first;
+        size_t n = first ? 1 : 0;
+        while (last && last->next.load(std::memory_order_relaxed)) {
+            last = last->next.load(std::memory_order_relaxed);
+            ++n;
+        }
+        return Chain(this, first, last, n);
+    }
+
+    // A snapshot: another thread may push or pop right after
+    bool empty() const { return items.empty(); }
+
+    // Walks the stack, so only meaningful while no other thread uses it
+    size_t size() const {
+        size_t n = 0;
+        for (Node* node = items.peek(); node; node = node->next.load(std::memory_order_relaxed)) ++n;
+        return n;
+    }
+
+    // Every node ever allocated is still held, live or spare; only
+    // meaningful while no other thread uses the stack
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), size(), sizeof(T),
+                               nodeCount.load(std::memory_order_relaxed) * nodeBlockBytes(sizeof(Node)));
+    }
+
+    // Only while no other thread uses the stack
+    void print() const {
+        std::cout << "ConcurrentStack (top to bottom): ";
+        for (Node* n = items.peek(); n; n = n->next.load(std::memory_order_relaxed)) std::cout << n->value() << " ";
+        std::cout << "\n";
+    }
+
+    // No other thread may be using the stack, and no Chain may be outstanding
+    ~ConcurrentStack() {
+        deleteChain(items.pop_all(), true);
+        deleteChain(spare.pop_all(), false);
+    }
+
+    // Delete copy constructor and copy assignment
+    ConcurrentStack(const ConcurrentStack&) = delete;
+    ConcurrentStack& operator=(const ConcurrentStack&) = delete;
+};
\ No newline at end of file
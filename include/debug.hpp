@@ -1,4 +1,226 @@
+// File: include/debug.hpp
 #pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
+// Ad-hoc text tracing for a debugging session. Every use formats into
+// std::cerr and flushes, so it never belongs on a hot path; use TRACE_EVENT.
 #define TRACE(msg) std::cerr << "[TRACE] " << __FILE__ << ":" << __LINE__ << " - " << msg << std::endl;
+
+// Binary event tracing. TRACE_EVENT(Name, a, b) appends a fixed 32-byte
+// record (timestamp, thread, TraceEvent::Name and two 64-bit arguments) to
+// the calling thread's ring buffer: no lock, no formatting, no system call,
+// a few nanoseconds per event. Rings keep the most recent RING_RECORDS
+// events per thread. Tracer::save() writes them all out and the trace_dump
+// tool decodes and formats them offline.
+//
+// Trace points compile to nothing, arguments unevaluated, unless STL_TRACE is
+// defined. When compiled in, Tracer::set_enabled(false) turns them into a
+// single relaxed load.
+#ifdef STL_TRACE
+#define TRACE_EVENT(event, a, b) \
+    Tracer::record(TraceEvent::event, static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(b))
+#else
+#define TRACE_EVENT(event, a, b) ((void)0)
+#endif
+
+enum class TraceEvent : std::uint16_t {
+    None = 0,
+    VectorReallocate,   // old capacity, new capacity
+    TreeRotateLeft,     // pivot node, tree size
+    TreeRotateRight,    // pivot node, tree size
+    QueuePush,          // queue, size after the push
+    QueuePop,           // queue, size after the pop
+    User = 1024         // applications number their own events from here
+};
+
+struct TraceEventInfo {
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+};
+
+inline TraceEventInfo traceEventInfo(std::uint16_t id) {
+    switch (static_cast<TraceEvent>(id)) {
+        case TraceEvent::VectorReallocate: return {"vector.reallocate", "old_cap", "new_cap"};
+        case TraceEvent::TreeRotateLeft: return {"tree.rotate_left", "node", "size"};
+        case TraceEvent::TreeRotateRight: return {"tree.rotate_right", "node", "size"};
+        case TraceEvent::QueuePush: return {"queue.push", "queue", "size"};
+        case TraceEvent::QueuePop: return {"queue.pop", "queue", "size"};
+        default: return {nullptr, "a", "b"};
+    }
+}
+
+struct TraceRecord {
+    std::uint64_t ticks;
+    std::uint64_t args[2];
+    std::uint32_t thread;
+    std::uint16_t event;
+    std::uint16_t reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 32, "trace records are written to disk as-is");
+
+// What precedes the records in a saved trace
+struct TraceFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    double nsPerTick;        // converts record ticks to nanoseconds
+    std::uint64_t count;
+};
+
+class Tracer {
+public:
+    static constexpr size_t RING_RECORDS = 4096;   // power of two
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    static std::int64_t steadyNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Raw timestamp: the TSC where available, else steady_clock nanoseconds
+    static std::uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(steadyNs());
+#endif
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'S', 'T', 'L', 'T', 'R', 'A', 'C', 'E'};
+
+    // Written only by its owning thread. Rings are never freed: a thread's
+    // events outlive it, and an exited thread's ring is handed to the next
+    // new thread.
+    struct Ring {
+        TraceRecord records[RING_RECORDS];
+        std::atomic<std::uint64_t> written{0};
+        std::atomic<bool> owned{true};
+        std::uint32_t thread = 0;
+        Ring* nextRing = nullptr;
+    };
+
+    struct RingHandle {
+        Ring* ring;
+
+        ~RingHandle() {
+            ringGone = true;
+            ring->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    static inline std::atomic<Ring*> rings{nullptr};
+    static inline std::atomic<std::uint32_t> threadCount{0};
+    static inline std::atomic<bool> enabledFlag{true};
+    static inline thread_local bool ringGone = false;
+
+    // Start of the trace on both clocks, for converting ticks at save time
+    static inline const std::uint64_t baseTicks = ticks();
+    static inline const std::int64_t baseNs = steadyNs();
+
+    static Ring* acquireRing() {
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->nextRing) {
+            bool expected = false;
+            if (r->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                r->thread = threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+                return r;
+            }
+        }
+        Ring* r = new Ring();
+        r->thread = threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        r->nextRing = rings.load(std::memory_order_relaxed);
+        while (!rings.compare_exchange_weak(r->nextRing, r, std::memory_order_release, std::memory_order_relaxed)) {}
+        return r;
+    }
+
+    static Ring* ring() {
+        if (ringGone) return nullptr;
+        thread_local RingHandle handle{acquireRing()};
+        return handle.ring;
+    }
+
+public:
+    static void set_enabled(bool on) { enabledFlag.store(on, std::memory_order_relaxed); }
+    static bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    static void record(TraceEvent event, std::uint64_t a, std::uint64_t b) {
+        if (!enabledFlag.load(std::memory_order_relaxed)) return;
+        Ring* r = ring();
+        if (!r) return;   // thread is exiting
+        std::uint64_t n = r->written.load(std::memory_order_relaxed);
+        TraceRecord& rec = r->records[n & (RING_RECORDS - 1)];
+        rec.ticks = ticks();
+        rec.args[0] = a;
+        rec.args[1] = b;
+        rec.thread = r->thread;
+        rec.event = static_cast<std::uint16_t>(event);
+        rec.reserved = 0;
+        r->written.store(n + 1, std::memory_order_release);
+    }
+
+    // Writes every buffered record, ring by ring. Call it once the traced
+    // threads are quiet: a record being written concurrently may be torn.
+    static bool save(std::ostream& out) {
+        std::uint64_t nowTicks = ticks();
+        std::int64_t nowNs = steadyNs();
+        TraceFileHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = FORMAT_VERSION;
+        header.recordSize = sizeof(TraceRecord);
+        header.nsPerTick = nowTicks > baseTicks
+                               ? static_cast<double>(nowNs - baseNs) / static_cast<double>(nowTicks - baseTicks)
+                               : 1.0;
+        header.count = 0;
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->nextRing) {
+            std::uint64_t n = r->written.load(std::memory_order_acquire);
+            header.count += n < RING_RECORDS ? n : RING_RECORDS;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::uint64_t budget = header.count;   // rings may have grown since they were counted
+        for (Ring* r = rings.load(std::memory_order_acquire); r && budget; r = r->nextRing) {
+            std::uint64_t n = r->written.load(std::memory_order_acquire);
+            std::uint64_t first = n < RING_RECORDS ? 0 : n - RING_RECORDS;
+            if (n - first > budget) first = n - budget;
+            budget -= n - first;
+            for (std::uint64_t i = first; i < n; ++i) {
+                out.write(reinterpret_cast<const char*>(&r->records[i & (RING_RECORDS - 1)]), sizeof(TraceRecord));
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    // Reads a trace written by save(), passing each record to fn. Returns
+    // false on a malformed or truncated file.
+    template<typename Fn>
+    static bool load(std::istream& in, TraceFileHeader& header, Fn&& fn) {
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+            header.recordSize != sizeof(TraceRecord))
+            return false;
+        for (std::uint64_t i = 0; i < header.count; ++i) {
+            TraceRecord rec;
+            if (!in.read(reinterpret_cast<char*>(&rec), sizeof(rec))) return false;
+            fn(rec);
+        }
+        return true;
+    }
+
+    // Drops every buffered record; only safe while no thread is tracing
+    static void clear() {
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->nextRing) {
+            r->written.store(0, std::memory_order_relaxed);
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,236 @@
+// File: include/deque.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <utility>
+
+#include "memory_usage.hpp"
+
+// Double-ended queue stored as a map of fixed-size blocks. Elements never move
+// once constructed: growing at either end only allocates a new block (or
+// reuses a spare one) and, rarely, re-centres the array of block pointers. So
+// push/pop at both ends are O(1), indexing is O(1), and references to existing
+// elements survive push_front/push_back.
+template <typename T>
+class Deque {
+private:
+    // Elements per block: roughly 512 bytes, a power of two, at least 16
+    static constexpr size_t blockSize() {
+        size_t n = 16;
+        while (n * 2 * sizeof(T) <= 512) n *= 2;
+        return n;
+    }
+
+    static constexpr size_t BLOCK = blockSize();
+    static constexpr size_t MAX_SPARE = 4;
+
+    T** blocks;        // map of block pointers, nullptr where no block is held
+    size_t mapCap;
+    size_t head;       // position of front() counted in elements from blocks[0]
+    size_t sz;
+    T* spare[MAX_SPARE];
+    size_t spareCount;
+
+    T& at(size_t pos) { return blocks[pos / BLOCK][pos % BLOCK]; }
+    const T& at(size_t pos) const { return blocks[pos / BLOCK][pos % BLOCK]; }
+
+    T* allocateBlock() {
+        if (spareCount > 0) return spare[--spareCount];
+        return reinterpret_cast<T*>(::operator new(sizeof(T) * BLOCK));
+    }
+
+    // Keeps a few emptied blocks so FIFO-style churn stops hitting the allocator
+    void recycleBlock(size_t index) {
+        T* block = blocks[index];
+        blocks[index] = nullptr;
+        if (spareCount < MAX_SPARE) spare[spareCount++] = block;
+        else ::operator delete(block);
+    }
+
+    // Moves the used block pointers to the middle of a map with room at both
+    // ends, doubling the map only when it is more than half full
+    void recentre() {
+        size_t first = head / BLOCK;
+        size_t used = sz ? (head + sz - 1) / BLOCK - first + 1 : 0;
+        size_t newCap = mapCap;
+        if (newCap == 0 || used * 2 + 2 > newCap) newCap = mapCap ? mapCap * 2 : 8;
+        size_t newFirst = (newCap - used) / 2;
+
+        if (newCap != mapCap) {
+            T** newBlocks = new T*[newCap]();
+            if (used) std::memcpy(newBlocks + newFirst, blocks + first, used * sizeof(T*));
+            delete[] blocks;
+            blocks = newBlocks;
+            mapCap = newCap;
+        } else if (newFirst != first) {
+            std::memmove(blocks + newFirst, blocks + first, used * sizeof(T*));
+            for (size_t i = 0; i < mapCap; ++i) {
+                if (i < newFirst || i >= newFirst + used) blocks[i] = nullptr;
+            }
+        }
+        head = newFirst * BLOCK + head % BLOCK;
+    }
+
+    // Returns the position a new back element goes to, with its block allocated
+    size_t prepareBack() {
+        size_t pos = head + sz;
+        if (pos / BLOCK >= mapCap) {
+            recentre();
+            pos = head + sz;
+        }
+        if (!blocks[pos / BLOCK]) blocks[pos / BLOCK] = allocateBlock();
+        return pos;
+    }
+
+    size_t prepareFront() {
+        if (head == 0) recentre();
+        size_t pos = head - 1;
+        if (!blocks[pos / BLOCK]) blocks[pos / BLOCK] = allocateBlock();
+        return pos;
+    }
+
+    void releaseAll() {
+        clear();
+        for (size_t i = 0; i < spareCount; ++i) ::operator delete(spare[i]);
+        spareCount = 0;
+        delete[] blocks;
+        blocks = nullptr;
+        mapCap = 0;
+        head = 0;
+    }
+
+public:
+    Deque() : blocks(nullptr), mapCap(0), head(0), sz(0), spare(), spareCount(0) {}
+
+    Deque(Deque&& other) noexcept
+        : blocks(other.blocks), mapCap(other.mapCap), head(other.head), sz(other.sz),
+          spare(), spareCount(other.spareCount) {
+        for (size_t i = 0; i < spareCount; ++i) spare[i] = other.spare[i];
+        other.blocks = nullptr;
+        other.mapCap = 0;
+        other.head = 0;
+        other.sz = 0;
+        other.spareCount = 0;
+    }
+
+    Deque& operator=(Deque&& other) noexcept {
+        if (this != &other) {
+            releaseAll();
+            blocks = other.blocks;
+            mapCap = other.mapCap;
+            head = other.head;
+            sz = other.sz;
+            spareCount = other.spareCount;
+            for (size_t i = 0; i < spareCount; ++i) spare[i] = other.spare[i];
+            other.blocks = nullptr;
+            other.mapCap = 0;
+            other.head = 0;
+            other.sz = 0;
+            other.spareCount = 0;
+        }
+        return *this;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        size_t pos = prepareBack();
+        try {
+            new (&at(pos)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            if (pos % BLOCK == 0 || sz == 0) recycleBlock(pos / BLOCK);
+            throw;
+        }
+        ++sz;
+        return at(pos);
+    }
+
+    template<typename... Args>
+    T& emplace_front(Args&&... args) {
+        size_t pos = prepareFront();
+        try {
+            new (&at(pos)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            if (pos % BLOCK == BLOCK - 1 || sz == 0) recycleBlock(pos / BLOCK);
+            throw;
+        }
+        head = pos;
+        ++sz;
+        return at(pos);
+    }
+
+    template<typename U>
+    void push_back(U&& value) {
+        emplace_back(std::forward<U>(value));
+    }
+
+    template<typename U>
+    void push_front(U&& value) {
+        emplace_front(std::forward<U>(value));
+    }
+
+    void pop_back() {
+        if (sz == 0) return;
+        size_t pos = head + sz - 1;
+        at(pos).~T();
+        --sz;
+        if (pos % BLOCK == 0 || sz == 0) recycleBlock(pos / BLOCK);
+    }
+
+    void pop_front() {
+        if (sz == 0) return;
+        size_t pos = head;
+        at(pos).~T();
+        ++head;
+        --sz;
+        if (head % BLOCK == 0 || sz == 0) recycleBlock(pos / BLOCK);
+    }
+
+    T& operator[](size_t index) { return at(head + index); }
+    const T& operator[](size_t index) const { return at(head + index); }
+
+    T& front() { return at(head); }
+    const T& front() const { return at(head); }
+    T& back() { return at(head + sz - 1); }
+    const T& back() const { return at(head + sz - 1); }
+
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+
+    void clear() {
+        while (sz > 0) pop_back();
+    }
+
+    // Deep copy in a single linear pass
+    Deque clone() const {
+        Deque copy;
+        for (size_t i = 0; i < sz; ++i) copy.push_back((*this)[i]);
+        return copy;
+    }
+
+    // Counts every block held, spares included, plus the block map
+    MemoryUsage memory_usage() const {
+        size_t held = spareCount;
+        for (size_t i = 0; i < mapCap; ++i) held += blocks[i] != nullptr;
+        size_t heapBytes = held * heapBlockBytes(sizeof(T) * BLOCK);
+        if (mapCap) heapBytes += heapBlockBytes(mapCap * sizeof(T*));
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), heapBytes);
+    }
+
+    void print() const {
+        std::cout << "Deque: [ ";
+        for (size_t i = 0; i < sz; ++i)
+            std::cout << (*this)[i] << " ";
+        std::cout << "]\n";
+    }
+
+    ~Deque() {
+        releaseAll();
+    }
+
+    // Delete copy constructor and copy assignment
+    Deque(const Deque&) = delete;
+    Deque& operator=(const Deque&) = delete;
+};
\ No newline at end of file
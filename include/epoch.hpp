@@ -0,0 +1,172 @@
+// File: include/epoch.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.hpp"
+
+// Epoch-based reclamation. Readers wrap each access to shared nodes in a
+// Guard, which only publishes the current epoch into a per-thread slot (no
+// locks, no shared writes). Writers unlink a node and then retire() it; the
+// node is freed once the global epoch has advanced twice past its retirement,
+// at which point no guard that could still see it is alive.
+class EpochDomain {
+public:
+    static constexpr size_t kMaxThreads = 128;
+
+private:
+    static constexpr size_t kReclaimThreshold = 64;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> state{0};   // (epoch << 1) | active
+        std::atomic<bool> used{false};
+    };
+
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    // Claims a slot for the calling thread on first use and frees it on thread exit
+    struct ThreadRecord {
+        EpochDomain* domain;
+        Slot* slot;
+        size_t depth;
+
+        explicit ThreadRecord(EpochDomain* d) : domain(d), slot(nullptr), depth(0) {
+            for (size_t i = 0; i < kMaxThreads; ++i) {
+                bool expected = false;
+                if (d->slots[i].used.compare_exchange_strong(expected, true)) {
+                    slot = &d->slots[i];
+                    return;
+                }
+            }
+            throw std::runtime_error("EpochDomain: too many threads");
+        }
+
+        ~ThreadRecord() {
+            slot->state.store(0, std::memory_order_release);
+            slot->used.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<uint64_t> globalEpoch{0};
+    Slot slots[kMaxThreads];
+    std::mutex retireMutex;
+    Vector<Retired> pending;
+
+    static ThreadRecord& record() {
+        thread_local ThreadRecord rec(&global());
+        return rec;
+    }
+
+    // Bumps the global epoch if every active reader has observed the current one
+    void tryAdvance() {
+        // Pairs with the fence in Guard: either the scan sees a reader's slot,
+        // or that reader sees every unlink made before this point
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t e = globalEpoch.load(std::memory_order_acquire);
+        for (size_t i = 0; i < kMaxThreads; ++i) {
+            uint64_t s = slots[i].state.load(std::memory_order_acquire);
+            if ((s & 1) && (s >> 1) != e) return;
+        }
+        globalEpoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+    }
+
+    // Frees everything retired at least two epochs ago. Deleters run outside the
+    // lock so they may themselves retire nodes.
+    void collect() {
+        Vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retireMutex);
+            tryAdvance();
+            uint64_t e = globalEpoch.load(std::memory_order_acquire);
+            size_t kept = 0;
+            for (size_t i = 0; i < pending.size(); ++i) {
+                if (pending[i].epoch + 2 <= e) ready.push_back(pending[i]);
+                else pending[kept++] = pending[i];
+            }
+            while (pending.size() > kept) pending.pop_back();
+        }
+        for (size_t i = 0; i < ready.size(); ++i) {
+            ready[i].deleter(ready[i].ptr);
+        }
+    }
+
+    EpochDomain() = default;
+
+public:
+    // Process-wide domain shared by every lock-free container
+    static EpochDomain& global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Marks the calling thread as reading shared nodes for its lifetime. Nests.
+    class Guard {
+    private:
+        ThreadRecord& rec;
+
+    public:
+        Guard() : rec(record()) {
+            if (rec.depth++ == 0) {
+                uint64_t e = rec.domain->globalEpoch.load(std::memory_order_acquire);
+                rec.slot->state.store((e << 1) | 1, std::memory_order_relaxed);
+                // Orders the slot store before the reader's loads of shared
+                // pointers; pairs with the fence in tryAdvance()
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--rec.depth == 0) {
+                rec.slot->state.store(0, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    // Schedules ptr to be passed to deleter once no reader can still hold it
+    void retire(void* ptr, void (*deleter)(void*)) {
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(retireMutex);
+            pending.push_back(Retired{ptr, deleter, globalEpoch.load(std::memory_order_acquire)});
+            full = pending.size() >= kReclaimThreshold;
+        }
+        if (full) collect();
+    }
+
+    template<typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // Frees whatever is safe to free now. Call from a thread outside any Guard.
+    void reclaim() {
+        for (int i = 0; i < 3; ++i) collect();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        return pending.size();
+    }
+
+    ~EpochDomain() {
+        // Process exit: no readers remain
+        for (size_t i = 0; i < pending.size(); ++i) {
+            pending[i].deleter(pending[i].ptr);
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+};
\ No newline at end of file
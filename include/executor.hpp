@@ -0,0 +1,169 @@
+// File: include/executor.hpp
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "queue.hpp"
+#include "vector.hpp"
+
+// Something that resumes suspended coroutines. Awaitables that park a
+// coroutine (such as AsyncChannel) hand it back through post() when it can
+// make progress, instead of resuming it on whatever thread woke it.
+class Executor {
+public:
+    virtual void post(std::coroutine_handle<> handle) = 0;
+    virtual ~Executor() = default;
+};
+
+// Runs every posted coroutine on the calling thread, in FIFO order, until
+// nothing is runnable. Cheap enough to drive thousands of pipeline stages.
+class Scheduler : public Executor {
+private:
+    RingQueue<std::coroutine_handle<>> ready;
+
+public:
+    Scheduler() : ready() {}
+
+    void post(std::coroutine_handle<> handle) override {
+        ready.push(handle);
+    }
+
+    // Resumes ready coroutines until the run queue is empty
+    void run() {
+        while (!ready.empty()) {
+            std::coroutine_handle<> handle = ready.front();
+            ready.pop();
+            handle.resume();
+        }
+    }
+
+    size_t pending() const { return ready.size(); }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+};
+
+// Fixed pool of worker threads sharing one run queue. A coroutine may resume
+// on any worker, so state shared between coroutines must be synchronised (the
+// channels in async_channel.hpp are).
+class ThreadPoolExecutor : public Executor {
+private:
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    RingQueue<std::coroutine_handle<>> ready;
+    Vector<std::thread> workers;
+    size_t running;
+    bool stopping;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (ready.empty()) return;   // stopping and drained
+            std::coroutine_handle<> handle = ready.front();
+            ready.pop();
+            ++running;
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+            --running;
+            if (running == 0 && ready.empty()) idle.notify_all();
+        }
+    }
+
+public:
+    explicit ThreadPoolExecutor(size_t threads) : ready(), workers(), running(0), stopping(false) {
+        if (threads == 0) threads = 1;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    void post(std::coroutine_handle<> handle) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push(handle);
+        }
+        workAvailable.notify_one();
+    }
+
+    // Blocks until the run queue is empty and no worker is resuming anything.
+    // Coroutines parked on a channel do not count as work.
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return running == 0 && ready.empty(); });
+    }
+
+    size_t thread_count() const { return workers.size(); }
+
+    // Finishes whatever is runnable, then joins the workers
+    ~ThreadPoolExecutor() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+    }
+
+    ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+    ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+};
+
+// Fire-and-forget coroutine. It starts suspended; spawn() hands it to an
+// executor, after which the coroutine frees its own frame when it finishes.
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    friend void spawn(Executor& executor, Task task);
+
+public:
+    Task(Task&& other) noexcept : handle(other.handle) {
+        other.handle = nullptr;
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    // A task that was never spawned has never run; just free its frame
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+};
+
+// Schedules task to start on executor
+inline void spawn(Executor& executor, Task task) {
+    std::coroutine_handle<> handle = task.handle;
+    task.handle = nullptr;
+    executor.post(handle);
+}
\ No newline at end of file
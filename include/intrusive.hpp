@@ -0,0 +1,442 @@
+// File: include/intrusive.hpp
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+#include "compare.hpp"
+
+// Intrusive containers link objects the caller already owns through hook
+// members embedded in those objects, so inserting and erasing never allocate
+// and never copy or move the object. An object with several hooks can sit in
+// several containers at once. The containers never own their elements: an
+// object must be erased (or the container cleared) before it is destroyed.
+
+// Byte offset of the hook member inside T, measured against real storage
+// rather than a null T* so it holds for non-standard-layout types too
+template <typename T, typename Hook>
+inline size_t hookOffset(Hook T::*member) {
+    alignas(T) static unsigned char storage[sizeof(T)];
+    T* probe = reinterpret_cast<T*>(storage);
+    return static_cast<size_t>(reinterpret_cast<unsigned char*>(&(probe->*member)) - storage);
+}
+
+template <typename T, typename Hook>
+inline T* hookOwner(Hook* hook, Hook T::*member) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - hookOffset(member));
+}
+
+// Link fields for IntrusiveList. Copying an object does not copy its links.
+struct ListHook {
+    ListHook* prev;
+    ListHook* next;
+
+    ListHook() : prev(nullptr), next(nullptr) {}
+    ListHook(const ListHook&) : prev(nullptr), next(nullptr) {}
+    ListHook& operator=(const ListHook&) { return *this; }
+
+    bool is_linked() const { return next != nullptr; }
+};
+
+// Circular doubly linked list threaded through T::*Hook. Every operation,
+// including erase of an arbitrary element, is O(1).
+template <typename T, ListHook T::*Hook>
+class IntrusiveList {
+private:
+    ListHook sentinel;   // sentinel.next is the front, sentinel.prev the back
+    size_t sz;
+
+    static ListHook* hookOf(T& value) { return &(value.*Hook); }
+    static T* ownerOf(ListHook* hook) { return hookOwner(hook, Hook); }
+
+    static void linkBefore(ListHook* pos, ListHook* hook) {
+        hook->next = pos;
+        hook->prev = pos->prev;
+        pos->prev->next = hook;
+        pos->prev = hook;
+    }
+
+    static void unlink(ListHook* hook) {
+        hook->prev->next = hook->next;
+        hook->next->prev = hook->prev;
+        hook->prev = hook->next = nullptr;
+    }
+
+    // Takes over other's chain; the sentinel's neighbours must point at our sentinel
+    void adopt(IntrusiveList& other) {
+        if (other.sz == 0) return;
+        sentinel.next = other.sentinel.next;
+        sentinel.prev = other.sentinel.prev;
+        sentinel.next->prev = &sentinel;
+        sentinel.prev->next = &sentinel;
+        sz = other.sz;
+        other.sentinel.next = other.sentinel.prev = &other.sentinel;
+        other.sz = 0;
+    }
+
+public:
+    IntrusiveList() : sentinel(), sz(0) {
+        sentinel.next = sentinel.prev = &sentinel;
+    }
+
+    IntrusiveList(IntrusiveList&& other) noexcept : sentinel(), sz(0) {
+        sentinel.next = sentinel.prev = &sentinel;
+        adopt(other);
+    }
+
+    IntrusiveList& operator=(IntrusiveList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            adopt(other);
+        }
+        return *this;
+    }
+
+    void push_front(T& value) {
+        linkBefore(sentinel.next, hookOf(value));
+        ++sz;
+    }
+
+    void push_back(T& value) {
+        linkBefore(&sentinel, hookOf(value));
+        ++sz;
+    }
+
+    // Links value just before pos, which must be on this list
+    void insert_before(T& pos, T& value) {
+        linkBefore(hookOf(pos), hookOf(value));
+        ++sz;
+    }
+
+    void pop_front() {
+        if (sz == 0) return;
+        unlink(sentinel.next);
+        --sz;
+    }
+
+    void pop_back() {
+        if (sz == 0) return;
+        unlink(sentinel.prev);
+        --sz;
+    }
+
+    // Unlinks value, which must be on this list
+    void erase(T& value) {
+        unlink(hookOf(value));
+        --sz;
+    }
+
+    // Moves value, which must be on this list, to the front
+    void move_to_front(T& value) {
+        ListHook* hook = hookOf(value);
+        if (sentinel.next == hook) return;
+        hook->prev->next = hook->next;
+        hook->next->prev = hook->prev;
+        linkBefore(sentinel.next, hook);
+    }
+
+    T& front() { return *ownerOf(sentinel.next); }
+    const T& front() const { return *ownerOf(sentinel.next); }
+    T& back() { return *ownerOf(sentinel.prev); }
+    const T& back() const { return *ownerOf(sentinel.prev); }
+
+    // Element after / before value, or nullptr at the ends
+    T* next(T& value) {
+        ListHook* hook = hookOf(value)->next;
+        return hook == &sentinel ? nullptr : ownerOf(hook);
+    }
+
+    T* prev(T& value) {
+        ListHook* hook = hookOf(value)->prev;
+        return hook == &sentinel ? nullptr : ownerOf(hook);
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        for (ListHook* hook = sentinel.next; hook != &sentinel;) {
+            ListHook* following = hook->next;   // fn may erase the current element
+            fn(*ownerOf(hook));
+            hook = following;
+        }
+    }
+
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+
+    // Unlinks every element; the objects themselves are untouched
+    void clear() {
+        while (sz > 0) pop_front();
+    }
+
+    void print() const {
+        std::cout << "IntrusiveList: [ ";
+        for (ListHook* hook = sentinel.next; hook != &sentinel; hook = hook->next)
+            std::cout << *ownerOf(hook) << " ";
+        std::cout << "]\n";
+    }
+
+    ~IntrusiveList() {
+        clear();
+    }
+
+    // Delete copy constructor and copy assignment
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+};
+
+// Link fields for IntrusiveMap. Copying an object does not copy its links.
+struct MapHook {
+    MapHook* left;
+    MapHook* right;
+    int height;   // 0 while unlinked
+
+    MapHook() : left(nullptr), right(nullptr), height(0) {}
+    MapHook(const MapHook&) : left(nullptr), right(nullptr), height(0) {}
+    MapHook& operator=(const MapHook&) { return *this; }
+
+    bool is_linked() const { return height != 0; }
+};
+
+// AVL tree ordered by T::*KeyMember and threaded through T::*Hook. The
+// key must not change while the object is linked.
+template <typename K, typename T, K T::*KeyMember, MapHook T::*Hook, typename Compare = std::less<K>>
+class IntrusiveMap {
+private:
+    MapHook* root;
+    size_t sz;
+    Compare comp;
+
+    static MapHook* hookOf(T& value) { return &(value.*Hook); }
+    static T* ownerOf(MapHook* hook) { return hookOwner(hook, Hook); }
+    static const K& keyOf(MapHook* hook) { return ownerOf(hook)->*KeyMember; }
+
+    static int getHeight(MapHook* node) {
+        return node ? node->height : 0;
+    }
+
+    static int getBalance(MapHook* node) {
+        return node ? getHeight(node->left) - getHeight(node->right) : 0;
+    }
+
+    static void updateHeight(MapHook* node) {
+        node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
+    }
+
+    static MapHook* rotateRight(MapHook* y) {
+        MapHook* x = y->left;
+        y->left = x->right;
+        x->right = y;
+        updateHeight(y);
+        updateHeight(x);
+        return x;
+    }
+
+    static MapHook* rotateLeft(MapHook* x) {
+        MapHook* y = x->right;
+        x->right = y->left;
+        y->left = x;
+        updateHeight(x);
+        updateHeight(y);
+        return y;
+    }
+
+    static MapHook* rebalance(MapHook* node) {
+        updateHeight(node);
+        int balance = getBalance(node);
+
+        if (balance > 1) {
+            if (getBalance(node->left) < 0) node->left = rotateLeft(node->left);
+            return rotateRight(node);
+        }
+        if (balance < -1) {
+            if (getBalance(node->right) > 0) node->right = rotateRight(node->right);
+            return rotateLeft(node);
+        }
+        return node;
+    }
+
+    MapHook* link(MapHook* node, MapHook* fresh, bool& inserted) {
+        if (!node) {
+            ++sz;
+            inserted = true;
+            fresh->left = fresh->right = nullptr;
+            fresh->height = 1;
+            return fresh;
+        }
+
+        if (comp(keyOf(fresh), keyOf(node))) {
+            node->left = link(node->left, fresh, inserted);
+        } else if (comp(keyOf(node), keyOf(fresh))) {
+            node->right = link(node->right, fresh, inserted);
+        } else {
+            return node;
+        }
+
+        return rebalance(node);
+    }
+
+    static MapHook* detachMin(MapHook* node, MapHook*& min) {
+        if (!node->left) {
+            min = node;
+            return node->right;
+        }
+        node->left = detachMin(node->left, min);
+        return rebalance(node);
+    }
+
+    template<typename Key>
+    MapHook* detach(MapHook* node, const Key& key, MapHook*& removed) {
+        if (!node) return node;
+
+        if (comp(key, keyOf(node))) {
+            node->left = detach(node->left, key, removed);
+        } else if (comp(keyOf(node), key)) {
+            node->right = detach(node->right, key, removed);
+        } else {
+            --sz;
+            removed = node;
+            MapHook* left = node->left;
+            MapHook* right = node->right;
+            node->left = node->right = nullptr;
+            node->height = 0;
+            if (!left) return right;
+            if (!right) return left;
+            MapHook* min = nullptr;
+            MapHook* rest = detachMin(right, min);
+            min->left = left;
+            min->right = rest;
+            return rebalance(min);
+        }
+
+        return rebalance(node);
+    }
+
+    template<typename Key>
+    MapHook* find(MapHook* node, const Key& key) const {
+        while (node) {
+            if (comp(key, keyOf(node))) node = node->left;
+            else if (comp(keyOf(node), key)) node = node->right;
+            else return node;
+        }
+        return nullptr;
+    }
+
+    void unlinkAll(MapHook* node) {
+        if (node) {
+            unlinkAll(node->left);
+            unlinkAll(node->right);
+            node->left = node->right = nullptr;
+            node->height = 0;
+        }
+    }
+
+    template<typename Fn>
+    void inorder(MapHook* node, Fn& fn) {
+        if (node) {
+            MapHook* right = node->right;
+            inorder(node->left, fn);
+            fn(*ownerOf(node));
+            inorder(right, fn);
+        }
+    }
+
+    void printTree(MapHook* node) const {
+        if (node) {
+            printTree(node->left);
+            std::cout << keyOf(node) << " ";
+            printTree(node->right);
+        }
+    }
+
+public:
+    IntrusiveMap() : root(nullptr), sz(0), comp() {}
+
+    explicit IntrusiveMap(const Compare& c) : root(nullptr), sz(0), comp(c) {}
+
+    IntrusiveMap(IntrusiveMap&& other) noexcept : root(other.root), sz(other.sz), comp(std::move(other.comp)) {
+        other.root = nullptr;
+        other.sz = 0;
+    }
+
+    IntrusiveMap& operator=(IntrusiveMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            sz = other.sz;
+            comp = std::move(other.comp);
+            other.root = nullptr;
+            other.sz = 0;
+        }
+        return *this;
+    }
+
+    // Links value under its key; returns false if the key is already present
+    bool insert(T& value) {
+        bool inserted = false;
+        root = link(root, hookOf(value), inserted);
+        return inserted;
+    }
+
+    // Unlinks and returns the element with key, or nullptr
+    T* erase(const K& key) {
+        MapHook* removed = nullptr;
+        root = detach(root, key, removed);
+        return removed ? ownerOf(removed) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    T* erase(const Key& key) {
+        MapHook* removed = nullptr;
+        root = detach(root, key, removed);
+        return removed ? ownerOf(removed) : nullptr;
+    }
+
+    // Unlinks value, which must be linked into this map
+    void erase(T& value) {
+        MapHook* removed = nullptr;
+        root = detach(root, value.*KeyMember, removed);
+    }
+
+    T* find(const K& key) const {
+        MapHook* node = find(root, key);
+        return node ? ownerOf(node) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    T* find(const Key& key) const {
+        MapHook* node = find(root, key);
+        return node ? ownerOf(node) : nullptr;
+    }
+
+    // Visits elements in key order; fn may not erase
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        inorder(root, fn);
+    }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    // Unlinks every element; the objects themselves are untouched
+    void clear() {
+        unlinkAll(root);
+        root = nullptr;
+        sz = 0;
+    }
+
+    void print() const {
+        std::cout << "IntrusiveMap: { ";
+        printTree(root);
+        std::cout << "}\n";
+    }
+
+    ~IntrusiveMap() {
+        clear();
+    }
+
+    // Delete copy constructor and copy assignment
+    IntrusiveMap(const IntrusiveMap&) = delete;
+    IntrusiveMap& operator=(const IntrusiveMap&) = delete;
+};
\ No newline at end of file
@@ -4,10 +4,13 @@
 #include <iostream>
 #include <utility>
 
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
 template <typename T>
 class LinkedList {
 private:
-    struct Node {
+    struct Node : PooledNode {
         T data;
         Node* next;
         
@@ -130,6 +133,69 @@ public:
         --sz;
     }
     
+    // Moves all of other's nodes onto the end of this list in O(1)
+    void splice_back(LinkedList& other) {
+        if (this == &other || !other.head) return;
+        if (tail) tail->next = other.head;
+        else head = other.head;
+        tail = other.tail;
+        sz += other.sz;
+        other.head = other.tail = nullptr;
+        other.sz = 0;
+    }
+    
+    // Moves all of other's nodes onto the front of this list in O(1)
+    void splice_front(LinkedList& other) {
+        if (this == &other || !other.head) return;
+        other.tail->next = head;
+        if (!tail) tail = other.tail;
+        head = other.head;
+        sz += other.sz;
+        other.head = other.tail = nullptr;
+        other.sz = 0;
+    }
+    
+    // Positional splice: moves count nodes starting at other[first] so they
+    // begin at this[index], relinking the existing nodes without allocating.
+    // This is not O(1): the list is singly linked without iterators, so
+    // walking to both ends costs O(index + first + count).
+    void splice_at(size_t index, LinkedList& other, size_t first, size_t count) {
+        if (this == &other || first >= other.sz || count == 0) return;
+        if (count > other.sz - first) count = other.sz - first;
+        
+        // Cut [first, first + count) out of other
+        Node* before = nullptr;
+        Node* start = other.head;
+        for (size_t i = 0; i < first; ++i) {
+            before = start;
+            start = start->next;
+        }
+        Node* end = start;
+        for (size_t i = 1; i < count; ++i) end = end->next;
+        Node* after = end->next;
+        if (before) before->next = after;
+        else other.head = after;
+        if (!after) other.tail = before;
+        other.sz -= count;
+        
+        // Link it in ahead of this[index]
+        if (index >= sz) {
+            end->next = nullptr;
+            if (tail) tail->next = start;
+            else head = start;
+            tail = end;
+        } else if (index == 0) {
+            end->next = head;
+            head = start;
+        } else {
+            Node* current = head;
+            for (size_t i = 0; i < index - 1; ++i) current = current->next;
+            end->next = current->next;
+            current->next = start;
+        }
+        sz += count;
+    }
+    
     T& operator[](size_t index) {
         Node* current = head;
         for (size_t i = 0; i < index; ++i) {
@@ -164,6 +230,20 @@ public:
         sz = 0;
     }
     
+    // Deep copy in a single linear pass
+    LinkedList clone() const {
+        LinkedList copy;
+        for (Node* current = head; current; current = current->next) {
+            copy.push_back(current->data);
+        }
+        return copy;
+    }
+    
+    // One heap block per element
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), sz * nodeBlockBytes(sizeof(Node)));
+    }
+
     void print() const {
         std::cout << "LinkedList: [ ";
         Node* current = head;
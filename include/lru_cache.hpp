@@ -0,0 +1,591 @@
+// File: include/lru_cache.hpp
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "intrusive.hpp"
+#include "memory_usage.hpp"
+#include "vector.hpp"
+
+// Fixed-capacity key/value caches with O(1) get, put and evict:
+//
+//     LruCache<std::string, Response> cache(CacheCapacity::entries(10000));
+//     if (Response* r = cache.get(url)) return *r;
+//     cache.put(url, fetch(url));
+//
+// Entries live in a slab of stable slots, found through an open-addressing
+// index and ordered by an IntrusiveList threaded through the slots, so a hit
+// or an update allocates nothing and a miss that evicts reuses the victim's
+// slot (assigning into its key and value, so even their own buffers are
+// recycled). The capacity is a number of entries, fixed up front, or a byte
+// budget charged per entry by a weigher, in which case the slab and index
+// grow as needed.
+//
+// Two eviction policies share the machinery:
+//   LruPolicy    evicts the least recently used entry; a hit moves the entry
+//                to the front of the list.
+//   ClockPolicy  GCLOCK: a hit only bumps a small saturating use counter and a
+//                clock hand sweeping the list evicts the first entry whose
+//                counter has run down. Entries used often survive several
+//                sweeps, which approximates LFU and resists scans.
+struct CacheCapacity {
+    size_t limit;
+    bool inBytes;
+
+    static CacheCapacity entries(size_t n) { return CacheCapacity{n, false}; }
+    static CacheCapacity bytes(size_t n) { return CacheCapacity{n, true}; }
+};
+
+// Hit/miss counters; evictions count only capacity evictions, not erase()
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    double hit_rate() const {
+        size_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    CacheStats& operator+=(const CacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        return *this;
+    }
+};
+
+struct LruPolicy {
+    template <typename Entry, typename List>
+    struct State {
+        List order;   // most recent at the front
+
+        void inserted(Entry& e) { order.push_front(e); }
+        void touched(Entry& e) { order.move_to_front(e); }
+        void removed(Entry& e) { order.erase(e); }
+        Entry& victim() { return order.back(); }
+    };
+};
+
+struct ClockPolicy {
+    static constexpr uint8_t MAX_USES = 3;
+
+    template <typename Entry, typename List>
+    struct State {
+        List ring;
+        Entry* hand = nullptr;   // next entry the sweep examines
+
+        // New entries go just behind the hand, so they get a full sweep
+        // before their first examination
+        void inserted(Entry& e) {
+            e.uses = 0;
+            if (hand) {
+                ring.insert_before(*hand, e);
+            } else {
+                ring.push_back(e);
+                hand = &e;
+            }
+        }
+
+        void touched(Entry& e) {
+            if (e.uses < MAX_USES) ++e.uses;
+        }
+
+        void removed(Entry& e) {
+            if (hand == &e) hand = advance(e);
+            ring.erase(e);
+            if (ring.empty()) hand = nullptr;
+        }
+
+        Entry& victim() {
+            while (hand->uses > 0) {
+                --hand->uses;
+                hand = advance(*hand);
+            }
+            return *hand;
+        }
+
+        Entry* advance(Entry& e) {
+            Entry* next = ring.next(e);
+            return next ? next : &ring.front();
+        }
+    };
+};
+
+template <typename K, typename V, typename Policy = LruPolicy, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class BasicCache {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using hasher = Hash;
+    using EvictionCallback = std::function<void(const K&, V&)>;
+    using Weigher = std::function<size_t(const K&, const V&)>;
+
+private:
+    struct Entry {
+        K key;
+        V value;
+        size_t hash;
+        size_t weight;
+        ListHook hook;
+        uint8_t uses;
+
+        template<typename KType, typename VType>
+        Entry(KType&& k, VType&& v, size_t h, size_t w)
+            : key(std::forward<KType>(k)), value(std::forward<VType>(v)), hash(h), weight(w), hook(), uses(0) {}
+    };
+
+    using List = IntrusiveList<Entry, &Entry::hook>;
+    using PolicyState = typename Policy::template State<Entry, List>;
+
+    // Slots are carved from chunks that never move, so the list and index
+    // can hold plain pointers. Free slots are raw storage linked through
+    // their first word.
+    struct Slot {
+        alignas(Entry) unsigned char bytes[sizeof(Entry)];
+    };
+
+    static constexpr size_t FIRST_CHUNK = 16;
+
+    CacheCapacity cap;
+    Weigher weigher;
+    EvictionCallback onEvict;
+    Hash hashKey;
+    KeyEqual equal;
+
+    Vector<Slot*> chunks;
+    Vector<size_t> chunkSizes;
+    void* freeSlots;
+    size_t slotCount;
+
+    Entry** table;   // open addressing with linear probing, at most half full
+    size_t mask;
+    size_t count;
+    size_t used;     // bytes charged, in byte mode
+    mutable PolicyState policy;   // mutable only because IntrusiveList has no const traversal
+    CacheStats counters;
+
+    // std::hash is the identity for integers; spread it so linear probing
+    // stays short for strided keys
+    static size_t mix(size_t h) {
+        uint64_t x = static_cast<uint64_t>(h);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
+    }
+
+    static size_t tableSizeFor(size_t entries) {
+        size_t n = 16;
+        while (n < entries * 2) n *= 2;
+        return n;
+    }
+
+    void allocateTable(size_t n) {
+        table = new Entry*[n]();
+        mask = n - 1;
+    }
+
+    void addChunk(size_t n) {
+        Slot* chunk = static_cast<Slot*>(::operator new(n * sizeof(Slot)));
+        chunks.push_back(chunk);
+        chunkSizes.push_back(n);
+        for (size_t i = n; i-- > 0;) {
+            *reinterpret_cast<void**>(chunk[i].bytes) = freeSlots;
+            freeSlots = chunk[i].bytes;
+        }
+        slotCount += n;
+    }
+
+    void* takeSlot() {
+        if (!freeSlots) addChunk(slotCount ? slotCount : FIRST_CHUNK);
+        void* slot = freeSlots;
+        freeSlots = *static_cast<void**>(slot);
+        return slot;
+    }
+
+    // Puts raw storage back on the free list
+    void releaseSlot(void* slot) {
+        *static_cast<void**>(slot) = freeSlots;
+        freeSlots = slot;
+    }
+
+    void returnSlot(Entry* e) {
+        e->~Entry();
+        releaseSlot(e);
+    }
+
+    void rehash(size_t n) {
+        Entry** old = table;
+        size_t oldSize = mask + 1;
+        allocateTable(n);
+        for (size_t i = 0; i < oldSize; ++i) {
+            if (old[i]) table[probeFree(old[i]->hash)] = old[i];
+        }
+        delete[] old;
+    }
+
+    size_t probeFree(size_t h) const {
+        size_t i = h & mask;
+        while (table[i]) i = (i + 1) & mask;
+        return i;
+    }
+
+    // Index slot holding key, or the empty slot where it would go
+    template<typename Key>
+    size_t probe(const Key& key, size_t h) const {
+        size_t i = h & mask;
+        while (Entry* e = table[i]) {
+            if (e->hash == h && equal(e->key, key)) return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // Backward-shift deletion: pulls later entries of the probe run into the
+    // hole so lookups never need tombstones
+    void unindex(size_t i) {
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            Entry* e = table[j];
+            if (!e) break;
+            size_t home = e->hash & mask;
+            bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!stays) {
+                table[i] = e;
+                i = j;
+            }
+        }
+        table[i] = nullptr;
+    }
+
+    void unindex(Entry* e) {
+        unindex(probe(e->key, e->hash));
+    }
+
+    size_t weigh(const K& key, const V& value) const {
+        return weigher ? weigher(key, value) : sizeof(K) + sizeof(V);
+    }
+
+    bool overBudget(size_t extra) const {
+        if (cap.inBytes) return used + extra > cap.limit;
+        return count + (extra ? 1 : 0) > cap.limit;
+    }
+
+    // Unlinks and unindexes the policy's victim, reporting it to the callback
+    Entry* evictOne() {
+        Entry& victim = policy.victim();
+        policy.removed(victim);
+        unindex(&victim);
+        --count;
+        used -= victim.weight;
+        ++counters.evictions;
+        if (onEvict) onEvict(victim.key, victim.value);
+        return &victim;
+    }
+
+    void removeEntry(size_t index) {
+        Entry* e = table[index];
+        policy.removed(*e);
+        unindex(index);
+        --count;
+        used -= e->weight;
+        returnSlot(e);
+    }
+
+public:
+    explicit BasicCache(CacheCapacity capacity, Weigher w = Weigher(), const Hash& h = Hash(),
+                        const KeyEqual& eq = KeyEqual())
+        : cap(capacity), weigher(std::move(w)), onEvict(), hashKey(h), equal(eq), chunks(), chunkSizes(),
+          freeSlots(nullptr), slotCount(0), table(nullptr), mask(0), count(0), used(0), policy(), counters() {
+        if (cap.inBytes) {
+            allocateTable(tableSizeFor(FIRST_CHUNK));
+        } else {
+            allocateTable(tableSizeFor(cap.limit));
+            if (cap.limit) addChunk(cap.limit);
+        }
+    }
+
+    void set_eviction_callback(EvictionCallback fn) { onEvict = std::move(fn); }
+
+    // Returns the value and marks it used, or nullptr on a miss. The pointer
+    // stays valid until the next put or erase.
+    V* get(const K& key) {
+        size_t h = mix(hashKey(key));
+        Entry* e = table[probe(key, h)];
+        if (!e) {
+            ++counters.misses;
+            return nullptr;
+        }
+        ++counters.hits;
+        policy.touched(*e);
+        return &e->value;
+    }
+
+    // Looks without counting or touching
+    const V* peek(const K& key) const {
+        size_t h = mix(hashKey(key));
+        Entry* e = table[probe(key, h)];
+        return e ? &e->value : nullptr;
+    }
+
+    bool contains(const K& key) const { return peek(key) != nullptr; }
+
+    // Inserts or overwrites key, evicting as needed. Returns false, leaving
+    // key absent, if the entry alone exceeds the capacity.
+    template<typename KType, typename VType>
+    bool put(KType&& key, VType&& value) {
+        if constexpr (!std::is_same_v<std::decay_t<KType>, K>) {
+            // Convert once rather than once for the hash and once per probe
+            return put(K(std::forward<KType>(key)), std::forward<VType>(value));
+        } else {
+            size_t h = mix(hashKey(key));
+            size_t index = probe(key, h);
+            if (Entry* e = table[index]) {
+                e->value = std::forward<VType>(value);
+                size_t weight = cap.inBytes ? weigh(e->key, e->value) : 0;
+                used = used - e->weight + weight;
+                e->weight = weight;
+                policy.touched(*e);
+                if (cap.inBytes && weight > cap.limit) {
+                    removeEntry(index);
+                    return false;
+                }
+                if (cap.inBytes && used > cap.limit) {
+                    // Take the entry out of the policy's order while making
+                    // room so it cannot be chosen as its own victim
+                    uint8_t uses = e->uses;
+                    policy.removed(*e);
+                    while (used > cap.limit) returnSlot(evictOne());
+                    policy.inserted(*e);
+                    e->uses = uses;
+                }
+                return true;
+            }
+
+            size_t weight = 0;
+            if (cap.inBytes) {
+                weight = weigh(key, value);
+                if (weight > cap.limit) return false;
+            } else if (cap.limit == 0) {
+                return false;
+            }
+
+            Entry* reuse = nullptr;
+            while (overBudget(cap.inBytes ? weight : 1)) {
+                if (reuse) returnSlot(reuse);
+                reuse = evictOne();
+            }
+            Entry* e;
+            if (reuse) {
+                // Assign into the victim so its key and value keep their buffers
+                try {
+                    reuse->key = std::forward<KType>(key);
+                    reuse->value = std::forward<VType>(value);
+                } catch (...) {
+                    returnSlot(reuse);
+                    throw;
+                }
+                reuse->hash = h;
+                reuse->weight = weight;
+                e = reuse;
+            } else {
+                void* slot = takeSlot();
+                try {
+                    e = new (slot) Entry(std::forward<KType>(key), std::forward<VType>(value), h, weight);
+                } catch (...) {
+                    releaseSlot(slot);
+                    throw;
+                }
+            }
+            if ((count + 1) * 2 > mask + 1) {
+                try {
+                    rehash((mask + 1) * 2);
+                } catch (...) {
+                    returnSlot(e);
+                    throw;
+                }
+            }
+            table[probeFree(h)] = e;
+            ++count;
+            used += weight;
+            policy.inserted(*e);
+            return true;
+        }
+    }
+
+    bool erase(const K& key) {
+        size_t index = probe(key, mix(hashKey(key)));
+        if (!table[index]) return false;
+        removeEntry(index);
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (Entry* e = table[i]) {
+                policy.removed(*e);
+                table[i] = nullptr;
+                returnSlot(e);
+            }
+        }
+        count = 0;
+        used = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    CacheCapacity capacity() const { return cap; }
+    size_t bytes_used() const { return used; }
+
+    const CacheStats& stats() const { return counters; }
+    size_t hits() const { return counters.hits; }
+    size_t misses() const { return counters.misses; }
+    size_t evictions() const { return counters.evictions; }
+    double hit_rate() const { return counters.hit_rate(); }
+    void reset_stats() { counters = CacheStats(); }
+
+    MemoryUsage memory_usage() const {
+        size_t heap = heapBlockBytes((mask + 1) * sizeof(Entry*));
+        for (size_t i = 0; i < chunkSizes.size(); ++i) heap += heapBlockBytes(chunkSizes[i] * sizeof(Slot));
+        return makeMemoryUsage(sizeof(*this), count, sizeof(K) + sizeof(V), heap);
+    }
+
+    // Entries in the policy's order: most recent first for LRU, from the
+    // clock hand onward for CLOCK
+    void print() const {
+        std::cout << "Cache: ";
+        for_each([](const K& k, const V& v) { std::cout << "(" << k << ": " << v << ") "; });
+        std::cout << "\n";
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        if constexpr (std::is_same_v<Policy, LruPolicy>) {
+            policy.order.for_each([&](Entry& e) { fn(e.key, e.value); });
+        } else {
+            if (!policy.hand) return;
+            Entry* e = policy.hand;
+            do {
+                fn(e->key, e->value);
+                e = policy.advance(*e);
+            } while (e != policy.hand);
+        }
+    }
+
+    ~BasicCache() {
+        clear();
+        delete[] table;
+        for (size_t i = 0; i < chunks.size(); ++i) ::operator delete(chunks[i]);
+    }
+
+    // Delete copy constructor and copy assignment
+    BasicCache(const BasicCache&) = delete;
+    BasicCache& operator=(const BasicCache&) = delete;
+};
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+using LruCache = BasicCache<K, V, LruPolicy, Hash, KeyEqual>;
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+using ClockCache = BasicCache<K, V, ClockPolicy, Hash, KeyEqual>;
+
+// A cache split into independently locked shards picked by key hash, for
+// front ends hit from many threads. The capacity is divided evenly. get()
+// returns a copy, since the entry may be evicted as soon as the shard's lock
+// is released; eviction callbacks run under that lock.
+template <typename Cache, size_t Shards = 16>
+class ShardedCache {
+    static_assert((Shards & (Shards - 1)) == 0, "shard count must be a power of two");
+
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::optional<Cache> cache;
+    };
+
+    Shard shards[Shards];
+
+    using K = typename Cache::key_type;
+    using V = typename Cache::mapped_type;
+
+    static constexpr unsigned SHARD_BITS = std::bit_width(Shards) - 1;
+
+    Shard& shardFor(const K& key) {
+        // Top bits of a multiplicative hash, independent of the low bits
+        // each shard's index probes with
+        uint64_t h = static_cast<uint64_t>(typename Cache::hasher()(key)) * 0x9E3779B97F4A7C15ULL;
+        return shards[(h >> (63 - SHARD_BITS)) >> 1];
+    }
+
+public:
+    template<typename... Args>
+    explicit ShardedCache(CacheCapacity capacity, Args&&... args) {
+        CacheCapacity per{(capacity.limit + Shards - 1) / Shards, capacity.inBytes};
+        for (size_t i = 0; i < Shards; ++i) shards[i].cache.emplace(per, args...);
+    }
+
+    std::optional<V> get(const K& key) {
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        V* v = s.cache->get(key);
+        if (!v) return std::nullopt;
+        return *v;
+    }
+
+    template<typename VType>
+    bool put(const K& key, VType&& value) {
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.cache->put(key, std::forward<VType>(value));
+    }
+
+    bool erase(const K& key) {
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.cache->erase(key);
+    }
+
+    template<typename Fn>
+    void set_eviction_callback(const Fn& fn) {
+        for (size_t i = 0; i < Shards; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].cache->set_eviction_callback(fn);
+        }
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (size_t i = 0; i < Shards; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            total += shards[i].cache->size();
+        }
+        return total;
+    }
+
+    CacheStats stats() {
+        CacheStats total;
+        for (size_t i = 0; i < Shards; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            total += shards[i].cache->stats();
+        }
+        return total;
+    }
+
+    // Delete copy constructor and copy assignment
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+};
+
+template <typename K, typename V, size_t Shards = 16>
+using ShardedLruCache = ShardedCache<LruCache<K, V>, Shards>;
\ No newline at end of file
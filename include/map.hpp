@@ -1,233 +1,226 @@
 // File: include/map.hpp
 #pragma once
 
+#include <functional>
 #include <iostream>
+#include <type_traits>
 #include <utility>
 
-template <typename K, typename V>
+#include "compare.hpp"
+#include "memory_usage.hpp"
+#include "tree.hpp"
+
+// Compare defaults to std::less<K>; pass a transparent comparator such as
+// std::less<> to let find/erase/contains take any key-like type without
+// constructing a temporary K. Balance picks the rebalancing rule (see
+// tree.hpp): AvlBalance, the default, keeps lookups shortest;
+// WavlBalance or RedBlackBalance do less restructuring per update for
+// write-heavy maps.
+template <typename K, typename V, typename Compare = std::less<K>, typename Balance = AvlBalance>
 class Map {
 private:
-    struct Node {
+    struct Entry {
         K key;
         V value;
-        Node* left;
-        Node* right;
-        int height;
         
         template<typename KType, typename VType>
-        Node(KType&& k, VType&& v) 
-            : key(std::forward<KType>(k)), value(std::forward<VType>(v)), 
-              left(nullptr), right(nullptr), height(1) {}
+        Entry(KType&& k, VType&& v) : key(std::forward<KType>(k)), value(std::forward<VType>(v)) {}
+        
+        const K& sort_key() const { return key; }
     };
     
-    Node* root;
-    size_t sz;
+    using Tree = BalancedTree<Entry, Compare, Balance>;
+    using Node = typename Tree::Node;
     
-    int getHeight(Node* node) {
-        return node ? node->height : 0;
-    }
+    Tree tree;
     
-    int getBalance(Node* node) {
-        return node ? getHeight(node->left) - getHeight(node->right) : 0;
+    // Inserts or overwrites; key is only compared, the node is built from k
+    template<typename Key, typename KType, typename VType>
+    void assign(const Key& key, KType&& k, VType&& value) {
+        bool inserted = false;
+        Node* node = tree.insert(key, [&] { return new Node(std::forward<KType>(k), std::forward<VType>(value)); },
+                                 inserted);
+        if (!inserted) node->value = std::forward<VType>(value);
     }
+
+public:
+    // Owning handle to a node taken out of a Map by extract(). The key may
+    // be modified before the node is inserted into another Map.
+    class node_type : public TreeNodeHandle<Node> {
+    private:
+        friend class Map;
+        explicit node_type(Node* n) : TreeNodeHandle<Node>(n) {}
+        
+    public:
+        node_type() = default;
+        
+        K& key() { return this->node->key; }
+        const K& key() const { return this->node->key; }
+        V& value() { return this->node->value; }
+        const V& value() const { return this->node->value; }
+    };
     
-    void updateHeight(Node* node) {
-        if (node) {
-            node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
-        }
-    }
+    Map() : tree() {}
     
-    Node* rotateRight(Node* y) {
-        Node* x = y->left;
-        Node* T2 = x->right;
-        x->right = y;
-        y->left = T2;
-        updateHeight(y);
-        updateHeight(x);
-        return x;
-    }
+    explicit Map(const Compare& c) : tree(c) {}
     
-    Node* rotateLeft(Node* x) {
-        Node* y = x->right;
-        Node* T2 = y->left;
-        y->left = x;
-        x->right = T2;
-        updateHeight(x);
-        updateHeight(y);
-        return y;
-    }
+    Map(Map&& other) noexcept = default;
+    Map& operator=(Map&& other) noexcept = default;
     
     template<typename KType, typename VType>
-    Node* insert(Node* node, KType&& key, VType&& value) {
-        if (!node) {
-            ++sz;
-            return new Node(std::forward<KType>(key), std::forward<VType>(value));
-        }
-        
-        if (key < node->key) {
-            node->left = insert(node->left, std::forward<KType>(key), std::forward<VType>(value));
-        } else if (key > node->key) {
-            node->right = insert(node->right, std::forward<KType>(key), std::forward<VType>(value));
+    void insert(KType&& key, VType&& value) {
+        if constexpr (is_transparent_v<Compare> || std::is_same_v<std::decay_t<KType>, K>) {
+            assign(key, std::forward<KType>(key), std::forward<VType>(value));
         } else {
-            node->value = std::forward<VType>(value);
-            return node;
-        }
-        
-        updateHeight(node);
-        int balance = getBalance(node);
-        
-        if (balance > 1 && key < node->left->key)
-            return rotateRight(node);
-        if (balance < -1 && key > node->right->key)
-            return rotateLeft(node);
-        if (balance > 1 && key > node->left->key) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
-        }
-        if (balance < -1 && key < node->right->key) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
+            // Convert once up front rather than once per comparison on the way down
+            K k(std::forward<KType>(key));
+            assign(k, std::move(k), std::forward<VType>(value));
         }
-        
-        return node;
     }
     
-    Node* findMin(Node* node) {
-        while (node->left) node = node->left;
-        return node;
+    void erase(const K& key) {
+        delete tree.detach(key);
     }
     
-    Node* remove(Node* node, const K& key) {
-        if (!node) return node;
-        
-        if (key < node->key) {
-            node->left = remove(node->left, key);
-        } else if (key > node->key) {
-            node->right = remove(node->right, key);
-        } else {
-            --sz;
-            if (!node->left || !node->right) {
-                Node* temp = node->left ? node->left : node->right;
-                if (!temp) {
-                    temp = node;
-                    node = nullptr;
-                } else {
-                    *node = *temp;
-                }
-                delete temp;
-            } else {
-                Node* temp = findMin(node->right);
-                node->key = temp->key;
-                node->value = temp->value;
-                ++sz; // Compensate for the decrement above
-                node->right = remove(node->right, temp->key);
-            }
-        }
-        
-        if (!node) return node;
-        
-        updateHeight(node);
-        int balance = getBalance(node);
-        
-        if (balance > 1 && getBalance(node->left) >= 0)
-            return rotateRight(node);
-        if (balance > 1 && getBalance(node->left) < 0) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
-        }
-        if (balance < -1 && getBalance(node->right) <= 0)
-            return rotateLeft(node);
-        if (balance < -1 && getBalance(node->right) > 0) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
-        }
-        
-        return node;
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void erase(const Key& key) {
+        delete tree.detach(key);
     }
     
-    Node* find(Node* node, const K& key) const {
-        if (!node || node->key == key) return node;
-        return key < node->key ? find(node->left, key) : find(node->right, key);
+    // Takes the node holding key out of the tree without freeing it. The
+    // returned handle owns the node; it is empty if key was not present.
+    node_type extract(const K& key) {
+        return node_type(tree.detach(key));
     }
     
-    void inorder(Node* node) const {
-        if (node) {
-            inorder(node->left);
-            std::cout << "{" << node->key << ": " << node->value << "} ";
-            inorder(node->right);
-        }
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    node_type extract(const Key& key) {
+        return node_type(tree.detach(key));
     }
     
-    void destroyTree(Node* node) {
-        if (node) {
-            destroyTree(node->left);
-            destroyTree(node->right);
-            delete node;
-        }
+    // Relinks an extracted node with no allocation. Returns false, leaving the
+    // handle still owning the node, if an equal key is already present.
+    bool insert(node_type&& handle) {
+        if (!handle.node) return false;
+        bool inserted = tree.link(handle.node);
+        if (inserted) handle.node = nullptr;
+        return inserted;
     }
-
-public:
-    Map() : root(nullptr), sz(0) {}
     
-    Map(Map&& other) noexcept : root(other.root), sz(other.sz) {
-        other.root = nullptr;
-        other.sz = 0;
+    // Moves every node of other whose key is not already here into this
+    // map. Nothing is allocated or copied; duplicates stay in other.
+    void merge(Map& other) {
+        tree.merge(other.tree);
     }
     
-    Map& operator=(Map&& other) noexcept {
-        if (this != &other) {
-            destroyTree(root);
-            root = other.root;
-            sz = other.sz;
-            other.root = nullptr;
-            other.sz = 0;
-        }
-        return *this;
+    V* find(const K& key) {
+        Node* node = tree.find(key);
+        return node ? &(node->value) : nullptr;
     }
     
-    template<typename KType, typename VType>
-    void insert(KType&& key, VType&& value) {
-        root = insert(root, std::forward<KType>(key), std::forward<VType>(value));
+    const V* find(const K& key) const {
+        Node* node = tree.find(key);
+        return node ? &(node->value) : nullptr;
     }
     
-    void erase(const K& key) {
-        root = remove(root, key);
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    V* find(const Key& key) {
+        Node* node = tree.find(key);
+        return node ? &(node->value) : nullptr;
     }
     
-    V* find(const K& key) {
-        Node* node = find(root, key);
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const V* find(const Key& key) const {
+        Node* node = tree.find(key);
         return node ? &(node->value) : nullptr;
     }
     
-    const V* find(const K& key) const {
-        Node* node = find(root, key);
-        return node ? &(node->value) : nullptr;
+    bool contains(const K& key) const {
+        return tree.find(key) != nullptr;
+    }
+    
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const {
+        return tree.find(key) != nullptr;
+    }
+    
+    // Batched find: out[i] receives find(keys[i]). Interleaves the tree
+    // descents with software prefetching, which pays off once the tree no
+    // longer fits in cache.
+    void find_batch(const K* keys, size_t n, V** out) {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node ? &(node->value) : nullptr; });
+    }
+    
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void find_batch(const Key* keys, size_t n, V** out) {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node ? &(node->value) : nullptr; });
+    }
+    
+    void find_batch(const K* keys, size_t n, const V** out) const {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node ? &(node->value) : nullptr; });
+    }
+    
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void find_batch(const Key* keys, size_t n, const V** out) const {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node ? &(node->value) : nullptr; });
     }
     
+    void contains_batch(const K* keys, size_t n, bool* out) const {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node != nullptr; });
+    }
+    
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void contains_batch(const Key* keys, size_t n, bool* out) const {
+        tree.lookupBatch(keys, n, [&](size_t i, Node* node) { out[i] = node != nullptr; });
+    }
+    
+    // One descent: the value is default-constructed only if key is new
     V& operator[](const K& key) {
-        Node* node = find(root, key);
-        if (!node) {
-            Node*& ref = root;
-            insert(key, V{});
-            return find(ref, key)->value;
-
-        }
-        return node->value;
+        bool inserted = false;
+        return tree.insert(key, [&] { return new Node(key, V{}); }, inserted)->value;
+    }
+    
+    // Deep copy that reproduces the tree node-for-node in O(n) with no
+    // comparisons or rebalancing
+    Map clone() const {
+        Map copy(tree.comparator());
+        copy.tree = tree.clone();
+        return copy;
+    }
+    
+    // Visits entries in key order as fn(key, value); fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        tree.for_each([&](Node& node) { fn(static_cast<const K&>(node.key), node.value); });
+    }
+    
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        tree.for_each([&](Node& node) { fn(static_cast<const K&>(node.key), static_cast<const V&>(node.value)); });
     }
     
-    size_t size() const { return sz; }
-    bool empty() const { return sz == 0; }
+    size_t size() const { return tree.size(); }
+    bool empty() const { return tree.size() == 0; }
+    
+    // Rotations and rank changes since construction or reset_balance_stats(),
+    // for comparing Balance policies on a real workload
+    const TreeStats& balance_stats() const { return tree.stats(); }
+    void reset_balance_stats() { tree.reset_stats(); }
+    
+    // Longest root-to-leaf path; walks every node
+    size_t height() const { return tree.height(); }
+    
+    // One heap block per entry; payload is the key and value
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), size(), sizeof(K) + sizeof(V), size() * nodeBlockBytes(sizeof(Node)));
+    }
     
     void print() const {
         std::cout << "Map: ";
-        inorder(root);
+        tree.for_each([](Node& node) { std::cout << "{" << node.key << ": " << node.value << "} "; });
         std::cout << "\n";
     }
     
-    ~Map() {
-        destroyTree(root);
-    }
-    
     // Delete copy constructor and copy assignment
     Map(const Map&) = delete;
     Map& operator=(const Map&) = delete;
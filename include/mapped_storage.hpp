@@ -0,0 +1,126 @@
+// File: include/mapped_storage.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "memory_usage.hpp"
+#include "vector.hpp"
+
+// Storage policy for very large Vectors: Vector<T, MappedStorage<>>.
+// Buffers of 2 MiB and up are mapped straight from the kernel, aligned to
+// 2 MiB and advised MADV_HUGEPAGE, so transparent huge pages can back them
+// and a scan takes one TLB entry per 2 MiB instead of per 4 KiB. Growing a
+// vector of trivially relocatable elements then extends the mapping with
+// mremap: in place when the address space after it is free, otherwise by
+// moving the page tables. No element is copied and the old and new buffers
+// never coexist, so peak memory stays at the data size rather than three
+// times it. Smaller buffers come from the heap as usual.
+//
+// With Prefault, every mapped page is faulted in when mapped or grown
+// (after the huge-page advice, so the faults can use huge pages), trading a
+// slower grow for no page faults on first touch.
+//
+// Elsewhere than Linux this behaves as HeapStorage.
+template <bool Prefault = false>
+struct MappedStorage {
+    static constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+#if defined(__linux__)
+    static constexpr bool remaps = true;
+
+    static bool isMapped(size_t bytes) { return bytes >= HUGE_PAGE; }
+
+    static size_t mappedLength(size_t bytes) { return (bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1); }
+
+    // Maps length bytes at a HUGE_PAGE-aligned address by over-mapping and
+    // trimming the ends. A PROT_NONE range only reserves address space.
+    static void* mapAligned(size_t length, int prot) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | (prot == PROT_NONE ? MAP_NORESERVE : 0);
+        void* raw = mmap(nullptr, length + HUGE_PAGE, prot, flags, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + HUGE_PAGE - 1) & ~(uintptr_t(HUGE_PAGE) - 1);
+        if (aligned > start) munmap(raw, aligned - start);
+        size_t tail = start + length + HUGE_PAGE - (aligned + length);
+        if (tail) munmap(reinterpret_cast<void*>(aligned + length), tail);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    static void prepare(void* p, size_t length) {
+#ifdef MADV_HUGEPAGE
+        madvise(p, length, MADV_HUGEPAGE);
+#endif
+        if constexpr (Prefault) {
+#ifdef MADV_POPULATE_WRITE
+            if (madvise(p, length, MADV_POPULATE_WRITE) == 0) return;
+#endif
+            // Older kernels: touch a byte per base page
+            volatile char* bytes = static_cast<char*>(p);
+            for (size_t i = 0; i < length; i += 4096) bytes[i] = 0;
+        }
+    }
+
+    template <typename T>
+    static T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (!isMapped(bytes)) return std::allocator<T>().allocate(n);
+        size_t length = mappedLength(bytes);
+        void* p = mapAligned(length, PROT_READ | PROT_WRITE);
+        prepare(p, length);
+        return static_cast<T*>(p);
+    }
+
+    template <typename T>
+    static void deallocate(T* p, size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (isMapped(bytes)) munmap(p, mappedLength(bytes));
+        else std::allocator<T>().deallocate(p, n);
+    }
+
+    // Resizes a mapped block keeping its bytes; null when the block is on
+    // the heap or the kernel refuses, and the caller copies instead
+    template <typename T>
+    static T* regrow(T* p, size_t oldN, size_t newN) {
+        size_t oldBytes = oldN * sizeof(T);
+        if (!isMapped(oldBytes)) return nullptr;
+        size_t oldLength = mappedLength(oldBytes);
+        size_t newLength = mappedLength(newN * sizeof(T));
+        if (newLength <= oldLength) return p;
+        char* base = reinterpret_cast<char*>(p);
+        if (mremap(p, oldLength, newLength, 0) != MAP_FAILED) {
+            prepare(base + oldLength, newLength - oldLength);
+            return p;
+        }
+        // Move onto a reserved aligned range so huge pages still line up
+        void* target = mapAligned(newLength, PROT_NONE);
+        void* moved = mremap(p, oldLength, newLength, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+        if (moved == MAP_FAILED) {
+            munmap(target, newLength);
+            return nullptr;
+        }
+        prepare(static_cast<char*>(moved) + oldLength, newLength - oldLength);
+        return static_cast<T*>(moved);
+    }
+
+    static size_t block_bytes(size_t bytes) { return isMapped(bytes) ? mappedLength(bytes) : heapBlockBytes(bytes); }
+#else
+    static constexpr bool remaps = false;
+
+    template <typename T>
+    static T* allocate(size_t n) { return std::allocator<T>().allocate(n); }
+
+    template <typename T>
+    static void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <typename T>
+    static T* regrow(T*, size_t, size_t) { return nullptr; }
+
+    static size_t block_bytes(size_t bytes) { return heapBlockBytes(bytes); }
+#endif
+};
\ No newline at end of file
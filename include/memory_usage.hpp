@@ -0,0 +1,45 @@
+// File: include/memory_usage.hpp
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+// What a container costs in memory, as reported by memory_usage(). payload is
+// sizeof(element) for every element held; overhead is everything else the
+// container is responsible for: the container object itself, links, balance
+// data, unused capacity and the allocator's per-block bookkeeping. Memory an
+// element owns indirectly (a std::string's heap buffer, say) is not counted.
+struct MemoryUsage {
+    size_t payload;
+    size_t overhead;
+
+    MemoryUsage() : payload(0), overhead(0) {}
+    MemoryUsage(size_t p, size_t o) : payload(p), overhead(o) {}
+
+    size_t total() const { return payload + overhead; }
+
+    // Average bytes per element, or 0 for an empty container
+    double bytes_per_element(size_t count) const {
+        return count ? static_cast<double>(total()) / static_cast<double>(count) : 0.0;
+    }
+
+    void print() const {
+        std::cout << "MemoryUsage: payload " << payload << " B, overhead " << overhead
+                  << " B, total " << total() << " B\n";
+    }
+};
+
+// Bytes the heap really consumes for one allocation of n bytes, modelled on
+// glibc malloc: an 8-byte size header, 16-byte granularity and a 32-byte
+// minimum chunk. Other allocators differ in detail, not in kind.
+inline size_t heapBlockBytes(size_t n) {
+    size_t chunk = (n + sizeof(size_t) + 15) & ~static_cast<size_t>(15);
+    return chunk < 32 ? 32 : chunk;
+}
+
+// Total from a container's own footprint, its element count and size, and
+// the bytes it has taken from the heap
+inline MemoryUsage makeMemoryUsage(size_t self, size_t count, size_t elementSize, size_t heapBytes) {
+    size_t payload = count * elementSize;
+    return MemoryUsage(payload, self + heapBytes - payload);
+}
\ No newline at end of file
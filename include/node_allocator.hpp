@@ -0,0 +1,254 @@
+// File: include/node_allocator.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "memory_usage.hpp"
+#include "tagged_stack.hpp"
+
+// Caching allocator for container nodes, after Bonwick's magazine design.
+// Requests are rounded up to a 16-byte size class, so node types of the same
+// rounded size share one pool whatever container they belong to. Each thread
+// keeps two magazines (small stacks of free blocks) per class and serves
+// allocate/deallocate from them without any synchronisation. Only when both
+// are empty, or both full, does it trade a whole magazine with the class's
+// depot, a lock-free stack shared by all threads. A node allocated on one
+// thread and freed on another (producer/consumer handoff) simply lands in the
+// freeing thread's magazine and travels back through the depot in bulk.
+//
+// Blocks are carved from slabs and never returned to the system; freed nodes
+// stay cached for reuse. Requests larger than MAX_SIZE go straight to
+// ::operator new.
+class NodeAllocator {
+public:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_SIZE = 256;
+    static constexpr size_t CLASSES = MAX_SIZE / GRANULE;
+    static constexpr size_t MAGAZINE = 32;
+
+private:
+    struct Magazine {
+        std::atomic<Magazine*> next;
+        Magazine* registered;   // every magazine ever made, so leak checkers can see them
+        size_t count;
+        void* items[MAGAZINE];
+    };
+
+    // Magazines are never freed, so reading next from one that another
+    // thread just popped is harmless, as TaggedStack requires
+    using MagazineStack = TaggedStack<Magazine>;
+
+    struct SizeClass {
+        MagazineStack full;    // magazines holding at least one free block
+        MagazineStack empty;   // spare magazines with no blocks
+    };
+
+    struct Depot {
+        SizeClass classes[CLASSES];
+        std::atomic<size_t> slabBytes{0};
+        std::atomic<Magazine*> registry{nullptr};   // the depot stacks hide pointers behind tags
+
+        // Blocks freed after their thread's cache was torn down (during thread
+        // or process exit) are kept here, linked through their first word
+        std::mutex orphanMutex;
+        void* orphans[CLASSES] = {};
+    };
+
+    struct ThreadCache {
+        Magazine* loaded[CLASSES] = {};
+        Magazine* previous[CLASSES] = {};
+
+        // Hands every magazine, partly filled or not, back to the depot
+        ~ThreadCache() {
+            Depot& d = depot();
+            for (size_t c = 0; c < CLASSES; ++c) {
+                for (Magazine* m : {loaded[c], previous[c]}) {
+                    if (!m) continue;
+                    if (m->count) d.classes[c].full.push(m);
+                    else d.classes[c].empty.push(m);
+                }
+            }
+            cacheGone = true;
+        }
+    };
+
+    static inline thread_local bool cacheGone = false;
+
+    // Never destroyed, so containers that outlive main() can still free nodes
+    static Depot& depot() {
+        static Depot* instance = new Depot();
+        return *instance;
+    }
+
+    static ThreadCache* cache() {
+        if (cacheGone) return nullptr;
+        thread_local ThreadCache local;
+        return &local;
+    }
+
+    static size_t classOf(size_t bytes) { return bytes ? (bytes - 1) / GRANULE : 0; }
+    static size_t classBytes(size_t c) { return (c + 1) * GRANULE; }
+
+    static Magazine* spareMagazine(SizeClass& sc) {
+        Magazine* m = sc.empty.pop();
+        if (!m) {
+            m = new Magazine();
+            std::atomic<Magazine*>& registry = depot().registry;
+            m->registered = registry.load(std::memory_order_relaxed);
+            while (!registry.compare_exchange_weak(m->registered, m, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {}
+        }
+        m->count = 0;
+        return m;
+    }
+
+    // Fills an empty magazine with fresh blocks cut from one slab
+    static void carve(size_t c, Magazine* m) {
+        size_t bytes = classBytes(c);
+        char* slab = static_cast<char*>(::operator new(bytes * MAGAZINE));
+        depot().slabBytes.fetch_add(bytes * MAGAZINE, std::memory_order_relaxed);
+        for (size_t i = 0; i < MAGAZINE; ++i) m->items[i] = slab + (MAGAZINE - 1 - i) * bytes;
+        m->count = MAGAZINE;
+    }
+
+    static void* allocateSlow(ThreadCache* tc, size_t c) {
+        Magazine*& loaded = tc->loaded[c];
+        Magazine*& previous = tc->previous[c];
+        if (previous && previous->count) {
+            std::swap(loaded, previous);
+            return loaded->items[--loaded->count];
+        }
+        SizeClass& sc = depot().classes[c];
+        if (Magazine* full = sc.full.pop()) {
+            if (previous) sc.empty.push(previous);
+            previous = loaded;
+            loaded = full;
+        } else {
+            if (!loaded) loaded = spareMagazine(sc);
+            carve(c, loaded);
+        }
+        return loaded->items[--loaded->count];
+    }
+
+    static void deallocateSlow(ThreadCache* tc, size_t c, void* p) {
+        Magazine*& loaded = tc->loaded[c];
+        Magazine*& previous = tc->previous[c];
+        SizeClass& sc = depot().classes[c];
+        if (previous && previous->count < MAGAZINE) {
+            std::swap(loaded, previous);
+        } else {
+            if (previous) sc.full.push(previous);
+            previous = loaded;
+            loaded = spareMagazine(sc);
+        }
+        loaded->items[loaded->count++] = p;
+    }
+
+    static void* allocateOrphan(size_t c) {
+        Depot& d = depot();
+        {
+            std::lock_guard<std::mutex> lock(d.orphanMutex);
+            if (void* p = d.orphans[c]) {
+                d.orphans[c] = *static_cast<void**>(p);
+                return p;
+            }
+        }
+        return ::operator new(classBytes(c));
+    }
+
+    static void deallocateOrphan(size_t c, void* p) {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.orphanMutex);
+        *static_cast<void**>(p) = d.orphans[c];
+        d.orphans[c] = p;
+    }
+
+public:
+    static void* allocate(size_t bytes) {
+        if (bytes > MAX_SIZE) return ::operator new(bytes);
+        size_t c = classOf(bytes);
+        ThreadCache* tc = cache();
+        if (!tc) return allocateOrphan(c);
+        Magazine* loaded = tc->loaded[c];
+        if (loaded && loaded->count) return loaded->items[--loaded->count];
+        return allocateSlow(tc, c);
+    }
+
+    // bytes must be the size passed to allocate()
+    static void deallocate(void* p, size_t bytes) {
+        if (!p) return;
+        if (bytes > MAX_SIZE) {
+            ::operator delete(p);
+            return;
+        }
+        size_t c = classOf(bytes);
+        ThreadCache* tc = cache();
+        if (!tc) {
+            deallocateOrphan(c, p);
+            return;
+        }
+        Magazine* loaded = tc->loaded[c];
+        if (loaded && loaded->count < MAGAZINE) {
+            loaded->items[loaded->count++] = p;
+            return;
+        }
+        deallocateSlow(tc, c, p);
+    }
+
+    // Bytes one node of the given size really occupies
+    static size_t blockBytes(size_t bytes) {
+        return bytes > MAX_SIZE ? heapBlockBytes(bytes) : classBytes(classOf(bytes));
+    }
+
+    // Total bytes ever carved into blocks, across all classes and threads
+    static size_t slab_bytes() {
+        return depot().slabBytes.load(std::memory_order_relaxed);
+    }
+};
+
+// Base for container nodes: routes new/delete of the derived Node through
+// NodeAllocator. Being empty, it adds nothing to the node's size. Define
+// STL_NO_NODE_POOL to fall back to the global allocator.
+struct PooledNode {
+#ifndef STL_NO_NODE_POOL
+    static void* operator new(size_t bytes) { return NodeAllocator::allocate(bytes); }
+    static void operator delete(void* p, size_t bytes) { NodeAllocator::deallocate(p, bytes); }
+
+    // Over-aligned nodes bypass the pool, which only guarantees 16 bytes
+    static void* operator new(size_t bytes, std::align_val_t align) { return ::operator new(bytes, align); }
+    static void operator delete(void* p, size_t, std::align_val_t align) { ::operator delete(p, align); }
+#endif
+};
+
+// What memory_usage() charges per node
+inline size_t nodeBlockBytes(size_t bytes) {
+#ifndef STL_NO_NODE_POOL
+    return NodeAllocator::blockBytes(bytes);
+#else
+    return heapBlockBytes(bytes);
+#endif
+}
+
+// Raw blocks for nodes whose size is only known at run time (skip-list towers,
+// say); deallocation must be given the same byte count
+inline void* nodeAllocate(size_t bytes) {
+#ifndef STL_NO_NODE_POOL
+    return NodeAllocator::allocate(bytes);
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+inline void nodeDeallocate(void* p, size_t bytes) {
+#ifndef STL_NO_NODE_POOL
+    NodeAllocator::deallocate(p, bytes);
+#else
+    (void)bytes;
+    ::operator delete(p);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,358 @@
+// File: include/persistent_map.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#include "compare.hpp"
+#include "epoch.hpp"
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
+// Immutable AVL map with structural sharing. insert/erase leave the original
+// untouched and return a new version that path-copies O(log n) nodes and shares
+// every other node through an atomic reference count. Copying a PersistentMap
+// is O(1), so a snapshot can be handed to any number of readers.
+template <typename K, typename V, typename Compare = std::less<K>>
+class PersistentMap {
+    template <typename, typename, typename> friend class AtomicPersistentMap;
+
+private:
+    struct Node : PooledNode {
+        K key;
+        V value;
+        Node* left;
+        Node* right;
+        int height;
+        size_t count;   // nodes in this subtree, so size() is O(1) on any version
+        std::atomic<size_t> refs;
+
+        template<typename KType, typename VType>
+        Node(KType&& k, VType&& v, Node* l = nullptr, Node* r = nullptr)
+            : key(std::forward<KType>(k)), value(std::forward<VType>(v)),
+              left(l), right(r), height(1), count(1), refs(1) {
+            update(this);
+        }
+    };
+
+    Node* root;
+    Compare comp;
+
+    static int getHeight(const Node* node) { return node ? node->height : 0; }
+    static size_t getCount(const Node* node) { return node ? node->count : 0; }
+
+    static int getBalance(const Node* node) {
+        return node ? getHeight(node->left) - getHeight(node->right) : 0;
+    }
+
+    static void update(Node* node) {
+        node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
+        node->count = 1 + getCount(node->left) + getCount(node->right);
+    }
+
+    static Node* retain(Node* node) {
+        if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    static void release(Node* node) {
+        if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            release(node->left);
+            release(node->right);
+            delete node;
+        }
+    }
+
+    // Builds a path node that adopts the references l and r. If copying the
+    // key or value throws, the references are released so the part of the
+    // new path built below this node is freed rather than leaked.
+    template<typename KType, typename VType>
+    static Node* makeNode(KType&& k, VType&& v, Node* l, Node* r) {
+        try {
+            return new Node(std::forward<KType>(k), std::forward<VType>(v), l, r);
+        } catch (...) {
+            release(l);
+            release(r);
+            throw;
+        }
+    }
+
+    // Returns a node the caller may mutate in place of the child it holds. A
+    // child referenced only by a freshly copied parent is private already.
+    static Node* unique(Node* node) {
+        if (node->refs.load(std::memory_order_acquire) == 1) return node;
+        Node* copy = makeNode(node->key, node->value, retain(node->left), retain(node->right));
+        release(node);
+        return copy;
+    }
+
+    // Rotations only ever touch nodes owned by the version being built
+    static Node* rotateRight(Node* y) {
+        Node* x = unique(y->left);
+        y->left = x->right;
+        x->right = y;
+        update(y);
+        update(x);
+        return x;
+    }
+
+    static Node* rotateLeft(Node* x) {
+        Node* y = unique(x->right);
+        x->right = y->left;
+        y->left = x;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    // Takes ownership of a freshly built path node; if a rotation's copy
+    // throws, the node and everything it owns is released
+    static Node* balance(Node* node) {
+        update(node);
+        int b = getBalance(node);
+        try {
+            if (b > 1) {
+                if (getBalance(node->left) < 0) {
+                    node->left = unique(node->left);
+                    node->left = rotateLeft(node->left);
+                }
+                return rotateRight(node);
+            }
+            if (b < -1) {
+                if (getBalance(node->right) > 0) {
+                    node->right = unique(node->right);
+                    node->right = rotateRight(node->right);
+                }
+                return rotateLeft(node);
+            }
+        } catch (...) {
+            release(node);
+            throw;
+        }
+        return node;
+    }
+
+    template<typename KType, typename VType>
+    Node* insert(Node* node, KType&& key, VType&& value) const {
+        if (!node) return new Node(std::forward<KType>(key), std::forward<VType>(value));
+
+        if (comp(key, node->key)) {
+            Node* l = insert(node->left, std::forward<KType>(key), std::forward<VType>(value));
+            return balance(makeNode(node->key, node->value, l, retain(node->right)));
+        }
+        if (comp(node->key, key)) {
+            Node* r = insert(node->right, std::forward<KType>(key), std::forward<VType>(value));
+            return balance(makeNode(node->key, node->value, retain(node->left), r));
+        }
+        return makeNode(node->key, std::forward<VType>(value), retain(node->left), retain(node->right));
+    }
+
+    // Detaches the minimum of node's subtree into min and returns the rest
+    Node* removeMin(Node* node, Node*& min) const {
+        if (!node->left) {
+            min = node;
+            return retain(node->right);
+        }
+        Node* l = removeMin(node->left, min);
+        return balance(makeNode(node->key, node->value, l, retain(node->right)));
+    }
+
+    // The key must be present; erase() checks first so misses copy nothing
+    template<typename Key>
+    Node* remove(Node* node, const Key& key) const {
+        if (comp(key, node->key)) {
+            Node* l = remove(node->left, key);
+            return balance(makeNode(node->key, node->value, l, retain(node->right)));
+        }
+        if (comp(node->key, key)) {
+            Node* r = remove(node->right, key);
+            return balance(makeNode(node->key, node->value, retain(node->left), r));
+        }
+        if (!node->left) return retain(node->right);
+        if (!node->right) return retain(node->left);
+        Node* min = nullptr;
+        Node* r = removeMin(node->right, min);
+        return balance(makeNode(min->key, min->value, retain(node->left), r));
+    }
+
+    template<typename Key>
+    Node* find(Node* node, const Key& key) const {
+        while (node) {
+            if (comp(key, node->key)) node = node->left;
+            else if (comp(node->key, key)) node = node->right;
+            else return node;
+        }
+        return nullptr;
+    }
+
+    void inorder(const Node* node) const {
+        if (node) {
+            inorder(node->left);
+            std::cout << "{" << node->key << ": " << node->value << "} ";
+            inorder(node->right);
+        }
+    }
+
+    // Adopts an already retained root
+    PersistentMap(Node* r, const Compare& c) : root(r), comp(c) {}
+
+public:
+    PersistentMap() : root(nullptr), comp() {}
+
+    explicit PersistentMap(const Compare& c) : root(nullptr), comp(c) {}
+
+    // Snapshots are cheap: copying shares the whole tree
+    PersistentMap(const PersistentMap& other) : root(retain(other.root)), comp(other.comp) {}
+
+    PersistentMap(PersistentMap&& other) noexcept : root(other.root), comp(std::move(other.comp)) {
+        other.root = nullptr;
+    }
+
+    PersistentMap& operator=(const PersistentMap& other) {
+        if (this != &other) {
+            Node* old = root;
+            root = retain(other.root);
+            comp = other.comp;
+            release(old);
+        }
+        return *this;
+    }
+
+    PersistentMap& operator=(PersistentMap&& other) noexcept {
+        if (this != &other) {
+            release(root);
+            root = other.root;
+            comp = std::move(other.comp);
+            other.root = nullptr;
+        }
+        return *this;
+    }
+
+    // Returns a new version with key mapped to value (replacing any old value)
+    template<typename KType, typename VType>
+    PersistentMap insert(KType&& key, VType&& value) const {
+        if constexpr (is_transparent_v<Compare> || std::is_same_v<std::decay_t<KType>, K>) {
+            return PersistentMap(insert(root, std::forward<KType>(key), std::forward<VType>(value)), comp);
+        } else {
+            K k(std::forward<KType>(key));
+            return PersistentMap(insert(root, std::move(k), std::forward<VType>(value)), comp);
+        }
+    }
+
+    // Returns a new version without key; shares the whole tree if key is absent
+    PersistentMap erase(const K& key) const {
+        if (!find(root, key)) return *this;
+        return PersistentMap(remove(root, key), comp);
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    PersistentMap erase(const Key& key) const {
+        if (!find(root, key)) return *this;
+        return PersistentMap(remove(root, key), comp);
+    }
+
+    const V* find(const K& key) const {
+        Node* node = find(root, key);
+        return node ? &(node->value) : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const V* find(const Key& key) const {
+        Node* node = find(root, key);
+        return node ? &(node->value) : nullptr;
+    }
+
+    bool contains(const K& key) const { return find(root, key) != nullptr; }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const { return find(root, key) != nullptr; }
+
+    size_t size() const { return getCount(root); }
+    bool empty() const { return root == nullptr; }
+
+    // True when both versions are the same tree (e.g. erase of a missing key)
+    bool shares_root(const PersistentMap& other) const { return root == other.root; }
+
+    // Nodes reachable from this version, including ones it shares with others
+    MemoryUsage memory_usage() const {
+        size_t n = size();
+        return makeMemoryUsage(sizeof(*this), n, sizeof(K) + sizeof(V), n * nodeBlockBytes(sizeof(Node)));
+    }
+
+    void print() const {
+        std::cout << "PersistentMap: ";
+        inorder(root);
+        std::cout << "\n";
+    }
+
+    ~PersistentMap() {
+        release(root);
+    }
+};
+
+// A published PersistentMap version. Readers load() a snapshot without taking
+// a lock; writers store() or update() a new version with a single atomic swap.
+// The replaced root's reference is dropped through the epoch domain, so a
+// reader that loaded the old pointer can still retain it safely.
+template <typename K, typename V, typename Compare = std::less<K>>
+class AtomicPersistentMap {
+private:
+    using MapType = PersistentMap<K, V, Compare>;
+    using Node = typename MapType::Node;
+
+    std::atomic<Node*> root;
+    Compare comp;
+
+    static void releaseRoot(void* node) {
+        MapType::release(static_cast<Node*>(node));
+    }
+
+    void retireRoot(Node* old) {
+        if (old) EpochDomain::global().retire(old, &AtomicPersistentMap::releaseRoot);
+    }
+
+public:
+    AtomicPersistentMap() : root(nullptr), comp() {}
+
+    explicit AtomicPersistentMap(const MapType& initial)
+        : root(MapType::retain(initial.root)), comp(initial.comp) {}
+
+    MapType load() const {
+        EpochDomain::Guard guard;
+        Node* r = root.load(std::memory_order_acquire);
+        return MapType(MapType::retain(r), comp);
+    }
+
+    void store(const MapType& version) {
+        Node* old = root.exchange(MapType::retain(version.root), std::memory_order_acq_rel);
+        retireRoot(old);
+    }
+
+    // Publishes fn(current) unless another writer got there first, in which case
+    // fn is re-run on the newer version. Returns the version that was published.
+    template<typename Fn>
+    MapType update(Fn&& fn) {
+        while (true) {
+            MapType current = load();
+            MapType next = fn(current);
+            Node* expected = current.root;
+            Node* desired = MapType::retain(next.root);
+            if (root.compare_exchange_strong(expected, desired, std::memory_order_acq_rel)) {
+                retireRoot(current.root);
+                return next;
+            }
+            MapType::release(desired);
+        }
+    }
+
+    ~AtomicPersistentMap() {
+        MapType::release(root.load(std::memory_order_acquire));
+    }
+
+    AtomicPersistentMap(const AtomicPersistentMap&) = delete;
+    AtomicPersistentMap& operator=(const AtomicPersistentMap&) = delete;
+};
\ No newline at end of file
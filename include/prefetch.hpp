@@ -0,0 +1,19 @@
+// File: include/prefetch.hpp
+#pragma once
+
+#include <cstddef>
+
+// Hints the CPU to start pulling addr into cache. Compiles to nothing where no
+// prefetch intrinsic is available.
+#if defined(__GNUC__) || defined(__clang__)
+#define STL_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define STL_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define STL_PREFETCH(addr) ((void)(addr))
+#endif
+
+// Independent lookups a batched tree search keeps in flight at once. Enough to
+// cover a memory round trip with a few comparisons' worth of work per lane.
+constexpr size_t STL_BATCH_LANES = 16;
\ No newline at end of file
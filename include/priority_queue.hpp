@@ -0,0 +1,290 @@
+// File: include/priority_queue.hpp
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+#include "vector.hpp"
+
+// Implicit D-ary heap stored in a Vector. top() is the element that compares
+// greatest under Compare (std::less gives a max-heap, std::greater a min-heap).
+// A wider D makes the tree shallower and keeps each node's children on one
+// cache line: D = 4 with 16-byte elements fills a 64-byte line.
+template <typename T, typename Compare = std::less<T>, size_t D = 4>
+class PriorityQueue {
+    static_assert(D >= 2, "PriorityQueue arity must be at least 2");
+
+private:
+    Vector<T> heap;
+    Compare comp;
+
+    static size_t parent(size_t i) { return (i - 1) / D; }
+    static size_t firstChild(size_t i) { return D * i + 1; }
+
+    // Moves heap[i] up into place, shifting parents down into the hole
+    void siftUp(size_t i) {
+        T value = std::move(heap[i]);
+        while (i > 0) {
+            size_t p = parent(i);
+            if (!comp(heap[p], value)) break;
+            heap[i] = std::move(heap[p]);
+            i = p;
+        }
+        heap[i] = std::move(value);
+    }
+
+    // Moves heap[i] down into place, shifting the best child up into the hole
+    void siftDown(size_t i) {
+        size_t n = heap.size();
+        T value = std::move(heap[i]);
+        while (true) {
+            size_t first = firstChild(i);
+            if (first >= n) break;
+            size_t last = first + D < n ? first + D : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (comp(heap[best], heap[c])) best = c;
+            }
+            if (!comp(value, heap[best])) break;
+            heap[i] = std::move(heap[best]);
+            i = best;
+        }
+        heap[i] = std::move(value);
+    }
+
+public:
+    PriorityQueue() : heap(), comp() {}
+
+    explicit PriorityQueue(const Compare& c) : heap(), comp(c) {}
+
+    PriorityQueue(PriorityQueue&& other) noexcept
+        : heap(std::move(other.heap)), comp(std::move(other.comp)) {}
+
+    PriorityQueue& operator=(PriorityQueue&& other) noexcept {
+        if (this != &other) {
+            heap = std::move(other.heap);
+            comp = std::move(other.comp);
+        }
+        return *this;
+    }
+
+    // Builds the heap from [first, last) in O(n) with Floyd's bottom-up heapify
+    template<typename It>
+    void heapify(It first, It last) {
+        for (; first != last; ++first) heap.push_back(*first);
+        size_t n = heap.size();
+        if (n < 2) return;
+        for (size_t i = parent(n - 1) + 1; i-- > 0;) {
+            siftDown(i);
+        }
+    }
+
+    template<typename U>
+    void push(U&& value) {
+        heap.push_back(std::forward<U>(value));
+        siftUp(heap.size() - 1);
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        heap.emplace_back(std::forward<Args>(args)...);
+        siftUp(heap.size() - 1);
+    }
+
+    void pop() {
+        if (heap.empty()) return;
+        if (heap.size() > 1) heap[0] = std::move(heap.back());
+        heap.pop_back();
+        if (!heap.empty()) siftDown(0);
+    }
+
+    const T& top() const { return heap[0]; }
+
+    void reserve(size_t n) { heap.reserve(n); }
+    void clear() { heap.clear(); }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    MemoryUsage memory_usage() const {
+        MemoryUsage usage = heap.memory_usage();
+        usage.overhead += sizeof(*this) - sizeof(heap);
+        return usage;
+    }
+
+    void print() const {
+        std::cout << "PriorityQueue (heap order): ";
+        heap.print();
+    }
+
+    // Delete copy constructor and copy assignment
+    PriorityQueue(const PriorityQueue&) = delete;
+    PriorityQueue& operator=(const PriorityQueue&) = delete;
+};
+
+// D-ary heap over dense integer ids in [0, n) with a position index, so the
+// priority of an id already in the queue can be changed in O(log_D n). This is
+// the shape Dijkstra and Prim want: ids are vertices, priorities are distances
+// (use std::greater for a min-queue).
+template <typename P, typename Compare = std::less<P>, size_t D = 4>
+class IndexedPriorityQueue {
+    static_assert(D >= 2, "IndexedPriorityQueue arity must be at least 2");
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    struct Entry {
+        P priority;
+        size_t id;
+    };
+
+    Vector<Entry> heap;
+    Vector<size_t> pos;   // id -> index in heap, npos when absent
+    Compare comp;
+
+    static size_t parent(size_t i) { return (i - 1) / D; }
+    static size_t firstChild(size_t i) { return D * i + 1; }
+
+    void place(size_t i, Entry&& e) {
+        pos[e.id] = i;
+        heap[i] = std::move(e);
+    }
+
+    void siftUp(size_t i) {
+        Entry e = std::move(heap[i]);
+        while (i > 0) {
+            size_t p = parent(i);
+            if (!comp(heap[p].priority, e.priority)) break;
+            place(i, std::move(heap[p]));
+            i = p;
+        }
+        place(i, std::move(e));
+    }
+
+    void siftDown(size_t i) {
+        size_t n = heap.size();
+        Entry e = std::move(heap[i]);
+        while (true) {
+            size_t first = firstChild(i);
+            if (first >= n) break;
+            size_t last = first + D < n ? first + D : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (comp(heap[best].priority, heap[c].priority)) best = c;
+            }
+            if (!comp(e.priority, heap[best].priority)) break;
+            place(i, std::move(heap[best]));
+            i = best;
+        }
+        place(i, std::move(e));
+    }
+
+public:
+    IndexedPriorityQueue() : heap(), pos(), comp() {}
+
+    explicit IndexedPriorityQueue(size_t max_ids, const Compare& c = Compare())
+        : heap(), pos(), comp(c) {
+        pos.resize(max_ids, npos);
+        heap.reserve(max_ids);
+    }
+
+    IndexedPriorityQueue(IndexedPriorityQueue&& other) noexcept
+        : heap(std::move(other.heap)), pos(std::move(other.pos)), comp(std::move(other.comp)) {}
+
+    IndexedPriorityQueue& operator=(IndexedPriorityQueue&& other) noexcept {
+        if (this != &other) {
+            heap = std::move(other.heap);
+            pos = std::move(other.pos);
+            comp = std::move(other.comp);
+        }
+        return *this;
+    }
+
+    bool contains(size_t id) const {
+        return id < pos.size() && pos[id] != npos;
+    }
+
+    // Inserts id, or updates its priority if it is already queued
+    template<typename U>
+    void push(size_t id, U&& priority) {
+        if (id >= pos.size()) pos.resize(id + 1, npos);
+        if (pos[id] != npos) {
+            update(id, std::forward<U>(priority));
+            return;
+        }
+        heap.push_back(Entry{P(std::forward<U>(priority)), id});
+        siftUp(heap.size() - 1);
+    }
+
+    // Moves id towards the top; the new priority must not compare below the
+    // old one. An id that is not queued is pushed instead.
+    template<typename U>
+    void decrease_key(size_t id, U&& priority) {
+        if (!contains(id)) {
+            push(id, std::forward<U>(priority));
+            return;
+        }
+        size_t i = pos[id];
+        heap[i].priority = std::forward<U>(priority);
+        siftUp(i);
+    }
+
+    // Changes the priority of a queued id in either direction. An id that is
+    // not queued is pushed instead.
+    template<typename U>
+    void update(size_t id, U&& priority) {
+        if (!contains(id)) {
+            push(id, std::forward<U>(priority));
+            return;
+        }
+        size_t i = pos[id];
+        bool up = comp(heap[i].priority, priority);
+        heap[i].priority = std::forward<U>(priority);
+        if (up) siftUp(i);
+        else siftDown(i);
+    }
+
+    // id must be queued; check with contains() first
+    const P& priority(size_t id) const { return heap[pos[id]].priority; }
+
+    size_t top() const { return heap[0].id; }
+    const P& top_priority() const { return heap[0].priority; }
+
+    void pop() {
+        if (heap.empty()) return;
+        pos[heap[0].id] = npos;
+        if (heap.size() > 1) heap[0] = std::move(heap.back());
+        heap.pop_back();
+        if (!heap.empty()) siftDown(0);
+    }
+
+    void clear() {
+        for (size_t i = 0; i < heap.size(); ++i) pos[heap[i].id] = npos;
+        heap.clear();
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    // Payload is the priorities; ids and the position index are overhead
+    MemoryUsage memory_usage() const {
+        size_t total = sizeof(*this) - sizeof(heap) - sizeof(pos)
+                     + heap.memory_usage().total() + pos.memory_usage().total();
+        size_t payload = heap.size() * sizeof(P);
+        return MemoryUsage(payload, total - payload);
+    }
+
+    void print() const {
+        std::cout << "IndexedPriorityQueue (heap order): ";
+        for (size_t i = 0; i < heap.size(); ++i)
+            std::cout << heap[i].id << ":" << heap[i].priority << " ";
+        std::cout << "\n";
+    }
+
+    // Delete copy constructor and copy assignment
+    IndexedPriorityQueue(const IndexedPriorityQueue&) = delete;
+    IndexedPriorityQueue& operator=(const IndexedPriorityQueue&) = delete;
+};
\ No newline at end of file
@@ -1,13 +1,19 @@
 // File: include/queue.hpp
 #pragma once
 
+#include <cstddef>
 #include <iostream>
+#include <new>
 #include <utility>
 
+#include "debug.hpp"
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
 template <typename T>
 class Queue {
 private:
-    struct Node {
+    struct Node : PooledNode {
         T data;
         Node* next;
         
@@ -51,6 +57,7 @@ public:
             head = tail = newNode;
         }
         ++sz;
+        TRACE_EVENT(QueuePush, reinterpret_cast<uintptr_t>(this), sz);
     }
     
     void pop() {
@@ -60,6 +67,7 @@ public:
             if (!head) tail = nullptr;
             delete temp;
             --sz;
+            TRACE_EVENT(QueuePop, reinterpret_cast<uintptr_t>(this), sz);
         }
     }
     
@@ -97,6 +105,20 @@ public:
         sz = 0;
     }
     
+    // Deep copy in a single linear pass, front to back
+    Queue clone() const {
+        Queue copy;
+        for (Node* current = head; current; current = current->next) {
+            copy.push(current->data);
+        }
+        return copy;
+    }
+    
+    // One heap block per element
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), sz * nodeBlockBytes(sizeof(Node)));
+    }
+
     void print() const {
         std::cout << "Queue (front to back): ";
         Node* current = head;
@@ -114,4 +136,160 @@ public:
     // Delete copy constructor and copy assignment
     Queue(const Queue&) = delete;
     Queue& operator=(const Queue&) = delete;
+};
+
+// FIFO queue over a power-of-two ring buffer. Unlike Queue it does not
+// allocate per element: push only allocates when the ring is full, and after
+// reserve() a bounded producer/consumer never allocates at all.
+template <typename T>
+class RingQueue {
+private:
+    T* data;
+    size_t cap;    // always zero or a power of two
+    size_t head;
+    size_t sz;
+
+    T& slot(size_t i) { return data[(head + i) & (cap - 1)]; }
+    const T& slot(size_t i) const { return data[(head + i) & (cap - 1)]; }
+
+    // Moves (or copies, if the move may throw) the ring into dest in order,
+    // destroying what it built if one throws; the ring itself is untouched
+    void transfer(T* dest) {
+        size_t built = 0;
+        try {
+            for (; built < sz; ++built)
+                new (dest + built) T(std::move_if_noexcept(slot(built)));
+        } catch (...) {
+            for (size_t i = 0; i < built; ++i) dest[i].~T();
+            throw;
+        }
+    }
+
+    // Builds the ring into a fresh buffer with count extra elements from fill
+    // after the last one. The old buffer is only torn down once everything is
+    // built, so fill may read the queue's own elements and a throw leaves the
+    // queue intact.
+    template<typename Fill>
+    void reallocateWithTail(size_t new_cap, size_t count, Fill&& fill) {
+        T* new_data = reinterpret_cast<T*>(::operator new(sizeof(T) * new_cap));
+        try {
+            fill(new_data + sz);
+            try {
+                transfer(new_data);
+            } catch (...) {
+                for (size_t i = 0; i < count; ++i) new_data[sz + i].~T();
+                throw;
+            }
+        } catch (...) {
+            ::operator delete(new_data);
+            throw;
+        }
+        for (size_t i = 0; i < sz; ++i) slot(i).~T();
+        ::operator delete(data);
+        data = new_data;
+        sz += count;
+        cap = new_cap;
+        head = 0;
+    }
+
+    void reallocate(size_t new_cap) {
+        reallocateWithTail(new_cap, 0, [](T*) {});
+    }
+
+public:
+    RingQueue() : data(nullptr), cap(0), head(0), sz(0) {}
+
+    explicit RingQueue(size_t capacity) : data(nullptr), cap(0), head(0), sz(0) {
+        reserve(capacity);
+    }
+
+    RingQueue(RingQueue&& other) noexcept : data(other.data), cap(other.cap), head(other.head), sz(other.sz) {
+        other.data = nullptr;
+        other.cap = 0;
+        other.head = 0;
+        other.sz = 0;
+    }
+
+    RingQueue& operator=(RingQueue&& other) noexcept {
+        if (this != &other) {
+            clear();
+            ::operator delete(data);
+            data = other.data;
+            cap = other.cap;
+            head = other.head;
+            sz = other.sz;
+            other.data = nullptr;
+            other.cap = 0;
+            other.head = 0;
+            other.sz = 0;
+        }
+        return *this;
+    }
+
+    // Rounds up to a power of two so indexing is a mask, not a division
+    void reserve(size_t n) {
+        if (n <= cap) return;
+        size_t new_cap = cap ? cap : 1;
+        while (new_cap < n) new_cap *= 2;
+        reallocate(new_cap);
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        if (sz == cap) {
+            reallocateWithTail(cap ? cap * 2 : 1, 1, [&](T* p) { new (p) T(std::forward<Args>(args)...); });
+        } else {
+            new (&slot(sz)) T(std::forward<Args>(args)...);
+            ++sz;
+        }
+        TRACE_EVENT(QueuePush, reinterpret_cast<uintptr_t>(this), sz);
+    }
+
+    template<typename U>
+    void push(U&& value) {
+        emplace(std::forward<U>(value));
+    }
+
+    void pop() {
+        if (sz > 0) {
+            slot(0).~T();
+            head = (head + 1) & (cap - 1);
+            --sz;
+            TRACE_EVENT(QueuePop, reinterpret_cast<uintptr_t>(this), sz);
+        }
+    }
+
+    T& front() { return slot(0); }
+    const T& front() const { return slot(0); }
+    T& back() { return slot(sz - 1); }
+    const T& back() const { return slot(sz - 1); }
+
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+    size_t capacity() const { return cap; }
+
+    void clear() {
+        while (sz > 0) pop();
+        head = 0;
+    }
+
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), cap ? heapBlockBytes(cap * sizeof(T)) : 0);
+    }
+
+    void print() const {
+        std::cout << "RingQueue (front to back): ";
+        for (size_t i = 0; i < sz; ++i)
+            std::cout << slot(i) << " ";
+        std::cout << "\n";
+    }
+
+    ~RingQueue() {
+        clear();
+        ::operator delete(data);
+    }
+
+    // Delete copy constructor and copy assignment
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
 };
\ No newline at end of file
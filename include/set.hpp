@@ -1,212 +1,175 @@
 // File: include/set.hpp
 #pragma once
 
+#include <functional>
 #include <iostream>
+#include <type_traits>
 #include <utility>
 
-template <typename T>
+#include "compare.hpp"
+#include "memory_usage.hpp"
+#include "tree.hpp"
+
+// Compare defaults to std::less<T>; a transparent comparator such as
+// std::less<> lets erase/contains take any comparable type directly.
+// Balance picks the rebalancing rule, as for Map.
+template <typename T, typename Compare = std::less<T>, typename Balance = AvlBalance>
 class Set {
 private:
-    struct Node {
+    struct Entry {
         T data;
-        Node* left;
-        Node* right;
-        int height;
         
         template<typename U>
-        Node(U&& val) : data(std::forward<U>(val)), left(nullptr), right(nullptr), height(1) {}
+        explicit Entry(U&& val) : data(std::forward<U>(val)) {}
+        
+        const T& sort_key() const { return data; }
     };
     
-    Node* root;
-    size_t sz;
+    using Tree = BalancedTree<Entry, Compare, Balance>;
+    using Node = typename Tree::Node;
     
-    int getHeight(Node* node) {
-        return node ? node->height : 0;
-    }
+    Tree tree;
     
-    int getBalance(Node* node) {
-        return node ? getHeight(node->left) - getHeight(node->right) : 0;
+    // key is only compared; the node is built from value
+    template<typename Key, typename U>
+    void add(const Key& key, U&& value) {
+        bool inserted = false;
+        tree.insert(key, [&] { return new Node(std::forward<U>(value)); }, inserted);
     }
+
+public:
+    // Owning handle to a node taken out of a Set by extract(). The data may
+    // be modified before the node is inserted into another Set.
+    class node_type : public TreeNodeHandle<Node> {
+    private:
+        friend class Set;
+        explicit node_type(Node* n) : TreeNodeHandle<Node>(n) {}
+        
+    public:
+        node_type() = default;
+        
+        T& value() { return this->node->data; }
+        const T& value() const { return this->node->data; }
+    };
+    
+    Set() : tree() {}
+    
+    explicit Set(const Compare& c) : tree(c) {}
     
-    void updateHeight(Node* node) {
-        if (node) {
-            node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
+    Set(Set&& other) noexcept = default;
+    Set& operator=(Set&& other) noexcept = default;
+    
+    template<typename U>
+    void insert(U&& value) {
+        if constexpr (is_transparent_v<Compare> || std::is_same_v<std::decay_t<U>, T>) {
+            add(value, std::forward<U>(value));
+        } else {
+            // Convert once up front rather than once per comparison on the way down
+            T v(std::forward<U>(value));
+            add(v, std::move(v));
         }
     }
     
-    Node* rotateRight(Node* y) {
-        Node* x = y->left;
-        Node* T2 = x->right;
-        x->right = y;
-        y->left = T2;
-        updateHeight(y);
-        updateHeight(x);
-        return x;
+    void erase(const T& value) {
+        delete tree.detach(value);
     }
     
-    Node* rotateLeft(Node* x) {
-        Node* y = x->right;
-        Node* T2 = y->left;
-        y->left = x;
-        x->right = T2;
-        updateHeight(x);
-        updateHeight(y);
-        return y;
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void erase(const Key& value) {
+        delete tree.detach(value);
     }
     
-    template<typename U>
-    Node* insert(Node* node, U&& value) {
-        if (!node) {
-            ++sz;
-            return new Node(std::forward<U>(value));
-        }
-        
-        if (value < node->data) {
-            node->left = insert(node->left, std::forward<U>(value));
-        } else if (value > node->data) {
-            node->right = insert(node->right, std::forward<U>(value));
-        } else {
-            return node; // Duplicate, don't insert
-        }
-        
-        updateHeight(node);
-        int balance = getBalance(node);
-        
-        if (balance > 1 && value < node->left->data)
-            return rotateRight(node);
-        if (balance < -1 && value > node->right->data)
-            return rotateLeft(node);
-        if (balance > 1 && value > node->left->data) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
-        }
-        if (balance < -1 && value < node->right->data) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
-        }
-        
-        return node;
+    // Takes the node holding value out of the tree without freeing it. The
+    // returned handle owns the node; it is empty if value was not present.
+    node_type extract(const T& value) {
+        return node_type(tree.detach(value));
     }
     
-    Node* findMin(Node* node) {
-        while (node->left) node = node->left;
-        return node;
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    node_type extract(const Key& value) {
+        return node_type(tree.detach(value));
     }
     
-    Node* remove(Node* node, const T& value) {
-        if (!node) return node;
-        
-        if (value < node->data) {
-            node->left = remove(node->left, value);
-        } else if (value > node->data) {
-            node->right = remove(node->right, value);
-        } else {
-            --sz;
-            if (!node->left || !node->right) {
-                Node* temp = node->left ? node->left : node->right;
-                if (!temp) {
-                    temp = node;
-                    node = nullptr;
-                } else {
-                    *node = *temp;
-                }
-                delete temp;
-            } else {
-                Node* temp = findMin(node->right);
-                node->data = temp->data;
-                ++sz; // Compensate for the decrement above
-                node->right = remove(node->right, temp->data);
-            }
-        }
-        
-        if (!node) return node;
-        
-        updateHeight(node);
-        int balance = getBalance(node);
-        
-        if (balance > 1 && getBalance(node->left) >= 0)
-            return rotateRight(node);
-        if (balance > 1 && getBalance(node->left) < 0) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
-        }
-        if (balance < -1 && getBalance(node->right) <= 0)
-            return rotateLeft(node);
-        if (balance < -1 && getBalance(node->right) > 0) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
-        }
-        
-        return node;
+    // Relinks an extracted node with no allocation. Returns false, leaving the
+    // handle still owning the node, if an equal data is already present.
+    bool insert(node_type&& handle) {
+        if (!handle.node) return false;
+        bool inserted = tree.link(handle.node);
+        if (inserted) handle.node = nullptr;
+        return inserted;
     }
     
-    bool find(Node* node, const T& value) const {
-        if (!node) return false;
-        if (node->data == value) return true;
-        return value < node->data ? find(node->left, value) : find(node->right, value);
+    // Moves every node of other whose data is not already here into this
+    // set. Nothing is allocated or copied; duplicates stay in other.
+    void merge(Set& other) {
+        tree.merge(other.tree);
     }
     
-    void inorder(Node* node) const {
-        if (node) {
-            inorder(node->left);
-            std::cout << node->data << " ";
-            inorder(node->right);
-        }
+    bool contains(const T& value) const {
+        return tree.find(value) != nullptr;
     }
     
-    void destroyTree(Node* node) {
-        if (node) {
-            destroyTree(node->left);
-            destroyTree(node->right);
-            delete node;
-        }
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& value) const {
+        return tree.find(value) != nullptr;
     }
-
-public:
-    Set() : root(nullptr), sz(0) {}
     
-    Set(Set&& other) noexcept : root(other.root), sz(other.sz) {
-        other.root = nullptr;
-        other.sz = 0;
+    // Batched contains: out[i] receives contains(values[i]). Interleaves the
+    // tree descents with software prefetching, which pays off once the tree
+    // no longer fits in cache.
+    void contains_batch(const T* values, size_t n, bool* out) const {
+        tree.lookupBatch(values, n, [&](size_t i, Node* node) { out[i] = node != nullptr; });
     }
     
-    Set& operator=(Set&& other) noexcept {
-        if (this != &other) {
-            destroyTree(root);
-            root = other.root;
-            sz = other.sz;
-            other.root = nullptr;
-            other.sz = 0;
-        }
-        return *this;
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    void contains_batch(const Key* values, size_t n, bool* out) const {
+        tree.lookupBatch(values, n, [&](size_t i, Node* node) { out[i] = node != nullptr; });
     }
     
-    template<typename U>
-    void insert(U&& value) {
-        root = insert(root, std::forward<U>(value));
+    // Deep copy that reproduces the tree node-for-node in O(n) with no
+    // comparisons or rebalancing
+    Set clone() const {
+        Set copy(tree.comparator());
+        copy.tree = tree.clone();
+        return copy;
     }
     
-    void erase(const T& value) {
-        root = remove(root, value);
+    // Visits elements in order as fn(value); fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        tree.for_each([&](Node& node) { fn(node.data); });
     }
     
-    bool contains(const T& value) const {
-        return find(root, value);
+    // Smallest and largest elements; the set must not be empty
+    const T& min() const {
+        return tree.first()->data;
+    }
+    
+    const T& max() const {
+        return tree.last()->data;
     }
     
-    size_t size() const { return sz; }
-    bool empty() const { return sz == 0; }
+    size_t size() const { return tree.size(); }
+    bool empty() const { return tree.size() == 0; }
+    
+    // Rotations and rank changes since construction or reset_balance_stats()
+    const TreeStats& balance_stats() const { return tree.stats(); }
+    void reset_balance_stats() { tree.reset_stats(); }
+    
+    // Longest root-to-leaf path; walks every node
+    size_t height() const { return tree.height(); }
+    
+    // One heap block per element
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), size(), sizeof(T), size() * nodeBlockBytes(sizeof(Node)));
+    }
     
     void print() const {
         std::cout << "Set: { ";
-        inorder(root);
+        tree.for_each([](Node& node) { std::cout << node.data << " "; });
         std::cout << "}\n";
     }
     
-    ~Set() {
-        destroyTree(root);
-    }
-    
     // Delete copy constructor and copy assignment
     Set(const Set&) = delete;
     Set& operator=(const Set&) = delete;
@@ -0,0 +1,282 @@
+// File: include/sparse_map.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "memory_usage.hpp"
+#include "vector.hpp"
+
+// Set of small non-negative integer ids (entity or slot indexes, say): a
+// sparse array indexed by id points into a dense, packed array of the ids
+// present. insert, erase and contains are O(1) with no hashing or
+// comparisons, iteration touches only live ids and reads contiguous
+// memory, and erase keeps the dense array packed by moving the last id into
+// the hole, so iteration order is not sorted order.
+//
+// clear() is O(1): each sparse slot records the generation it was written
+// in, and clearing just starts a new generation, so stale slots read as
+// empty without being touched. The sparse array costs 8 bytes per id up to
+// the largest id ever inserted; keep ids dense. Key may be signed, but
+// negative ids are never present: inserting one throws std::out_of_range.
+template <typename Key = uint32_t>
+class SparseSet {
+private:
+    static_assert(std::is_integral_v<Key>, "SparseSet keys are integer ids");
+
+    struct Slot {
+        uint32_t dense;        // position in keys while live
+        uint32_t generation;   // live only when equal to the set's generation
+    };
+
+    Vector<Slot> sparse;
+    Vector<Key> keys;
+    uint32_t generation;
+
+    template <typename V, typename K>
+    friend class SparseMap;
+
+    static size_t slotOf(Key key) { return static_cast<size_t>(key); }
+
+    bool live(size_t slot) const { return slot < sparse.size() && sparse[slot].generation == generation; }
+
+    // Makes room in the sparse array for slot, doubling so a run of rising
+    // ids costs amortized O(1). A negative id casts to a slot of 2^63 or
+    // more, which lands here and is refused before slot + 1 can wrap.
+    void ensureSlot(size_t slot) {
+        if (slot < sparse.size()) return;
+        if (slot >= SIZE_MAX / sizeof(Slot)) throw std::out_of_range("SparseSet: negative or oversized id");
+        size_t grown = sparse.size() * 2;
+        sparse.resize(slot + 1 > grown ? slot + 1 : grown, Slot{0, 0});
+    }
+
+    // Marks key live at the end of keys; the slot must have room and be dead
+    void link(size_t slot, Key key) {
+        if (keys.size() >= UINT32_MAX) throw std::length_error("SparseSet: too many ids");
+        keys.push_back(key);
+        sparse[slot] = Slot{static_cast<uint32_t>(keys.size() - 1), generation};
+    }
+
+    // Unlinks a live key, moving the last key into its place; returns the
+    // position that was filled
+    size_t unlink(size_t slot) {
+        size_t hole = sparse[slot].dense;
+        Key last = keys.back();
+        keys[hole] = last;
+        sparse[slotOf(last)].dense = static_cast<uint32_t>(hole);
+        keys.pop_back();
+        sparse[slot].generation = 0;
+        return hole;
+    }
+
+    void nextGeneration() {
+        if (++generation == 0) {
+            // After 2^32 clears, old slots could match again: wipe them once
+            for (size_t i = 0; i < sparse.size(); ++i) sparse[i].generation = 0;
+            generation = 1;
+        }
+    }
+
+public:
+    SparseSet() : sparse(), keys(), generation(1) {}
+
+    SparseSet(SparseSet&& other) noexcept
+        : sparse(std::move(other.sparse)), keys(std::move(other.keys)), generation(other.generation) {
+        other.generation = 1;
+    }
+
+    SparseSet& operator=(SparseSet&& other) noexcept {
+        if (this != &other) {
+            sparse = std::move(other.sparse);
+            keys = std::move(other.keys);
+            generation = other.generation;
+            other.generation = 1;
+        }
+        return *this;
+    }
+
+    // Returns false if key was already present
+    bool insert(Key key) {
+        size_t slot = slotOf(key);
+        if (live(slot)) return false;
+        ensureSlot(slot);
+        link(slot, key);
+        return true;
+    }
+
+    // Returns false if key was not present
+    bool erase(Key key) {
+        size_t slot = slotOf(key);
+        if (!live(slot)) return false;
+        unlink(slot);
+        return true;
+    }
+
+    bool contains(Key key) const { return live(slotOf(key)); }
+
+    // Forgets every id in O(1)
+    void clear() {
+        keys.clear();
+        nextGeneration();
+    }
+
+    // Room for ids below universe and for count of them, so inserts
+    // up to there never reallocate
+    void reserve(size_t universe, size_t count) {
+        if (universe > sparse.size()) sparse.resize(universe, Slot{0, 0});
+        keys.reserve(count);
+    }
+
+    // Ids in dense (iteration) order
+    Key key_at(size_t i) const { return keys[i]; }
+
+    // Visits ids in dense order as fn(id); fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < keys.size(); ++i) fn(keys[i]);
+    }
+
+    size_t size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+
+    // Payload is the ids; overhead is the sparse array and spare capacity
+    MemoryUsage memory_usage() const {
+        size_t heap = sparse.memory_usage().total() - sizeof(sparse);
+        heap += keys.memory_usage().total() - sizeof(keys);
+        return makeMemoryUsage(sizeof(*this), keys.size(), sizeof(Key), heap);
+    }
+
+    void print() const {
+        std::cout << "SparseSet: { ";
+        for_each([](Key key) { std::cout << key << " "; });
+        std::cout << "}\n";
+    }
+
+    // Delete copy constructor and copy assignment
+    SparseSet(const SparseSet&) = delete;
+    SparseSet& operator=(const SparseSet&) = delete;
+};
+
+// Map from small non-negative integer ids to V, on a SparseSet: values sit
+// packed in a Vector parallel to the dense ids, so find is two array reads
+// and for_each streams through contiguous values, the shape an ECS system
+// wants for a component table. Erasing moves the last value into the hole,
+// so a V* is invalidated by any erase or insert. clear() is O(1) apart from
+// running V's destructors.
+template <typename V, typename Key = uint32_t>
+class SparseMap {
+private:
+    SparseSet<Key> ids;
+    Vector<V> values;   // values[i] belongs to ids.keys[i]
+
+    // Adds a value for a key known to be absent
+    template<typename... Args>
+    V& add(size_t slot, Key key, Args&&... args) {
+        ids.ensureSlot(slot);
+        values.emplace_back(std::forward<Args>(args)...);
+        try {
+            ids.link(slot, key);
+        } catch (...) {
+            values.pop_back();
+            throw;
+        }
+        return values.back();
+    }
+
+public:
+    SparseMap() : ids(), values() {}
+
+    SparseMap(SparseMap&& other) noexcept = default;
+    SparseMap& operator=(SparseMap&& other) noexcept = default;
+
+    // Inserts or overwrites
+    template<typename VType>
+    void insert(Key key, VType&& value) {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        if (ids.live(slot)) values[ids.sparse[slot].dense] = std::forward<VType>(value);
+        else add(slot, key, std::forward<VType>(value));
+    }
+
+    template<typename... Args>
+    V& emplace(Key key, Args&&... args) {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        if (ids.live(slot)) {
+            V& value = values[ids.sparse[slot].dense];
+            value = V(std::forward<Args>(args)...);
+            return value;
+        }
+        return add(slot, key, std::forward<Args>(args)...);
+    }
+
+    void erase(Key key) {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        if (!ids.live(slot)) return;
+        size_t hole = ids.unlink(slot);
+        if (hole != values.size() - 1) values[hole] = std::move(values.back());
+        values.pop_back();
+    }
+
+    V* find(Key key) {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        return ids.live(slot) ? &values[ids.sparse[slot].dense] : nullptr;
+    }
+
+    const V* find(Key key) const {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        return ids.live(slot) ? &values[ids.sparse[slot].dense] : nullptr;
+    }
+
+    bool contains(Key key) const { return ids.contains(key); }
+
+    V& operator[](Key key) {
+        size_t slot = SparseSet<Key>::slotOf(key);
+        if (ids.live(slot)) return values[ids.sparse[slot].dense];
+        return add(slot, key);
+    }
+
+    void clear() {
+        values.clear();
+        ids.clear();
+    }
+
+    void reserve(size_t universe, size_t count) {
+        ids.reserve(universe, count);
+        values.reserve(count);
+    }
+
+    // Entries in dense (iteration) order
+    Key key_at(size_t i) const { return ids.key_at(i); }
+    V& value_at(size_t i) { return values[i]; }
+    const V& value_at(size_t i) const { return values[i]; }
+
+    // Visits entries in dense order as fn(key, value); fn may not insert or erase
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        for (size_t i = 0; i < values.size(); ++i) fn(ids.key_at(i), values[i]);
+    }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    const SparseSet<Key>& key_set() const { return ids; }
+
+    // Payload is the values; the ids and sparse array are overhead
+    MemoryUsage memory_usage() const {
+        size_t heap = ids.memory_usage().total() - sizeof(ids);
+        heap += values.memory_usage().total() - sizeof(values);
+        return makeMemoryUsage(sizeof(*this), values.size(), sizeof(V), heap);
+    }
+
+    void print() const {
+        std::cout << "SparseMap: ";
+        for (size_t i = 0; i < values.size(); ++i) std::cout << "{" << ids.key_at(i) << ": " << values[i] << "} ";
+        std::cout << "\n";
+    }
+
+    // Delete copy constructor and copy assignment
+    SparseMap(const SparseMap&) = delete;
+    SparseMap& operator=(const SparseMap&) = delete;
+};
\ No newline at end of file
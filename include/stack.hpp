@@ -4,10 +4,13 @@
 #include <iostream>
 #include <utility>
 
+#include "memory_usage.hpp"
+#include "node_allocator.hpp"
+
 template <typename T>
 class Stack {
 private:
-    struct Node {
+    struct Node : PooledNode {
         T data;
         Node* next;
         
@@ -77,6 +80,24 @@ public:
         sz = 0;
     }
     
+    // Deep copy in a single linear pass; nodes are appended top to bottom so
+    // the copy keeps the same order without reversing
+    Stack clone() const {
+        Stack copy;
+        Node** link = &copy.head;
+        for (Node* current = head; current; current = current->next) {
+            *link = new Node(current->data);
+            link = &(*link)->next;
+            ++copy.sz;
+        }
+        return copy;
+    }
+    
+    // One heap block per element
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), sz * nodeBlockBytes(sizeof(Node)));
+    }
+
     void print() const {
         std::cout << "Stack (top to bottom): ";
         Node* current = head;
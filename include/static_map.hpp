@@ -0,0 +1,201 @@
+// File: include/static_map.hpp
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "memory_usage.hpp"
+
+// Fixed-size sorted tables meant to be built by the compiler:
+//
+//     static constexpr auto routes = makeStaticMap<std::string_view, int>({
+//         {"/users", 1}, {"/orders", 2}, {"/health", 3},
+//     });
+//
+// The constructor sorts the entries with a constexpr heapsort, so a table
+// declared constexpr is fully built at compile time and lands in read-only
+// data: nothing runs at startup and nothing is allocated. Lookup is a binary
+// search over the sorted keys, which are stored apart from the values so the
+// search touches only keys. A duplicate key throws, which in a constant
+// expression is a compile error.
+//
+// Keys and values must be default-constructible and usable in constant
+// expressions (integers, enums, std::string_view, simple aggregates...).
+
+// Sorts n keys in place with heapsort, calling swapAt(i, j) for every exchange
+// so callers can permute parallel arrays alongside
+template <typename K, typename Compare, typename SwapAt>
+constexpr void staticHeapSort(K* keys, size_t n, const Compare& comp, SwapAt swapAt) {
+    auto siftDown = [&](size_t root, size_t end) {
+        while (2 * root + 1 < end) {
+            size_t child = 2 * root + 1;
+            if (child + 1 < end && comp(keys[child], keys[child + 1])) ++child;
+            if (!comp(keys[root], keys[child])) return;
+            swapAt(root, child);
+            root = child;
+        }
+    };
+    for (size_t i = n / 2; i-- > 0;) siftDown(i, n);
+    for (size_t end = n; end > 1; --end) {
+        swapAt(0, end - 1);
+        siftDown(0, end - 1);
+    }
+}
+
+// Index of the first key not less than key, or n if there is none
+template <typename K, typename Key, typename Compare>
+constexpr size_t staticLowerBound(const K* keys, size_t n, const Key& key, const Compare& comp) {
+    size_t first = 0;
+    while (n > 0) {
+        size_t half = n / 2;
+        if (comp(keys[first + half], key)) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+template <typename K, typename V, size_t N, typename Compare = std::less<K>>
+class StaticMap {
+    static_assert(N > 0, "StaticMap needs at least one entry");
+
+private:
+    K keys[N];
+    V values[N];
+    Compare comp;
+
+    template<typename Key>
+    constexpr size_t indexOf(const Key& key) const {
+        size_t i = staticLowerBound(keys, N, key, comp);
+        return i < N && !comp(key, keys[i]) ? i : N;
+    }
+
+public:
+    constexpr StaticMap(const std::pair<K, V> (&entries)[N], const Compare& c = Compare())
+        : keys(), values(), comp(c) {
+        for (size_t i = 0; i < N; ++i) {
+            keys[i] = entries[i].first;
+            values[i] = entries[i].second;
+        }
+        staticHeapSort(keys, N, comp, [this](size_t i, size_t j) {
+            std::swap(keys[i], keys[j]);
+            std::swap(values[i], values[j]);
+        });
+        for (size_t i = 1; i < N; ++i) {
+            if (!comp(keys[i - 1], keys[i])) throw std::invalid_argument("StaticMap: duplicate key");
+        }
+    }
+
+    // Returns nullptr if key is absent
+    constexpr const V* find(const K& key) const {
+        size_t i = indexOf(key);
+        return i < N ? &values[i] : nullptr;
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    constexpr const V* find(const Key& key) const {
+        size_t i = indexOf(key);
+        return i < N ? &values[i] : nullptr;
+    }
+
+    constexpr bool contains(const K& key) const { return indexOf(key) < N; }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    constexpr bool contains(const Key& key) const { return indexOf(key) < N; }
+
+    constexpr const V& at(const K& key) const {
+        size_t i = indexOf(key);
+        if (i == N) throw std::out_of_range("StaticMap: key not found");
+        return values[i];
+    }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    constexpr const V& at(const Key& key) const {
+        size_t i = indexOf(key);
+        if (i == N) throw std::out_of_range("StaticMap: key not found");
+        return values[i];
+    }
+
+    // Visits entries in key order
+    template<typename Fn>
+    constexpr void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < N; ++i) fn(keys[i], values[i]);
+    }
+
+    constexpr size_t size() const { return N; }
+
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), N, sizeof(K) + sizeof(V), 0);
+    }
+
+    void print() const {
+        std::cout << "StaticMap: { ";
+        for (size_t i = 0; i < N; ++i) std::cout << keys[i] << ": " << values[i] << " ";
+        std::cout << "}\n";
+    }
+};
+
+template <typename T, size_t N, typename Compare = std::less<T>>
+class StaticSet {
+    static_assert(N > 0, "StaticSet needs at least one element");
+
+private:
+    T keys[N];
+    Compare comp;
+
+    template<typename Key>
+    constexpr bool has(const Key& key) const {
+        size_t i = staticLowerBound(keys, N, key, comp);
+        return i < N && !comp(key, keys[i]);
+    }
+
+public:
+    constexpr StaticSet(const T (&elements)[N], const Compare& c = Compare()) : keys(), comp(c) {
+        for (size_t i = 0; i < N; ++i) keys[i] = elements[i];
+        staticHeapSort(keys, N, comp, [this](size_t i, size_t j) { std::swap(keys[i], keys[j]); });
+        for (size_t i = 1; i < N; ++i) {
+            if (!comp(keys[i - 1], keys[i])) throw std::invalid_argument("StaticSet: duplicate element");
+        }
+    }
+
+    constexpr bool contains(const T& value) const { return has(value); }
+
+    template<typename Key, typename C = Compare, typename = typename C::is_transparent>
+    constexpr bool contains(const Key& key) const { return has(key); }
+
+    // Visits elements in order
+    template<typename Fn>
+    constexpr void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < N; ++i) fn(keys[i]);
+    }
+
+    constexpr size_t size() const { return N; }
+
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), N, sizeof(T), 0);
+    }
+
+    void print() const {
+        std::cout << "StaticSet: { ";
+        for (size_t i = 0; i < N; ++i) std::cout << keys[i] << " ";
+        std::cout << "}\n";
+    }
+};
+
+// Deduce N from a braced list: makeStaticMap<std::string_view, int>({{"a", 1}, {"b", 2}})
+template <typename K, typename V, typename Compare = std::less<K>, size_t N>
+constexpr StaticMap<K, V, N, Compare> makeStaticMap(const std::pair<K, V> (&entries)[N],
+                                                    const Compare& c = Compare()) {
+    return StaticMap<K, V, N, Compare>(entries, c);
+}
+
+template <typename T, typename Compare = std::less<T>, size_t N>
+constexpr StaticSet<T, N, Compare> makeStaticSet(const T (&elements)[N], const Compare& c = Compare()) {
+    return StaticSet<T, N, Compare>(elements, c);
+}
\ No newline at end of file
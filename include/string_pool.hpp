@@ -0,0 +1,343 @@
+// File: include/string_pool.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "map.hpp"
+#include "memory_usage.hpp"
+#include "set.hpp"
+#include "vector.hpp"
+
+// Handle to a string held by a StringPool. Two ids from the same pool are
+// equal exactly when their strings are, so comparing or hashing one is a
+// single integer operation. Ordering is by id (first-interned first), not by
+// string; use InternedLess for string order.
+struct InternedId {
+    uint32_t value;
+
+    friend bool operator==(InternedId a, InternedId b) { return a.value == b.value; }
+    friend bool operator!=(InternedId a, InternedId b) { return a.value != b.value; }
+    friend bool operator<(InternedId a, InternedId b) { return a.value < b.value; }
+    friend bool operator>(InternedId a, InternedId b) { return a.value > b.value; }
+
+    friend std::ostream& operator<<(std::ostream& out, InternedId id) { return out << "#" << id.value; }
+};
+
+template <>
+struct std::hash<InternedId> {
+    size_t operator()(InternedId id) const noexcept { return id.value; }
+};
+
+// Interner: stores each distinct string once and hands out a 32-bit
+// InternedId for it. The characters are copied back to back, NUL-terminated,
+// into 64 KiB arena chunks that never move, so view() and c_str() stay valid
+// for the pool's lifetime and a million short strings cost a million short
+// runs of bytes rather than a million heap blocks. Strings are never removed
+// individually.
+//
+// Not thread-safe: share a pool between threads only behind a lock.
+class StringPool {
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    Vector<char*> chunks;
+    Vector<size_t> chunkSizes;
+    char* cursor;            // free space at the end of the newest chunk
+    size_t remaining;
+
+    Vector<std::string_view> strings;   // indexed by id
+    Vector<uint32_t> hashes;            // low bits of each string's hash
+    uint32_t* table;                    // id + 1, or 0 for an empty slot; at most half full
+    size_t mask;
+    size_t stringBytes;
+
+    static size_t hashOf(std::string_view s) { return std::hash<std::string_view>()(s); }
+
+    char* store(std::string_view s) {
+        size_t need = s.size() + 1;
+        if (need > remaining) {
+            // Oversized strings get a chunk of their own; the current chunk
+            // keeps its space for the strings that follow
+            size_t size = need > CHUNK_BYTES / 4 ? need : CHUNK_BYTES;
+            char* chunk = static_cast<char*>(::operator new(size));
+            chunks.push_back(chunk);
+            chunkSizes.push_back(size);
+            if (size == CHUNK_BYTES) {
+                cursor = chunk;
+                remaining = size;
+            } else {
+                std::memcpy(chunk, s.data(), s.size());
+                chunk[s.size()] = '\0';
+                return chunk;
+            }
+        }
+        char* p = cursor;
+        std::memcpy(p, s.data(), s.size());
+        p[s.size()] = '\0';
+        cursor += need;
+        remaining -= need;
+        return p;
+    }
+
+    // Slot holding s's id, or the empty slot where it would go
+    size_t probe(std::string_view s, size_t h) const {
+        uint32_t tag = static_cast<uint32_t>(h);
+        size_t i = h & mask;
+        while (uint32_t entry = table[i]) {
+            if (hashes[entry - 1] == tag && strings[entry - 1] == s) return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash(size_t n) {
+        uint32_t* old = table;
+        size_t oldSize = mask + 1;
+        table = new uint32_t[n]();
+        mask = n - 1;
+        for (size_t i = 0; i < oldSize; ++i) {
+            if (!old[i]) continue;
+            size_t j = hashOf(strings[old[i] - 1]) & mask;
+            while (table[j]) j = (j + 1) & mask;
+            table[j] = old[i];
+        }
+        delete[] old;
+    }
+
+    void release() {
+        for (size_t i = 0; i < chunks.size(); ++i) ::operator delete(chunks[i]);
+        delete[] table;
+    }
+
+    void swapWith(StringPool& other) noexcept {
+        std::swap(chunks, other.chunks);
+        std::swap(chunkSizes, other.chunkSizes);
+        std::swap(cursor, other.cursor);
+        std::swap(remaining, other.remaining);
+        std::swap(strings, other.strings);
+        std::swap(hashes, other.hashes);
+        std::swap(table, other.table);
+        std::swap(mask, other.mask);
+        std::swap(stringBytes, other.stringBytes);
+    }
+
+public:
+    StringPool()
+        : chunks(), chunkSizes(), cursor(nullptr), remaining(0), strings(), hashes(), table(new uint32_t[16]()),
+          mask(15), stringBytes(0) {}
+
+    // The source is left an empty pool with a table of its own, so it stays
+    // usable; that allocation is why these are not noexcept
+    StringPool(StringPool&& other) : StringPool() {
+        swapWith(other);
+    }
+
+    StringPool& operator=(StringPool&& other) {
+        if (this != &other) {
+            StringPool fresh;
+            swapWith(other);
+            other.swapWith(fresh);   // fresh takes this pool's old strings with it
+        }
+        return *this;
+    }
+
+    // Id of s, adding a copy of it if it is new
+    InternedId intern(std::string_view s) {
+        size_t h = hashOf(s);
+        size_t i = probe(s, h);
+        if (table[i]) return InternedId{table[i] - 1};
+        if (strings.size() >= UINT32_MAX - 1) throw std::length_error("StringPool: out of ids");
+        char* copy = store(s);
+        strings.push_back(std::string_view(copy, s.size()));
+        hashes.push_back(static_cast<uint32_t>(h));
+        stringBytes += s.size();
+        table[i] = static_cast<uint32_t>(strings.size());
+        if (strings.size() * 2 > mask + 1) rehash((mask + 1) * 2);
+        return InternedId{static_cast<uint32_t>(strings.size() - 1)};
+    }
+
+    // Id of s if it has been interned; never adds it
+    std::optional<InternedId> find(std::string_view s) const {
+        uint32_t entry = table[probe(s, hashOf(s))];
+        if (!entry) return std::nullopt;
+        return InternedId{entry - 1};
+    }
+
+    bool contains(std::string_view s) const { return find(s).has_value(); }
+
+    std::string_view view(InternedId id) const { return strings[id.value]; }
+    const char* c_str(InternedId id) const { return strings[id.value].data(); }
+
+    size_t size() const { return strings.size(); }
+    bool empty() const { return strings.empty(); }
+
+    // Total length of the distinct strings held
+    size_t string_bytes() const { return stringBytes; }
+
+    // Payload is the characters; overhead is the terminators, unused arena
+    // space, the id-to-string table and the hash index
+    MemoryUsage memory_usage() const {
+        size_t heap = heapBlockBytes((mask + 1) * sizeof(uint32_t));
+        heap += strings.memory_usage().total() - sizeof(strings);
+        heap += hashes.memory_usage().total() - sizeof(hashes);
+        heap += chunks.memory_usage().total() - sizeof(chunks);
+        heap += chunkSizes.memory_usage().total() - sizeof(chunkSizes);
+        for (size_t i = 0; i < chunkSizes.size(); ++i) heap += heapBlockBytes(chunkSizes[i]);
+        return makeMemoryUsage(sizeof(*this), stringBytes, 1, heap);
+    }
+
+    void print() const {
+        std::cout << "StringPool: ";
+        for (size_t i = 0; i < strings.size(); ++i) std::cout << "#" << i << "=\"" << strings[i] << "\" ";
+        std::cout << "\n";
+    }
+
+    ~StringPool() {
+        release();
+    }
+
+    // Delete copy constructor and copy assignment
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+};
+
+// Orders ids by their strings, for Map/Set<InternedId, ..., InternedLess>
+// that must iterate alphabetically
+struct InternedLess {
+    const StringPool* pool;
+
+    bool operator()(InternedId a, InternedId b) const {
+        return a != b && pool->view(a) < pool->view(b);
+    }
+};
+
+// Map keyed by strings that stores each key as an InternedId from a shared
+// pool: a node holds 4 bytes of key instead of a std::string, key
+// comparisons are integer comparisons, and many maps with overlapping keys
+// share one copy of each. Lookups by string hash the string once to find its
+// id and never add to the pool. Iteration is in id order, which is the
+// order the strings were first interned.
+//
+// The pool must outlive the map. memory_usage() covers the map alone, since
+// the pool is shared.
+template <typename V>
+class InternedMap {
+private:
+    StringPool* strings;
+    Map<InternedId, V> map;
+
+public:
+    explicit InternedMap(StringPool& pool) : strings(&pool), map() {}
+
+    InternedMap(InternedMap&& other) noexcept = default;
+    InternedMap& operator=(InternedMap&& other) noexcept = default;
+
+    template<typename VType>
+    void insert(std::string_view key, VType&& value) {
+        map.insert(strings->intern(key), std::forward<VType>(value));
+    }
+
+    template<typename VType>
+    void insert(InternedId key, VType&& value) {
+        map.insert(key, std::forward<VType>(value));
+    }
+
+    void erase(std::string_view key) {
+        if (std::optional<InternedId> id = strings->find(key)) map.erase(*id);
+    }
+
+    void erase(InternedId key) { map.erase(key); }
+
+    V* find(std::string_view key) {
+        std::optional<InternedId> id = strings->find(key);
+        return id ? map.find(*id) : nullptr;
+    }
+
+    const V* find(std::string_view key) const {
+        std::optional<InternedId> id = strings->find(key);
+        return id ? map.find(*id) : nullptr;
+    }
+
+    V* find(InternedId key) { return map.find(key); }
+    const V* find(InternedId key) const { return map.find(key); }
+
+    bool contains(std::string_view key) const { return find(key) != nullptr; }
+    bool contains(InternedId key) const { return map.contains(key); }
+
+    V& operator[](std::string_view key) { return map[strings->intern(key)]; }
+
+    // Visits entries as fn(key, value), key being a std::string_view into the pool
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        map.for_each([&](InternedId id, V& value) { fn(strings->view(id), value); });
+    }
+
+    size_t size() const { return map.size(); }
+    bool empty() const { return map.empty(); }
+    StringPool& pool() const { return *strings; }
+
+    MemoryUsage memory_usage() const { return map.memory_usage(); }
+
+    void print() const {
+        std::cout << "InternedMap: ";
+        map.for_each(
+            [&](InternedId id, const V& value) { std::cout << "{" << strings->view(id) << ": " << value << "} "; });
+        std::cout << "\n";
+    }
+};
+
+// Set of strings stored as InternedIds; see InternedMap
+class InternedSet {
+private:
+    StringPool* strings;
+    Set<InternedId> set;
+
+public:
+    explicit InternedSet(StringPool& pool) : strings(&pool), set() {}
+
+    InternedSet(InternedSet&& other) noexcept = default;
+    InternedSet& operator=(InternedSet&& other) noexcept = default;
+
+    void insert(std::string_view value) { set.insert(strings->intern(value)); }
+    void insert(InternedId value) { set.insert(value); }
+
+    void erase(std::string_view value) {
+        if (std::optional<InternedId> id = strings->find(value)) set.erase(*id);
+    }
+
+    void erase(InternedId value) { set.erase(value); }
+
+    bool contains(std::string_view value) const {
+        std::optional<InternedId> id = strings->find(value);
+        return id && set.contains(*id);
+    }
+
+    bool contains(InternedId value) const { return set.contains(value); }
+
+    // Visits elements as fn(std::string_view) in id order
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        set.for_each([&](InternedId id) { fn(strings->view(id)); });
+    }
+
+    size_t size() const { return set.size(); }
+    bool empty() const { return set.empty(); }
+    StringPool& pool() const { return *strings; }
+
+    MemoryUsage memory_usage() const { return set.memory_usage(); }
+
+    void print() const {
+        std::cout << "InternedSet: ";
+        for_each([](std::string_view s) { std::cout << s << " "; });
+        std::cout << "\n";
+    }
+};
\ No newline at end of file
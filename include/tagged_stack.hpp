@@ -0,0 +1,167 @@
+// File: include/tagged_stack.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define STL_TAGGED_STACK_WIDE 1
+#endif
+
+// Lock-free Treiber stack of caller-owned nodes, each with a
+// std::atomic<Node*> next member. The top pairs the pointer with a
+// modification tag, and every successful push or pop bumps the tag, so a pop
+// that raced with pop/push/pop of the same node fails its CAS (the ABA
+// problem).
+//
+// Where the compiler offers a 16-byte CAS (x86-64 built with -mcx16, which
+// the CMake build adds) the tag is a full 64-bit counter beside the pointer
+// and never wraps in practice. Elsewhere the tag is the 16 bits above a
+// 48-bit pointer in one word, and that is a real limit: a thread preempted
+// between its load and its CAS while others make a multiple of 65536
+// modifications (about a millisecond of contended push/pop) can see the
+// same tag and pointer again and pop a stale next.
+//
+// Nodes must stay readable after being popped: a pop may still read next
+// from a node another thread has just taken. Callers recycle nodes instead
+// of freeing them while the stack is in use.
+template <typename Node>
+class TaggedStack {
+private:
+#ifdef STL_TAGGED_STACK_WIDE
+    // Pointer in the low half, tag in the high half, swapped as one value
+    typedef unsigned __int128 Word __attribute__((__may_alias__));
+
+    struct alignas(16) Top {
+        std::uint64_t ptr;
+        std::uint64_t tag;
+    };
+
+    Top top;
+
+    static Node* pointer(Word word) {
+        return reinterpret_cast<Node*>(static_cast<uintptr_t>(static_cast<std::uint64_t>(word)));
+    }
+
+    static Word pack(Node* n, Word previous) {
+        Word tag = (previous >> 64) + 1;
+        return (tag << 64) | static_cast<std::uint64_t>(reinterpret_cast<uintptr_t>(n));
+    }
+
+    // Reads the halves one at a time. A torn result pairs a tag with a
+    // pointer that was really on top at some point, so following it is as
+    // safe as any stale read, and the CAS that follows rejects it. Both
+    // halves are read with acquire whatever order asks for.
+    Word loadTop(std::memory_order) const {
+        std::uint64_t tag = __atomic_load_n(&top.tag, __ATOMIC_ACQUIRE);
+        std::uint64_t ptr = __atomic_load_n(&top.ptr, __ATOMIC_ACQUIRE);
+        return (Word(tag) << 64) | ptr;
+    }
+
+    // cmpxchg16b is a full barrier, so the orders are always met
+    bool casTop(Word& expected, Word desired, std::memory_order, std::memory_order) {
+        Word seen = __sync_val_compare_and_swap(reinterpret_cast<Word*>(&top), expected, desired);
+        if (seen == expected) return true;
+        expected = seen;
+        return false;
+    }
+#else
+    static constexpr unsigned TAG_SHIFT = 48;
+    static constexpr std::uint64_t PTR_MASK = (std::uint64_t(1) << TAG_SHIFT) - 1;
+
+    using Word = std::uint64_t;
+
+    std::atomic<Word> top;
+
+    static Node* pointer(Word word) {
+        return reinterpret_cast<Node*>(static_cast<uintptr_t>(word & PTR_MASK));
+    }
+
+    static Word pack(Node* n, Word previous) {
+        Word tag = (previous >> TAG_SHIFT) + 1;
+        return (tag << TAG_SHIFT) | static_cast<Word>(reinterpret_cast<uintptr_t>(n));
+    }
+
+    Word loadTop(std::memory_order order) const { return top.load(order); }
+
+    bool casTop(Word& expected, Word desired, std::memory_order success, std::memory_order failure) {
+        return top.compare_exchange_weak(expected, desired, success, failure);
+    }
+#endif
+
+public:
+#ifdef STL_TAGGED_STACK_WIDE
+    TaggedStack() : top{0, 0} {}
+#else
+    TaggedStack() : top(0) {}
+#endif
+
+    void push(Node* n) { push_chain(n, n); }
+
+    // Pushes the chain first -> ... -> last, already linked through next,
+    // with one CAS; first ends up on top
+    void push_chain(Node* first, Node* last) {
+        Word old = loadTop(std::memory_order_relaxed);
+        do {
+            last->next.store(pointer(old), std::memory_order_relaxed);
+        } while (!casTop(old, pack(first, old), std::memory_order_release,
+                                            std::memory_order_relaxed));
+    }
+
+    Node* pop() {
+        Word old = loadTop(std::memory_order_acquire);
+        while (Node* n = pointer(old)) {
+            Node* next = n->next.load(std::memory_order_relaxed);
+            if (casTop(old, pack(next, old), std::memory_order_acquire,
+                                          std::memory_order_acquire))
+                return n;
+        }
+        return nullptr;
+    }
+
+    // Takes up to max nodes from the top as one chain, its last node's next
+    // cleared. last and count receive the chain's end and length.
+    Node* pop_chain(size_t max, Node*& last, size_t& count) {
+        Word old = loadTop(std::memory_order_acquire);
+        while (Node* first = pointer(old)) {
+            // The walk may see nodes being popped and reused under it; the
+            // tag check in the CAS throws such a walk away
+            last = first;
+            size_t n = 1;
+            while (n < max) {
+                Node* next = last->next.load(std::memory_order_relaxed);
+                if (!next) break;
+                last = next;
+                ++n;
+            }
+            Node* rest = last->next.load(std::memory_order_relaxed);
+            if (casTop(old, pack(rest, old), std::memory_order_acquire,
+                                          std::memory_order_acquire)) {
+                last->next.store(nullptr, std::memory_order_relaxed);
+                count = n;
+                return first;
+            }
+        }
+        last = nullptr;
+        count = 0;
+        return nullptr;
+    }
+
+    // Takes every node in one step
+    Node* pop_all() {
+        Word old = loadTop(std::memory_order_relaxed);
+        while (!casTop(old, pack(nullptr, old), std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {}
+        return pointer(old);
+    }
+
+    bool empty() const { return pointer(loadTop(std::memory_order_acquire)) == nullptr; }
+
+    // The top node, for walking the stack while no other thread touches it
+    Node* peek() const { return pointer(loadTop(std::memory_order_acquire)); }
+
+    // Delete copy constructor and copy assignment
+    TaggedStack(const TaggedStack&) = delete;
+    TaggedStack& operator=(const TaggedStack&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,605 @@
+// File: include/tree.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#include "debug.hpp"
+#include "prefetch.hpp"
+#include "node_allocator.hpp"
+
+// Structural work done by a BalancedTree since it was built or last reset.
+// Under AvlBalance a node's rank is its height minus one, so rank_updates
+// counts height changes.
+struct TreeStats {
+    size_t rotations = 0;
+    size_t rank_updates = 0;
+
+    void print() const {
+        std::cout << "TreeStats: " << rotations << " rotations, " << rank_updates << " rank updates\n";
+    }
+};
+
+// Balancing policies for BalancedTree, all in the rank-balanced framework of
+// Haeupler, Sen and Tarjan: every node stores an integer rank, a missing
+// child counts as rank -1, and each policy is a rule on the rank difference
+// between a parent and its children. Rotations relink nodes and leave ranks
+// alone; promotions and demotions are counted separately.
+//
+// A policy supplies two steps, each called on the way back up an update with
+// the side whose subtree just changed. They return the subtree's new root
+// and set more when the node above must look too:
+//   grown(tree, node, right, more)   after an insert below node
+//   shrunk(tree, node, right, more)  after a removal below node
+
+// AVL: rank differences 1 or 2, never 2,2. The shortest trees, so the best
+// for read-heavy use, but a removal may rotate at every level.
+struct AvlBalance {
+    template <typename Tree, typename Node>
+    static Node* grown(Tree& tree, Node* node, bool right, bool& more) {
+        more = false;
+        Node* c = Tree::child(node, right);
+        if (node->rank != c->rank) return node;     // c was a 2-child, now a 1-child
+        Node* s = Tree::child(node, !right);
+        if (node->rank - Tree::rank(s) == 1) {
+            tree.setRank(node, node->rank + 1);
+            more = true;
+            return node;
+        }
+        Node* inner = Tree::child(c, !right);
+        if (c->rank - Tree::rank(inner) == 2) {
+            tree.setRank(node, node->rank - 1);
+            return tree.raise(node, right);
+        }
+        tree.setRank(inner, inner->rank + 1);
+        tree.setRank(c, c->rank - 1);
+        tree.setRank(node, node->rank - 1);
+        Tree::child(node, right) = tree.raise(c, !right);
+        return tree.raise(node, right);
+    }
+
+    template <typename Tree, typename Node>
+    static Node* shrunk(Tree& tree, Node* node, bool right, bool& more) {
+        more = false;
+        Node* s = Tree::child(node, !right);
+        int r = node->rank;
+        int d = r - Tree::rank(Tree::child(node, right));
+        if (d <= 2) {
+            if (d == 2 && r - Tree::rank(s) == 2) {
+                tree.setRank(node, r - 1);
+                more = true;
+            }
+            return node;
+        }
+        // A 3-child: s is a 1-child and takes node's place
+        Node* inner = Tree::child(s, right);
+        Node* outer = Tree::child(s, !right);
+        if (s->rank - Tree::rank(outer) == 1) {
+            if (s->rank - Tree::rank(inner) == 1) {
+                tree.setRank(node, r - 1);
+                tree.setRank(s, s->rank + 1);
+            } else {
+                tree.setRank(node, r - 2);
+                more = true;
+            }
+            return tree.raise(node, !right);
+        }
+        tree.setRank(node, r - 2);
+        tree.setRank(s, s->rank - 1);
+        tree.setRank(inner, inner->rank + 1);
+        more = true;
+        Tree::child(node, !right) = tree.raise(s, right);
+        return tree.raise(node, !right);
+    }
+};
+
+// Weak AVL: rank differences 1 or 2, and every leaf has rank 0. Inserts
+// exactly like AVL, so an insert-only tree is an AVL tree, but a removal
+// rotates at most twice, giving amortized O(1) rebalancing per update.
+struct WavlBalance : AvlBalance {
+    template <typename Tree, typename Node>
+    static Node* shrunk(Tree& tree, Node* node, bool right, bool& more) {
+        more = false;
+        Node* c = Tree::child(node, right);
+        Node* s = Tree::child(node, !right);
+        int r = node->rank;
+        if (r - Tree::rank(c) <= 2) {
+            if (!node->left && !node->right && r > 0) {   // a 2,2 leaf
+                tree.setRank(node, 0);
+                more = true;
+            }
+            return node;
+        }
+        if (r - Tree::rank(s) == 2) {
+            tree.setRank(node, r - 1);
+            more = true;
+            return node;
+        }
+        Node* inner = Tree::child(s, right);
+        Node* outer = Tree::child(s, !right);
+        int sr = s->rank;
+        if (sr - Tree::rank(inner) == 2 && sr - Tree::rank(outer) == 2) {
+            tree.setRank(node, r - 1);
+            tree.setRank(s, sr - 1);
+            more = true;
+            return node;
+        }
+        if (sr - Tree::rank(outer) == 1) {
+            tree.setRank(s, sr + 1);
+            tree.setRank(node, !c && !inner ? 0 : r - 1);
+            return tree.raise(node, !right);
+        }
+        tree.setRank(inner, r);
+        tree.setRank(s, sr - 1);
+        tree.setRank(node, r - 2);
+        Tree::child(node, !right) = tree.raise(s, right);
+        return tree.raise(node, !right);
+    }
+};
+
+// Red-black: rank differences 0 or 1 and no 0-child (red node) has a
+// 0-child; the rank is the black height. Looser than AVL, so lookups go a
+// little deeper, but inserts rotate at most twice and removals at most three
+// times, and the recoloring that remains is amortized O(1).
+struct RedBlackBalance {
+    template <typename Tree, typename Node>
+    static Node* grown(Tree& tree, Node* node, bool right, bool& more) {
+        more = false;
+        Node* c = Tree::child(node, right);
+        if (node->rank != c->rank) return node;
+        if (Tree::rank(c->left) != c->rank && Tree::rank(c->right) != c->rank) {
+            more = true;        // the node above checks whether node is a 0-child
+            return node;
+        }
+        if (Tree::rank(Tree::child(node, !right)) == node->rank) {
+            tree.setRank(node, node->rank + 1);
+            more = true;
+            return node;
+        }
+        if (Tree::rank(Tree::child(c, !right)) == c->rank) Tree::child(node, right) = tree.raise(c, !right);
+        return tree.raise(node, right);
+    }
+
+    template <typename Tree, typename Node>
+    static Node* shrunk(Tree& tree, Node* node, bool right, bool& more) {
+        more = false;
+        if (node->rank - Tree::rank(Tree::child(node, right)) <= 1) return node;
+        Node* s = Tree::child(node, !right);
+        if (s->rank == node->rank) {
+            // Raising a 0-sibling leaves node a 0-child with a 1-sibling, which
+            // the cases below settle without going further up
+            Node* top = tree.raise(node, !right);
+            bool deeper = false;
+            Tree::child(top, right) = shrunk(tree, node, right, deeper);
+            return top;
+        }
+        Node* inner = Tree::child(s, right);
+        Node* outer = Tree::child(s, !right);
+        if (Tree::rank(outer) == s->rank) {
+            tree.setRank(s, s->rank + 1);
+            tree.setRank(node, node->rank - 1);
+            return tree.raise(node, !right);
+        }
+        if (Tree::rank(inner) == s->rank) {
+            tree.setRank(inner, inner->rank + 1);
+            tree.setRank(node, node->rank - 1);
+            Tree::child(node, !right) = tree.raise(s, right);
+            return tree.raise(node, !right);
+        }
+        tree.setRank(node, node->rank - 1);
+        more = true;
+        return node;
+    }
+};
+
+// Node of a BalancedTree: the container's Entry plus links and rank
+template <typename Entry>
+struct TreeNode : PooledNode, Entry {
+    TreeNode* left;
+    TreeNode* right;
+    int rank;
+
+    template<typename... Args>
+    explicit TreeNode(Args&&... args) : Entry(std::forward<Args>(args)...), left(nullptr), right(nullptr), rank(0) {}
+};
+
+// Owning handle to a node taken out of a tree, the shared half of Map's and
+// Set's node_type
+template <typename Node>
+class TreeNodeHandle {
+protected:
+    Node* node;
+
+    explicit TreeNodeHandle(Node* n) : node(n) {}
+
+public:
+    TreeNodeHandle() : node(nullptr) {}
+
+    TreeNodeHandle(TreeNodeHandle&& other) noexcept : node(other.node) {
+        other.node = nullptr;
+    }
+
+    TreeNodeHandle& operator=(TreeNodeHandle&& other) noexcept {
+        if (this != &other) {
+            delete node;
+            node = other.node;
+            other.node = nullptr;
+        }
+        return *this;
+    }
+
+    bool empty() const { return node == nullptr; }
+    explicit operator bool() const { return node != nullptr; }
+
+    ~TreeNodeHandle() {
+        delete node;
+    }
+
+    TreeNodeHandle(const TreeNodeHandle&) = delete;
+    TreeNodeHandle& operator=(const TreeNodeHandle&) = delete;
+};
+
+// The search tree behind Map and Set. Entry is the payload of a node and
+// must provide sort_key(); Compare orders those keys and Balance is one of
+// the policies above. Nodes are relinked, never copied, once built, so a
+// Node* stays valid until its entry is removed.
+template <typename Entry, typename Compare, typename Balance>
+class BalancedTree {
+public:
+    using Node = TreeNode<Entry>;
+
+private:
+    Node* root;
+    size_t sz;
+    Compare comp;
+    TreeStats counters;
+
+    friend Balance;
+    friend AvlBalance;
+
+    static int rank(const Node* node) { return node ? node->rank : -1; }
+    static Node*& child(Node* node, bool right) { return right ? node->right : node->left; }
+
+    void setRank(Node* node, int r) {
+        if (node->rank != r) {
+            node->rank = r;
+            ++counters.rank_updates;
+        }
+    }
+
+    Node* rotateRight(Node* y) {
+        TRACE_EVENT(TreeRotateRight, reinterpret_cast<uintptr_t>(y), sz);
+        ++counters.rotations;
+        Node* x = y->left;
+        y->left = x->right;
+        x->right = y;
+        return x;
+    }
+
+    Node* rotateLeft(Node* x) {
+        TRACE_EVENT(TreeRotateLeft, reinterpret_cast<uintptr_t>(x), sz);
+        ++counters.rotations;
+        Node* y = x->right;
+        x->right = y->left;
+        y->left = x;
+        return y;
+    }
+
+    // Rotates node's child on the given side above it
+    Node* raise(Node* node, bool right) { return right ? rotateLeft(node) : rotateRight(node); }
+
+    // The policy picks rotations from ranks, never by re-comparing key, which
+    // may already have been moved into the new node
+    template<typename Key, typename Make>
+    Node* insert(Node* node, const Key& key, Make& make, Node*& found, bool& more) {
+        if (!node) {
+            found = make();
+            ++sz;
+            more = true;
+            return found;
+        }
+
+        bool right;
+        if (comp(key, node->sort_key())) right = false;
+        else if (comp(node->sort_key(), key)) right = true;
+        else {
+            found = node;
+            return node;
+        }
+
+        Node*& next = child(node, right);
+        next = insert(next, key, make, found, more);
+        return more ? Balance::grown(*this, node, right, more) : node;
+    }
+
+    // Unlinks the smallest node of the subtree into min and returns what remains
+    Node* detachMin(Node* node, Node*& min, bool& more) {
+        if (!node->left) {
+            min = node;
+            more = true;
+            return node->right;
+        }
+        node->left = detachMin(node->left, min, more);
+        return more ? Balance::shrunk(*this, node, false, more) : node;
+    }
+
+    // Unlinks the node matching key into removed (left null if absent)
+    template<typename Key>
+    Node* detach(Node* node, const Key& key, Node*& removed, bool& more) {
+        if (!node) return node;
+
+        bool right;
+        if (comp(key, node->sort_key())) right = false;
+        else if (comp(node->sort_key(), key)) right = true;
+        else {
+            --sz;
+            removed = node;
+            more = true;
+            Node* left = node->left;
+            Node* rest = node->right;
+            int r = node->rank;
+            node->left = node->right = nullptr;
+            node->rank = 0;
+            if (!left) return rest;
+            if (!rest) return left;
+            // The successor takes over node's place and rank
+            Node* min = nullptr;
+            bool shorter = false;
+            rest = detachMin(rest, min, shorter);
+            min->left = left;
+            min->right = rest;
+            min->rank = r;
+            more = false;
+            return shorter ? Balance::shrunk(*this, min, true, more) : min;
+        }
+
+        Node*& next = child(node, right);
+        next = detach(next, key, removed, more);
+        return more ? Balance::shrunk(*this, node, right, more) : node;
+    }
+
+    // Links a detached node into the tree; inserted stays false on a duplicate
+    Node* link(Node* node, Node* fresh, bool& inserted, bool& more) {
+        if (!node) {
+            ++sz;
+            inserted = true;
+            more = true;
+            return fresh;
+        }
+
+        bool right;
+        if (comp(fresh->sort_key(), node->sort_key())) right = false;
+        else if (comp(node->sort_key(), fresh->sort_key())) right = true;
+        else return node;
+
+        Node*& next = child(node, right);
+        next = link(next, fresh, inserted, more);
+        return more ? Balance::grown(*this, node, right, more) : node;
+    }
+
+    // Re-links every node of a detached tree into this one; nodes that collide
+    // go back into other
+    void mergeFrom(Node* node, BalancedTree& other) {
+        if (!node) return;
+        Node* left = node->left;
+        Node* right = node->right;
+        mergeFrom(left, other);
+        mergeFrom(right, other);
+        node->left = node->right = nullptr;
+        node->rank = 0;
+        if (!link(node)) other.link(node);
+    }
+
+    template<typename Fn>
+    static void visit(Node* node, Fn& fn) {
+        if (node) {
+            visit(node->left, fn);
+            fn(*node);
+            visit(node->right, fn);
+        }
+    }
+
+    static size_t heightOf(const Node* node) {
+        if (!node) return 0;
+        size_t l = heightOf(node->left);
+        size_t r = heightOf(node->right);
+        return 1 + (l > r ? l : r);
+    }
+
+    // Copies node's subtree shape-for-shape; frees the partial copy if a copy throws
+    static Node* cloneTree(const Node* node) {
+        if (!node) return nullptr;
+        Node* copy = new Node(static_cast<const Entry&>(*node));
+        copy->rank = node->rank;
+        try {
+            copy->left = cloneTree(node->left);
+            copy->right = cloneTree(node->right);
+        } catch (...) {
+            destroyTree(copy);
+            throw;
+        }
+        return copy;
+    }
+
+    static void destroyTree(Node* node) {
+        if (node) {
+            destroyTree(node->left);
+            destroyTree(node->right);
+            delete node;
+        }
+    }
+
+public:
+    BalancedTree() : root(nullptr), sz(0), comp(), counters() {}
+
+    explicit BalancedTree(const Compare& c) : root(nullptr), sz(0), comp(c), counters() {}
+
+    BalancedTree(BalancedTree&& other) noexcept
+        : root(other.root), sz(other.sz), comp(std::move(other.comp)), counters(other.counters) {
+        other.root = nullptr;
+        other.sz = 0;
+        other.counters = TreeStats();
+    }
+
+    BalancedTree& operator=(BalancedTree&& other) noexcept {
+        if (this != &other) {
+            destroyTree(root);
+            root = other.root;
+            sz = other.sz;
+            comp = std::move(other.comp);
+            counters = other.counters;
+            other.root = nullptr;
+            other.sz = 0;
+            other.counters = TreeStats();
+        }
+        return *this;
+    }
+
+    // Links the node make() returns where key belongs, unless an equal key is
+    // already present. Either way returns the node holding key; inserted
+    // tells which happened.
+    template<typename Key, typename Make>
+    Node* insert(const Key& key, Make&& make, bool& inserted) {
+        Node* found = nullptr;
+        bool more = false;
+        size_t before = sz;
+        root = insert(root, key, make, found, more);
+        inserted = sz != before;
+        return found;
+    }
+
+    // Links a detached node; false, leaving it detached, on a duplicate
+    bool link(Node* fresh) {
+        bool inserted = false;
+        bool more = false;
+        root = link(root, fresh, inserted, more);
+        return inserted;
+    }
+
+    // Unlinks and returns the node matching key, or null if there is none
+    template<typename Key>
+    Node* detach(const Key& key) {
+        Node* removed = nullptr;
+        bool more = false;
+        root = detach(root, key, removed, more);
+        return removed;
+    }
+
+    // Moves every node of other whose key is not already here into this
+    // tree; duplicates stay in other
+    void merge(BalancedTree& other) {
+        if (this == &other) return;
+        Node* nodes = other.root;
+        other.root = nullptr;
+        other.sz = 0;
+        mergeFrom(nodes, other);
+    }
+
+    template<typename Key>
+    Node* find(const Key& key) const {
+        Node* node = root;
+        while (node) {
+            if (comp(key, node->sort_key())) node = node->left;
+            else if (comp(node->sort_key(), key)) node = node->right;
+            else return node;
+        }
+        return nullptr;
+    }
+
+    // Searches for keys[0..n) with STL_BATCH_LANES descents interleaved: each
+    // step advances every lane one level and prefetches the child it lands on,
+    // so the cache misses of different lookups overlap instead of queueing.
+    // A lane that finishes is refilled with the next key straight away.
+    template<typename Key, typename Fn>
+    void lookupBatch(const Key* keys, size_t n, Fn&& onResult) const {
+        Node* node[STL_BATCH_LANES];
+        size_t index[STL_BATCH_LANES];
+        size_t lanes = n < STL_BATCH_LANES ? n : STL_BATCH_LANES;
+        size_t next = 0;
+        for (; next < lanes; ++next) {
+            node[next] = root;
+            index[next] = next;
+        }
+
+        size_t active = lanes;
+        while (active > 0) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                Node* current = node[lane];
+                if (index[lane] == n) continue;   // idle: nothing left to start
+
+                const Key& key = keys[index[lane]];
+                bool done = false;
+                if (!current) {
+                    done = true;
+                } else if (comp(key, current->sort_key())) {
+                    current = current->left;
+                } else if (comp(current->sort_key(), key)) {
+                    current = current->right;
+                } else {
+                    done = true;
+                }
+
+                if (done) {
+                    onResult(index[lane], current);
+                    if (next < n) {
+                        index[lane] = next++;
+                        current = root;
+                    } else {
+                        index[lane] = n;
+                        --active;
+                        continue;
+                    }
+                }
+                if (current) STL_PREFETCH(current);
+                node[lane] = current;
+            }
+        }
+    }
+
+    // Visits nodes in key order as fn(Node&)
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        visit(root, fn);
+    }
+
+    // Smallest and largest nodes; the tree must not be empty
+    Node* first() const {
+        Node* node = root;
+        while (node->left) node = node->left;
+        return node;
+    }
+
+    Node* last() const {
+        Node* node = root;
+        while (node->right) node = node->right;
+        return node;
+    }
+
+    // Deep copy that reproduces the tree node-for-node in O(n) with no
+    // comparisons or rebalancing
+    BalancedTree clone() const {
+        BalancedTree copy(comp);
+        copy.root = cloneTree(root);
+        copy.sz = sz;
+        return copy;
+    }
+
+    size_t size() const { return sz; }
+    const Compare& comparator() const { return comp; }
+
+    // Longest root-to-leaf path in nodes; walks the whole tree
+    size_t height() const { return heightOf(root); }
+
+    const TreeStats& stats() const { return counters; }
+    void reset_stats() { counters = TreeStats(); }
+
+    ~BalancedTree() {
+        destroyTree(root);
+    }
+
+    // Delete copy constructor and copy assignment
+    BalancedTree(const BalancedTree&) = delete;
+    BalancedTree& operator=(const BalancedTree&) = delete;
+};
\ No newline at end of file
@@ -1,10 +1,59 @@
 // File: include/vector.hpp
 #pragma once
 
+#include <algorithm> // for std::rotate
 #include <cstddef> // for size_t
-#include <new>      // for placement new
-#include <utility>  // for std::move, std::forward
+#include <cstring>  // for std::memcpy, std::memmove
+#include <iterator> // for std::distance
+#include <memory>   // for std::allocator, std::construct_at
+#include <utility>  // for std::move, std::forward, std::move_if_noexcept
 #include <iostream>
+#include <type_traits>
+
+#include "debug.hpp"
+#include "memory_usage.hpp"
+
+// True when T can be written to a std::ostream; print() falls back to a
+// placeholder otherwise so Vector<T> still instantiates for any element type.
+template <typename T, typename = void>
+struct is_streamable : std::false_type {};
+
+template <typename T>
+struct is_streamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>>
+    : std::true_type {};
+
+// True when a T can be moved to a new address by copying its bytes and
+// forgetting the original, with no constructor or destructor run. Vector then
+// relocates elements with memcpy/memmove. Trivially copyable types qualify
+// automatically; specialize this for others whose representation does not
+// depend on their own address (a struct owning a heap pointer, say).
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Where a Vector's buffer comes from. A storage policy provides allocate<T>,
+// deallocate<T>, block_bytes (what memory_usage() charges for a block) and
+// remaps: when true, regrow<T> may resize a block keeping its bytes, possibly
+// at a new address, and Vector uses it to grow trivially relocatable
+// elements without copying them. HeapStorage is std::allocator, the one
+// usable during constant evaluation; MappedStorage (mapped_storage.hpp)
+// maps large buffers directly.
+struct HeapStorage {
+    static constexpr bool remaps = false;
+
+    template <typename T>
+    static constexpr T* allocate(size_t n) { return std::allocator<T>().allocate(n); }
+
+    template <typename T>
+    static constexpr void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <typename T>
+    static T* regrow(T*, size_t, size_t) { return nullptr; }
+
+    static size_t block_bytes(size_t bytes) { return heapBlockBytes(bytes); }
+};
 
 // Base interface for polymorphism
 class IContainer {
@@ -13,39 +62,124 @@ public:
     virtual ~IContainer() = default;
 };
 
-template <typename T>
+template <typename T, typename Storage = HeapStorage>
 class Vector : public IContainer {
 private:
     T* data;
     size_t sz;
     size_t cap;
 
-    void reallocate(size_t new_cap) {
-        T* new_data = reinterpret_cast<T*>(::operator new(sizeof(T) * new_cap));
-        for (size_t i = 0; i < sz; ++i) {
-            new (new_data + i) T(std::move(data[i]));
-            data[i].~T();
+    // Elements are built with construct_at, which C++20 permits during
+    // constant evaluation along with HeapStorage's std::allocator
+    constexpr void releaseStorage() {
+        if (data) Storage::template deallocate<T>(data, cap);
+    }
+
+    // Byte-wise relocation is unavailable while constant evaluating
+    static constexpr bool relocateBytes() {
+        return is_trivially_relocatable_v<T> && !std::is_constant_evaluated();
+    }
+
+    // Moves n elements into raw storage at dest, copying instead when T's
+    // move constructor may throw, so a failure leaves every source intact.
+    // Destroys what it built before rethrowing.
+    static constexpr void transfer(T* first, size_t n, T* dest) {
+        size_t built = 0;
+        try {
+            for (; built < n; ++built) std::construct_at(dest + built, std::move_if_noexcept(first[built]));
+        } catch (...) {
+            std::destroy(dest, dest + built);
+            throw;
+        }
+    }
+
+    // Switches to a new buffer of new_cap slots that keeps the current
+    // elements and opens a gap of count slots at index at, which fill(gapStart)
+    // must populate or else clean up after itself and throw. The gap is filled
+    // first (so fill may read the old elements) and the old elements are
+    // destroyed only once everything has been built: if anything throws, the
+    // vector is unchanged (the strong guarantee).
+    template<typename Fill>
+    constexpr void reallocateWithGap(size_t new_cap, size_t at, size_t count, Fill&& fill) {
+        if (!std::is_constant_evaluated()) TRACE_EVENT(VectorReallocate, cap, new_cap);
+        if constexpr (Storage::remaps) {
+            // Plain growth of relocatable elements moves pages, not elements
+            if (relocateBytes() && count == 0 && data) {
+                if (T* grown = Storage::template regrow<T>(data, cap, new_cap)) {
+                    data = grown;
+                    cap = new_cap;
+                    return;
+                }
+            }
+        }
+        T* new_data = Storage::template allocate<T>(new_cap);
+        try {
+            fill(new_data + at);
+        } catch (...) {
+            Storage::template deallocate<T>(new_data, new_cap);
+            throw;
         }
-        ::operator delete(data);
+        if (relocateBytes()) {
+            if (at) std::memcpy(static_cast<void*>(new_data), data, at * sizeof(T));
+            if (sz > at) std::memcpy(static_cast<void*>(new_data + at + count), data + at, (sz - at) * sizeof(T));
+        } else {
+            try {
+                transfer(data, at, new_data);
+                try {
+                    transfer(data + at, sz - at, new_data + at + count);
+                } catch (...) {
+                    std::destroy(new_data, new_data + at);
+                    throw;
+                }
+            } catch (...) {
+                std::destroy(new_data + at, new_data + at + count);
+                Storage::template deallocate<T>(new_data, new_cap);
+                throw;
+            }
+            std::destroy(data, data + sz);
+        }
+        releaseStorage();
         data = new_data;
+        sz += count;
         cap = new_cap;
     }
 
+    constexpr void reallocate(size_t new_cap) {
+        reallocateWithGap(new_cap, sz, 0, [](T*) {});
+    }
+
+    constexpr size_t grownCapacity(size_t needed) const {
+        return needed > cap * 2 ? needed : cap * 2;
+    }
+
+    // Constructs n elements from [first, ...) into raw storage at dest,
+    // destroying them again if one throws
+    template<typename It>
+    static constexpr void constructRange(It first, size_t n, T* dest) {
+        size_t built = 0;
+        try {
+            for (; built < n; ++built, ++first) std::construct_at(dest + built, *first);
+        } catch (...) {
+            std::destroy(dest, dest + built);
+            throw;
+        }
+    }
+
 public:
-    Vector() : data(nullptr), sz(0), cap(0) {}
+    constexpr Vector() : data(nullptr), sz(0), cap(0) {}
 
     // Move constructor
-    Vector(Vector&& other) noexcept : data(other.data), sz(other.sz), cap(other.cap) {
+    constexpr Vector(Vector&& other) noexcept : data(other.data), sz(other.sz), cap(other.cap) {
         other.data = nullptr;
         other.sz = 0;
         other.cap = 0;
     }
 
     // Move assignment
-    Vector& operator=(Vector&& other) noexcept {
+    constexpr Vector& operator=(Vector&& other) noexcept {
         if (this != &other) {
             clear();
-            ::operator delete(data);
+            releaseStorage();
             data = other.data;
             sz = other.sz;
             cap = other.cap;
@@ -57,41 +191,166 @@ public:
     }
 
     // Perfect forwarding push_back - handles all cases including conversions
+    // When full, the new element is built in the new buffer before the old
+    // ones move, so val may refer to an element of this vector
     template<typename U>
-    void push_back(U&& val) {
-        if (sz == cap) reallocate(cap ? cap * 2 : 1);
-        new (data + sz) T(std::forward<U>(val));
-        ++sz;
+    constexpr void push_back(U&& val) {
+        emplace_back(std::forward<U>(val));
+    }
+
+    template<typename... Args>
+    constexpr T& emplace_back(Args&&... args) {
+        if (sz == cap) {
+            if constexpr (Storage::remaps) {
+                if (relocateBytes()) {
+                    // args may refer into the buffer that regrowing moves, so
+                    // build the element aside and relocate its bytes in after
+                    alignas(T) unsigned char slot[sizeof(T)];
+                    T* item = std::construct_at(reinterpret_cast<T*>(slot), std::forward<Args>(args)...);
+                    try {
+                        reallocate(cap ? cap * 2 : 1);
+                    } catch (...) {
+                        std::destroy_at(item);
+                        throw;
+                    }
+                    std::memcpy(static_cast<void*>(data + sz), slot, sizeof(T));
+                    return data[sz++];
+                }
+            }
+            reallocateWithGap(cap ? cap * 2 : 1, sz, 1,
+                              [&](T* slot) { std::construct_at(slot, std::forward<Args>(args)...); });
+            return data[sz - 1];
+        }
+        std::construct_at(data + sz, std::forward<Args>(args)...);
+        return data[sz++];
     }
 
-    void pop_back() {
+    // Inserts [first, last) before index pos. The range must not point into
+    // this vector. All-or-nothing when the vector must grow or T is
+    // trivially relocatable (the tail moves with one memmove and moves back if
+    // an element's construction throws); otherwise the new elements are
+    // appended and rotated into place, which is all-or-nothing as long as
+    // T's move operations do not throw.
+    template<typename It>
+    constexpr void insert(size_t pos, It first, It last) {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n == 0) return;
+        if (sz + n > cap) {
+            reallocateWithGap(grownCapacity(sz + n), pos, n, [&](T* gap) { constructRange(first, n, gap); });
+        } else if (relocateBytes()) {
+            T* gap = data + pos;
+            std::memmove(static_cast<void*>(gap + n), gap, (sz - pos) * sizeof(T));
+            try {
+                constructRange(first, n, gap);
+            } catch (...) {
+                std::memmove(static_cast<void*>(gap), gap + n, (sz - pos) * sizeof(T));
+                throw;
+            }
+            sz += n;
+        } else {
+            constructRange(first, n, data + sz);
+            sz += n;
+            std::rotate(data + pos, data + sz - n, data + sz);
+        }
+    }
+
+    template<typename U>
+    constexpr void insert(size_t pos, U&& value) {
+        if (pos == sz) {
+            emplace_back(std::forward<U>(value));
+            return;
+        }
+        T item(std::forward<U>(value));
+        T* begin = &item;
+        insert(pos, std::make_move_iterator(begin), std::make_move_iterator(begin + 1));
+    }
+
+    // Removes elements [first, last), closing the hole with one memmove when
+    // T is trivially relocatable
+    constexpr void erase(size_t first, size_t last) {
+        if (first >= last) return;
+        size_t n = last - first;
+        if (relocateBytes()) {
+            std::destroy(data + first, data + last);
+            std::memmove(static_cast<void*>(data + first), data + last, (sz - last) * sizeof(T));
+        } else {
+            std::move(data + last, data + sz, data + first);
+            std::destroy(data + sz - n, data + sz);
+        }
+        sz -= n;
+    }
+
+    constexpr void erase(size_t pos) { erase(pos, pos + 1); }
+
+    constexpr void reserve(size_t new_cap) {
+        if (new_cap > cap) reallocate(new_cap);
+    }
+
+    // Grows with copies of value or shrinks from the back
+    constexpr void resize(size_t new_size, const T& value = T()) {
+        if constexpr (Storage::remaps) {
+            if (new_size > cap && relocateBytes()) {
+                T fillValue(value);   // value may live in the buffer that regrowing moves
+                reallocate(new_size);
+                while (sz < new_size) std::construct_at(data + sz++, fillValue);
+                return;
+            }
+        }
+        if (new_size > cap) {
+            size_t n = new_size - sz;
+            reallocateWithGap(new_size, sz, n, [&](T* gap) {
+                size_t built = 0;
+                try {
+                    for (; built < n; ++built) std::construct_at(gap + built, value);
+                } catch (...) {
+                    std::destroy(gap, gap + built);
+                    throw;
+                }
+            });
+        }
+        while (sz < new_size) std::construct_at(data + sz++, value);
+        while (sz > new_size) std::destroy_at(data + --sz);
+    }
+
+    constexpr void pop_back() {
         if (sz > 0) {
             --sz;
-            data[sz].~T();
+            std::destroy_at(data + sz);
         }
     }
 
-    T& operator[](size_t index) { return data[index]; }
-    const T& operator[](size_t index) const { return data[index]; }
+    constexpr T& operator[](size_t index) { return data[index]; }
+    constexpr const T& operator[](size_t index) const { return data[index]; }
+
+    constexpr T& back() { return data[sz - 1]; }
+    constexpr const T& back() const { return data[sz - 1]; }
 
-    size_t size() const { return sz; }
-    size_t capacity() const { return cap; }
+    constexpr size_t size() const { return sz; }
+    constexpr size_t capacity() const { return cap; }
+    constexpr bool empty() const { return sz == 0; }
 
-    void clear() {
+    constexpr void clear() {
         for (size_t i = 0; i < sz; ++i)
-            data[i].~T();
+            std::destroy_at(data + i);
         sz = 0;
     }
 
+    // Unused capacity counts as overhead
+    MemoryUsage memory_usage() const {
+        return makeMemoryUsage(sizeof(*this), sz, sizeof(T), cap ? Storage::block_bytes(cap * sizeof(T)) : 0);
+    }
+
     void print() const override {
         std::cout << "[ ";
-        for (size_t i = 0; i < sz; ++i)
-            std::cout << data[i] << " ";
+        for (size_t i = 0; i < sz; ++i) {
+            if constexpr (is_streamable<T>::value) std::cout << data[i] << " ";
+            else std::cout << "? ";
+        }
         std::cout << "]\n";
     }
 
-    ~Vector() {
+    constexpr ~Vector() {
         clear();
-        ::operator delete(data);
+        releaseStorage();
     }
 };
\ No newline at end of file
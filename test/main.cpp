@@ -4,8 +4,32 @@
 #include "../include/stack.hpp"
 #include "../include/queue.hpp"
 #include "../include/linkedlist.hpp"
+#include "../include/priority_queue.hpp"
+#include "../include/persistent_map.hpp"
+#include "../include/deque.hpp"
+#include "../include/intrusive.hpp"
+#include "../include/async_channel.hpp"
+#include "../include/compact_tree.hpp"
+#include "../include/bloom_filter.hpp"
+#include "../include/node_allocator.hpp"
+#include "../include/static_map.hpp"
+#include "../include/concurrent_ordered_map.hpp"
+#include "../include/debug.hpp"
+#include "../include/lru_cache.hpp"
+#include "../include/art_map.hpp"
+#include "../include/string_pool.hpp"
+#include "../include/bitmap_set.hpp"
+#include "../include/concurrent_stack.hpp"
+#include "../include/mapped_storage.hpp"
+#include "../include/sparse_map.hpp"
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <atomic>
+#include <optional>
+#include <limits>
+#include <sstream>
+#include <thread>
 
 using namespace std;
 
@@ -35,6 +59,96 @@ void testVector() {
     svec.print(); // [ Hello World C++ ]
 }
 
+// Copies throw once the shared budget runs out; the move constructor is not
+// noexcept, so Vector has to copy it when relocating
+struct Fragile {
+    static inline int copiesLeft = 1000;
+    static inline int live = 0;
+    int value;
+    
+    Fragile(int v) : value(v) { ++live; }
+    Fragile(const Fragile& other) : value(other.value) {
+        if (copiesLeft-- <= 0) throw runtime_error("copy failed");
+        ++live;
+    }
+    Fragile(Fragile&& other) : value(other.value) { ++live; }
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) = default;
+    ~Fragile() { --live; }
+};
+
+// Owns a heap buffer but never points into itself, so moving its bytes is safe
+struct Blob {
+    int* payload;
+    
+    explicit Blob(int v) : payload(new int(v)) {}
+    Blob(Blob&& other) noexcept : payload(other.payload) { other.payload = nullptr; }
+    Blob& operator=(Blob&& other) noexcept {
+        swap(payload, other.payload);
+        return *this;
+    }
+    ~Blob() { delete payload; }
+};
+
+template <>
+struct is_trivially_relocatable<Blob> : true_type {};
+
+void testVectorRelocation() {
+    cout << "\n=== TESTING VECTOR RELOCATION AND RANGE INSERT/ERASE ===\n";
+    
+    Vector<int> v;
+    for (int i = 0; i < 6; ++i) v.push_back(i);
+    int extra[] = {100, 101, 102};
+    v.insert(2, extra, extra + 3);
+    v.print(); // [ 0 1 100 101 102 2 3 4 5 ]
+    v.erase(1, 4);
+    v.print(); // [ 0 102 2 3 4 5 ]
+    v.insert(0, -1);
+    v.erase(v.size() - 1);
+    v.print(); // [ -1 0 102 2 3 4 ]
+    
+    // Pushing an element of the vector itself while it has to grow
+    Vector<string> words;
+    words.push_back("first");
+    words.push_back(words[0]);
+    words.push_back(words[1]);
+    words.push_back(words[0]);
+    words.insert(1, string("second"));
+    words.print(); // [ first second first first first ]
+    
+    // A copy failing mid-reallocation leaves the vector as it was
+    {
+        Vector<Fragile> fv;
+        for (int i = 0; i < 4; ++i) fv.emplace_back(i);
+        Fragile::copiesLeft = 2;
+        bool threw = false;
+        try {
+            fv.emplace_back(4);   // full: must copy all four old elements
+        } catch (const runtime_error&) {
+            threw = true;
+        }
+        Fragile::copiesLeft = 1000;
+        cout << "Reallocation threw: " << (threw ? "Yes" : "No") << ", size " << fv.size()
+             << ", capacity " << fv.capacity() << ", values " << fv[0].value << fv[1].value
+             << fv[2].value << fv[3].value << ", live objects " << Fragile::live << "\n";
+        
+        Fragile::copiesLeft = 1;
+        Fragile more[] = {7, 8, 9};
+        try {
+            fv.insert(1, more, more + 3);
+        } catch (const runtime_error&) {
+            cout << "Range insert threw, size still " << fv.size() << "\n";
+        }
+        Fragile::copiesLeft = 1000;
+    }
+    cout << "Fragile objects left after scope: " << Fragile::live << "\n";
+    
+    Vector<Blob> blobs;
+    for (int i = 0; i < 10; ++i) blobs.emplace_back(i * i);
+    blobs.erase(0, 5);
+    cout << "Relocated blobs: " << *blobs[0].payload << " " << *blobs.back().payload << "\n";
+}
+
 void testMap() {
     cout << "\n=== TESTING MAP ===\n";
     
@@ -59,6 +173,37 @@ void testMap() {
     cout << "After erasing orange:\n";
     m.print();
     
+    // Test clone
+    Map<string, int> mc = m.clone();
+    mc.insert("kiwi", 1);
+    cout << "Clone size: " << mc.size() << ", original size: " << m.size() << "\n";
+    
+    // Test node extraction and merge: nodes move between maps without reallocation
+    Map<string, int>::node_type node = mc.extract("kiwi");
+    cout << "Extracted: " << node.key() << " = " << node.value() << "\n";
+    Map<string, int> other;
+    other.insert(std::move(node));
+    other.insert("apple", 100);
+    mc.merge(other);
+    cout << "After merge:\n";
+    mc.print();
+    other.print(); // apple stays: it was already present
+    
+    // Test batched lookup
+    string batchKeys[3] = {"apple", "melon", "grape"};
+    int* batchOut[3];
+    m.find_batch(batchKeys, 3, batchOut);
+    cout << "Batch find: ";
+    for (int i = 0; i < 3; ++i) {
+        if (batchOut[i]) cout << batchKeys[i] << "=" << *batchOut[i] << " ";
+        else cout << batchKeys[i] << "=missing ";
+    }
+    cout << "\n";
+    const Map<string, int>& constMap = m;
+    const int* constOut[3];
+    constMap.find_batch(batchKeys, 3, constOut);
+    cout << "Const batch find matches: " << (constOut[0] == batchOut[0] && constOut[1] == batchOut[1] ? "Yes" : "No") << "\n";
+    
     // Test with move semantics
     Map<int, string> m2;
     m2.insert(1, "One");
@@ -69,6 +214,18 @@ void testMap() {
     cout << "After move:\n";
     m3.print();
     cout << "Original map size: " << m2.size() << "\n";
+    
+    // Transparent comparator: lookups by const char* / string_view build no std::string
+    Map<string, int, std::less<>> tm;
+    tm.insert("alpha", 1);
+    tm.insert("beta", 2);
+    tm.insert("gamma", 3);
+    string_view key = "beta";
+    auto* tv = tm.find(key);
+    if (tv) cout << "Transparent find beta: " << *tv << "\n";
+    cout << "Transparent contains delta: " << (tm.contains("delta") ? "Yes" : "No") << "\n";
+    tm.erase("alpha");
+    tm.print();
 }
 
 void testSet() {
@@ -88,16 +245,43 @@ void testSet() {
     cout << "Contains 10: " << (s.contains(10) ? "Yes" : "No") << "\n";
     cout << "Contains 100: " << (s.contains(100) ? "Yes" : "No") << "\n";
     
+    int probes[4] = {8, 9, 20, 100};
+    bool found[4];
+    s.contains_batch(probes, 4, found);
+    cout << "Batch contains 8 9 20 100: ";
+    for (bool f : found) cout << (f ? "Yes " : "No ");
+    cout << "\n";
+    
     s.erase(10);
     cout << "After erasing 10:\n";
     s.print();
     
+    Set<int> sc = s.clone();
+    sc.erase(8);
+    cout << "Clone: ";
+    sc.print();
+    
+    Set<int> extra;
+    extra.insert(sc.extract(25));
+    extra.insert(30);
+    extra.insert(12);
+    sc.merge(extra);
+    cout << "After merge: ";
+    sc.print();
+    
     Set<string> ss;
     ss.insert("zebra");
     ss.insert("apple");
     ss.insert("banana");
     ss.insert("cherry");
     ss.print(); // Should be sorted
+    
+    Set<string, std::less<>> ts;
+    ts.insert("zebra");
+    ts.insert("apple");
+    cout << "Transparent contains apple: " << (ts.contains(string_view("apple")) ? "Yes" : "No") << "\n";
+    ts.erase("zebra");
+    ts.print();
 }
 
 void testStack() {
@@ -128,6 +312,11 @@ void testStack() {
     cout << "After move:\n";
     sst2.print();
     cout << "Original stack size: " << sst.size() << "\n";
+    
+    Stack<string> sst3 = sst2.clone();
+    sst3.pop();
+    cout << "Clone after pop: ";
+    sst3.print();
 }
 
 void testQueue() {
@@ -153,6 +342,10 @@ void testQueue() {
     sq.push("Task3");
     sq.print();
     
+    Queue<string> sqc = sq.clone();
+    cout << "Clone: ";
+    sqc.print();
+    
     while (!sq.empty()) {
         cout << "Processing: " << sq.front() << "\n";
         sq.pop();
@@ -202,6 +395,379 @@ void testLinkedList() {
     cout << "After move:\n";
     sll2.print();
     cout << "Original list size: " << sll.size() << "\n";
+    
+    LinkedList<string> sll3 = sll2.clone();
+    sll3.push_back("D");
+    sll2.print();
+    sll3.print();
+    
+    // Test splicing: nodes are relinked, not copied
+    sll2.splice_at(1, sll3, 2, 2); // move "B" and "C" from the clone
+    sll2.print();
+    sll3.print();
+    sll2.splice_back(sll3);
+    sll2.print();
+    cout << "Spliced-from list size: " << sll3.size() << "\n";
+}
+
+void testPriorityQueue() {
+    cout << "\n=== TESTING PRIORITY QUEUE ===\n";
+    
+    PriorityQueue<int> pq;
+    pq.push(5);
+    pq.push(1);
+    pq.push(9);
+    pq.emplace(3);
+    cout << "Size: " << pq.size() << ", Top: " << pq.top() << "\n";
+    
+    cout << "Pop order: ";
+    while (!pq.empty()) {
+        cout << pq.top() << " ";
+        pq.pop();
+    }
+    cout << "\n";
+    
+    // Bulk build as a binary min-heap
+    int values[] = {7, 2, 8, 4, 6, 1, 3};
+    PriorityQueue<int, std::greater<int>, 2> minq;
+    minq.heapify(values, values + 7);
+    cout << "Heapified min-heap pop order: ";
+    while (!minq.empty()) {
+        cout << minq.top() << " ";
+        minq.pop();
+    }
+    cout << "\n";
+    
+    // Indexed queue: ids with changeable priorities
+    IndexedPriorityQueue<int, std::greater<int>> ipq(5);
+    ipq.push(0, 50);
+    ipq.push(1, 40);
+    ipq.push(2, 30);
+    ipq.push(3, 20);
+    ipq.decrease_key(0, 10);
+    cout << "Indexed top after decrease_key(0, 10): id " << ipq.top()
+         << " priority " << ipq.top_priority() << "\n";
+    ipq.pop();
+    cout << "Contains id 0 after pop: " << (ipq.contains(0) ? "Yes" : "No") << "\n";
+    ipq.update(3, 45);
+    ipq.update(0, 35);    // popped id: queued again
+    ipq.decrease_key(9, 5);   // never-seen id past the reserved range
+    cout << "Indexed pop order: ";
+    while (!ipq.empty()) {
+        cout << ipq.top() << " ";
+        ipq.pop();
+    }
+    cout << "\n";
+}
+
+void testPersistentMap() {
+    cout << "\n=== TESTING PERSISTENT MAP ===\n";
+    
+    PersistentMap<string, int> v1;
+    v1 = v1.insert("apple", 5).insert("banana", 3).insert("cherry", 8);
+    
+    // Each update returns a new version; older versions stay intact
+    PersistentMap<string, int> v2 = v1.insert("apple", 7).erase("banana");
+    v1.print();
+    v2.print();
+    cout << "v1 size: " << v1.size() << ", v2 size: " << v2.size() << "\n";
+    
+    PersistentMap<string, int> v3 = v2.erase("missing");
+    cout << "Erase of missing key shares tree: " << (v3.shares_root(v2) ? "Yes" : "No") << "\n";
+    
+    // Publish versions to lock-free readers
+    AtomicPersistentMap<string, int> published(v1);
+    PersistentMap<string, int> snapshot = published.load();
+    published.update([](const PersistentMap<string, int>& m) { return m.insert("date", 4); });
+    cout << "Old snapshot has date: " << (snapshot.contains("date") ? "Yes" : "No") << "\n";
+    cout << "New snapshot has date: " << (published.load().contains("date") ? "Yes" : "No") << "\n";
+}
+
+void testDeque() {
+    cout << "\n=== TESTING DEQUE ===\n";
+    
+    Deque<int> d;
+    d.push_back(2);
+    d.push_back(3);
+    d.push_front(1);
+    d.push_front(0);
+    d.print(); // [ 0 1 2 3 ]
+    
+    cout << "Size: " << d.size() << "\n";
+    cout << "Front: " << d.front() << ", Back: " << d.back() << "\n";
+    cout << "Element at index 2: " << d[2] << "\n";
+    
+    // References stay valid while growing at either end
+    int& first = d.front();
+    for (int i = 0; i < 1000; ++i) {
+        d.push_back(i);
+        d.push_front(-i);
+    }
+    cout << "Reference after 2000 pushes: " << first << "\n";
+    
+    while (d.size() > 4) {
+        d.pop_front();
+        d.pop_back();
+    }
+    d.print(); // [ 0 1 2 3 ]
+    
+    Deque<string> sd;
+    sd.push_back("middle");
+    sd.push_front("start");
+    sd.emplace_back("end");
+    Deque<string> sd2 = std::move(sd);
+    cout << "After move:\n";
+    sd2.print();
+    cout << "Original deque size: " << sd.size() << "\n";
+}
+
+// Pooled object that can sit on two lists and in one map at the same time
+struct Job {
+    int id;
+    string name;
+    ListHook runHook;
+    ListHook allHook;
+    MapHook byIdHook;
+    
+    Job(int i, string n) : id(i), name(std::move(n)), runHook(), allHook(), byIdHook() {}
+};
+
+ostream& operator<<(ostream& os, const Job& t) {
+    return os << t.name;
+}
+
+void testIntrusive() {
+    cout << "\n=== TESTING INTRUSIVE CONTAINERS ===\n";
+    
+    Job tasks[4] = {{1, "parse"}, {2, "plan"}, {3, "build"}, {4, "ship"}};
+    
+    IntrusiveList<Job, &Job::runHook> runQueue;
+    IntrusiveList<Job, &Job::allHook> all;
+    IntrusiveMap<int, Job, &Job::id, &Job::byIdHook> byId;
+    for (Job& t : tasks) {
+        all.push_back(t);
+        byId.insert(t);
+    }
+    runQueue.push_back(tasks[2]);
+    runQueue.push_back(tasks[0]);
+    runQueue.push_front(tasks[3]);
+    
+    all.print();
+    runQueue.print();
+    byId.print();
+    
+    // O(1) erase by reference, the object stays on its other containers
+    runQueue.erase(tasks[0]);
+    runQueue.print();
+    cout << "Task 1 still in all: " << (tasks[0].allHook.is_linked() ? "Yes" : "No") << "\n";
+    
+    Job* found = byId.find(3);
+    if (found) cout << "Found id 3: " << found->name << "\n";
+    byId.erase(tasks[1]);
+    byId.print();
+    
+    runQueue.move_to_front(tasks[2]);
+    cout << "Front after move_to_front: " << runQueue.front() << "\n";
+    
+    runQueue.clear();
+    all.clear();
+    byId.clear();
+    cout << "Sizes after clear: " << runQueue.size() << " " << all.size() << " " << byId.size() << "\n";
+}
+
+Task produceNumbers(AsyncChannel<int>& out, int count) {
+    for (int i = 1; i <= count; ++i) co_await out.push(i);
+    out.close();
+}
+
+Task squareNumbers(AsyncChannel<int>& in, AsyncChannel<int>& out) {
+    while (optional<int> v = co_await in.pop()) co_await out.push(*v * *v);
+    out.close();
+}
+
+Task collectNumbers(AsyncChannel<int>& in, Vector<int>& seen) {
+    while (optional<int> v = co_await in.pop()) seen.push_back(*v);
+}
+
+Task sumNumbers(AsyncChannel<int>& in, atomic<long>& total) {
+    while (optional<int> v = co_await in.pop()) total += *v;
+}
+
+void testAsyncChannel() {
+    cout << "\n=== TESTING ASYNC CHANNEL ===\n";
+    
+    // Three-stage pipeline on one thread; capacity 2 forces backpressure
+    Scheduler scheduler;
+    AsyncChannel<int> numbers(scheduler, 2);
+    AsyncChannel<int> squares(scheduler, 0);
+    Vector<int> seen;
+    spawn(scheduler, collectNumbers(squares, seen));
+    spawn(scheduler, squareNumbers(numbers, squares));
+    spawn(scheduler, produceNumbers(numbers, 6));
+    scheduler.run();
+    cout << "Pipeline output: ";
+    seen.print();
+    
+    AsyncChannel<string> mailbox(scheduler, 1);
+    cout << "try_push into empty: " << (mailbox.try_push("hello") ? "Yes" : "No") << "\n";
+    cout << "try_push into full: " << (mailbox.try_push("world") ? "Yes" : "No") << "\n";
+    mailbox.close();
+    cout << "try_push after close: " << (mailbox.try_push("late") ? "Yes" : "No") << "\n";
+    optional<string> first = mailbox.try_pop();
+    cout << "Drained after close: " << (first ? *first : "<none>") << "\n";
+    
+    // Growing the ring while pushing one of its own elements
+    RingQueue<string> ring(1);
+    ring.push(string(32, 'r'));
+    ring.push(ring.front());
+    ring.push(ring.back());
+    cout << "RingQueue self-push: size " << ring.size() << ", capacity " << ring.capacity()
+         << ", back intact " << (ring.back() == string(32, 'r') ? "Yes" : "No") << "\n";
+    
+    // Same channel type across worker threads
+    atomic<long> total(0);
+    {
+        ThreadPoolExecutor pool(2);
+        AsyncChannel<int> work(pool, 16);
+        spawn(pool, sumNumbers(work, total));
+        spawn(pool, sumNumbers(work, total));
+        spawn(pool, produceNumbers(work, 1000));
+        pool.wait_idle();   // the channel must outlive every coroutine using it
+    }
+    cout << "Thread pool sum of 1..1000: " << total << "\n";
+}
+
+void testCompactTree() {
+    cout << "\n=== TESTING COMPACT TREES AND MEMORY USAGE ===\n";
+    
+    CompactSet<int> cs;
+    for (int i = 10; i >= 1; --i) cs.insert(i * 3);
+    cs.print();
+    cout << "Insert duplicate 9: " << (cs.insert(9) ? "Yes" : "No") << "\n";
+    cs.erase(9);
+    cs.erase(30);
+    cout << "Contains 9 after erase: " << (cs.contains(9) ? "Yes" : "No") << "\n";
+    cs.insert(100);   // reuses an erased slot
+    cs.print();
+    
+    // A one-slot pool must still grow
+    CompactSet<int> tiny;
+    tiny.reserve(1);
+    tiny.insert(1);
+    tiny.insert(2);
+    CompactMap<int, int> shrunk;
+    shrunk.insert(1, 10);
+    shrunk.shrink_to_fit();
+    shrunk.insert(2, 20);
+    shrunk.insert(3, 30);
+    cout << "Grown from one slot: set size " << tiny.size() << ", map size " << shrunk.size() << "\n";
+    
+    CompactMap<string, int, less<>> cm;
+    cm.insert("apple", 5);
+    cm.insert("banana", 7);
+    cm["cherry"] = 9;
+    cm.insert("apple", 6);
+    cm.print();
+    int* banana = cm.find(string_view("banana"));
+    cout << "Transparent find banana: " << (banana ? *banana : -1) << "\n";
+    
+    // Same 1000 ints in a pointer-based Set and a CompactSet
+    Set<int> set;
+    CompactSet<int> compact;
+    compact.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+        set.insert(i);
+        compact.insert(i);
+    }
+    MemoryUsage setUsage = set.memory_usage();
+    MemoryUsage compactUsage = compact.memory_usage();
+    cout << "Set<int> bytes per entry: " << setUsage.bytes_per_element(set.size()) << "\n";
+    cout << "CompactSet<int> bytes per entry: " << compactUsage.bytes_per_element(compact.size()) << "\n";
+    
+    Vector<int> vec;
+    vec.reserve(8);
+    vec.push_back(1);
+    cout << "Vector with 1 of 8 slots used: ";
+    vec.memory_usage().print();
+}
+
+void testBloomFilter() {
+    cout << "\n=== TESTING BLOOM-FILTERED SET AND MAP ===\n";
+    
+    BlockedBloomFilter filter(1000, 0.01);
+    for (int i = 0; i < 1000; i += 2) filter.add(i);
+    filter.print();
+    cout << "May contain 10: " << (filter.may_contain(10) ? "Yes" : "No") << "\n";
+    int falsePositives = 0;
+    for (int i = 1; i < 1000; i += 2) falsePositives += filter.may_contain(i);
+    cout << "False positives on 500 absent keys: " << falsePositives << "\n";
+    
+    // Round trip through the persisted form
+    stringstream image;
+    filter.save(image);
+    BlockedBloomFilter restored;
+    cout << "Reloaded: " << (restored.load(image) ? "Yes" : "No")
+         << ", may contain 10: " << (restored.may_contain(10) ? "Yes" : "No") << "\n";
+    
+    // A header claiming 2^58 blocks over a truncated body is rejected
+    string forged = image.str().substr(0, 12);
+    uint64_t forgedHeader[3] = {uint64_t(1) << 58, 7, 0};
+    forged.append(reinterpret_cast<const char*>(forgedHeader), sizeof(forgedHeader));
+    stringstream forgedImage(forged);
+    cout << "Load forged image: " << (restored.load(forgedImage) ? "Yes" : "No")
+         << ", still may contain 10: " << (restored.may_contain(10) ? "Yes" : "No") << "\n";
+    
+    FilteredSet<int> seen(4, 0.01);   // grows its filter past 4 keys
+    for (int i = 0; i < 20; ++i) seen.insert(i * 5);
+    seen.erase(15);
+    cout << "FilteredSet contains 20: " << (seen.contains(20) ? "Yes" : "No") << "\n";
+    cout << "FilteredSet contains 15 after erase: " << (seen.contains(15) ? "Yes" : "No") << "\n";
+    cout << "FilteredSet contains 21: " << (seen.contains(21) ? "Yes" : "No") << "\n";
+    seen.print();
+    FilteredSet<int> taken(std::move(seen));
+    seen.insert(3);
+    cout << "Moved-from FilteredSet contains 3: " << (seen.contains(3) ? "Yes" : "No")
+         << ", moved-to contains 20: " << (taken.contains(20) ? "Yes" : "No") << "\n";
+    
+    FilteredMap<string, int> ages;
+    ages.insert("alice", 31);
+    ages["bob"] = 27;
+    int* bob = ages.find("bob");
+    cout << "FilteredMap bob: " << (bob ? *bob : -1) << ", carol present: "
+         << (ages.contains("carol") ? "Yes" : "No") << "\n";
+}
+
+void testNodeAllocator() {
+    cout << "\n=== TESTING NODE ALLOCATOR ===\n";
+    
+    cout << "Block bytes for 40/48/300-byte nodes: " << NodeAllocator::blockBytes(40) << " "
+         << NodeAllocator::blockBytes(48) << " " << NodeAllocator::blockBytes(300) << "\n";
+    
+    // A freed block is the next one handed out for its size class
+    void* first = NodeAllocator::allocate(40);
+    NodeAllocator::deallocate(first, 40);
+    void* again = NodeAllocator::allocate(48);
+    cout << "Freed block reused by a same-class request: " << (first == again ? "Yes" : "No") << "\n";
+    NodeAllocator::deallocate(again, 48);
+    
+    // Nodes built on one thread and freed on another
+    Queue<int>* handoff = new Queue<int>();
+    for (int i = 0; i < 1000; ++i) handoff->push(i);
+    long sum = 0;
+    thread consumer([&] {
+        while (!handoff->empty()) {
+            sum += handoff->front();
+            handoff->pop();
+        }
+        delete handoff;
+    });
+    consumer.join();
+    cout << "Consumer thread drained sum: " << sum << "\n";
+    
+    Map<int, int> pooled;
+    for (int i = 0; i < 100; ++i) pooled.insert(i, i);
+    cout << "Map<int, int> bytes per entry on pooled nodes: "
+         << pooled.memory_usage().bytes_per_element(pooled.size()) << "\n";
 }
 
 void performanceTest() {
@@ -228,6 +794,586 @@ void performanceTest() {
     cout << "Map with 100 elements - Size: " << big_map.size() << "\n";
 }
 
+// Vector allocates during constant evaluation; the storage must be freed
+// before the evaluation ends, so only the computed result escapes
+constexpr int sumOfPrimesBelow(int limit) {
+    Vector<int> primes;
+    for (int n = 2; n < limit; ++n) {
+        bool prime = true;
+        for (size_t i = 0; i < primes.size() && primes[i] * primes[i] <= n; ++i) {
+            if (n % primes[i] == 0) prime = false;
+        }
+        if (prime) primes.push_back(n);
+    }
+    int sum = 0;
+    for (size_t i = 0; i < primes.size(); ++i) sum += primes[i];
+    return sum;
+}
+
+static constexpr auto httpStatus = makeStaticMap<string_view, int>({
+    {"NotFound", 404}, {"OK", 200}, {"Created", 201},
+    {"BadRequest", 400}, {"InternalError", 500}, {"NoContent", 204},
+});
+
+static constexpr auto keywords = makeStaticSet<string_view>({
+    "while", "if", "return", "for", "else", "break",
+});
+
+void testStaticMap() {
+    cout << "\n=== TESTING CONSTEXPR VECTOR AND STATIC MAP ===\n";
+    
+    static_assert(sumOfPrimesBelow(100) == 1060);
+    static_assert(httpStatus.size() == 6);
+    static_assert(httpStatus.at("Created") == 201);
+    static_assert(!httpStatus.contains("Teapot"));
+    static_assert(keywords.contains("return") && !keywords.contains("goto"));
+    
+    cout << "Sum of primes below 100 (compile time): " << sumOfPrimesBelow(100) << "\n";
+    httpStatus.print();
+    keywords.print();
+    
+    string key = "OK";
+    const int* ok = httpStatus.find(key);
+    cout << "Runtime find OK: " << (ok ? *ok : -1) << "\n";
+    cout << "Runtime find Teapot: " << (httpStatus.find("Teapot") ? "found" : "not found") << "\n";
+    
+    try {
+        httpStatus.at("Teapot");
+    } catch (const out_of_range& e) {
+        cout << "at() on missing key: " << e.what() << "\n";
+    }
+    
+    // Transparent comparator allows lookups by string without conversion
+    constexpr auto ports = makeStaticMap<string_view, int, less<>>({{"http", 80}, {"https", 443}, {"ssh", 22}});
+    cout << "Port for https: " << ports.at(string("https")) << "\n";
+    
+    // Built at runtime too, for tables whose contents are only known then
+    int squares[] = {49, 4, 25, 1, 16, 9, 36};
+    auto squareSet = makeStaticSet(squares);
+    squareSet.print();
+    try {
+        int dup[] = {3, 1, 3};
+        makeStaticSet(dup);
+    } catch (const invalid_argument& e) {
+        cout << "Duplicate rejected: " << e.what() << "\n";
+    }
+    cout << "StaticMap<string_view, int> bytes per entry: "
+         << httpStatus.memory_usage().bytes_per_element(httpStatus.size()) << "\n";
+}
+
+void testConcurrentOrderedMap() {
+    cout << "\n=== TESTING CONCURRENT ORDERED MAP ===\n";
+    
+    ConcurrentOrderedMap<int, string> com;
+    com.insert(30, "thirty");
+    com.insert(10, "ten");
+    com.insert(20, "twenty");
+    cout << "Insert existing key reports new: " << (com.insert(20, "TWENTY") ? "Yes" : "No") << "\n";
+    com.print();
+    optional<string> twenty = com.find(20);
+    cout << "find(20): " << (twenty ? *twenty : "<none>") << "\n";
+    auto lb = com.lower_bound(15);
+    cout << "lower_bound(15): " << (lb ? lb->first : -1) << "\n";
+    cout << "Erase 10: " << (com.erase(10) ? "Yes" : "No") << ", again: " << (com.erase(10) ? "Yes" : "No") << "\n";
+    cout << "Size: " << com.size() << "\n";
+    
+    // Writers on interleaved keys while a reader keeps scanning in order
+    ConcurrentOrderedMap<int, int> shared;
+    const int WRITERS = 4;
+    const int PER_WRITER = 2000;
+    atomic<bool> done(false);
+    atomic<int> disorder(0);
+    Vector<thread> threads;
+    threads.emplace_back([&] {
+        while (!done.load()) {
+            int last = -1;
+            shared.for_each([&](int k, int v) {
+                if (k <= last || v != k * 2) disorder.fetch_add(1);
+                last = k;
+            });
+        }
+    });
+    for (int w = 0; w < WRITERS; ++w) {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < PER_WRITER; ++i) shared.insert(i * WRITERS + w, (i * WRITERS + w) * 2);
+            for (int i = 0; i < PER_WRITER; i += 2) shared.erase(i * WRITERS + w);
+            for (int i = 1; i < PER_WRITER; i += 2) shared.insert(i * WRITERS + w, (i * WRITERS + w) * 2);
+        });
+    }
+    for (size_t i = 1; i < threads.size(); ++i) threads[i].join();
+    done.store(true);
+    threads[0].join();
+    
+    int visited = 0;
+    shared.for_each([&](int, int) { ++visited; });
+    int inRange = 0;
+    shared.for_each_in(100, 200, [&](int, int) { ++inRange; });
+    cout << "Entries after concurrent writes: " << shared.size() << " (visited " << visited << ")\n";
+    cout << "Entries in [100, 200): " << inRange << "\n";
+    cout << "Out-of-order or torn entries seen by the scanner: " << disorder.load() << "\n";
+    
+    // Tower heights are random, so only the payload is reproducible
+    cout << "Quiescent payload: " << shared.memory_usage().payload << " B for " << shared.size() << " entries\n";
+}
+
+void testTracer() {
+    cout << "\n=== TESTING BINARY TRACE BUFFER ===\n";
+    
+    Tracer::clear();
+    Tracer::record(TraceEvent::VectorReallocate, 4, 8);
+    Tracer::record(TraceEvent::QueuePush, 0, 1);
+    thread worker([] {
+        for (int i = 0; i < 10; ++i) Tracer::record(TraceEvent::User, i, i * i);
+    });
+    worker.join();
+    Tracer::set_enabled(false);
+    Tracer::record(TraceEvent::QueuePop, 0, 0);   // dropped
+    Tracer::set_enabled(true);
+    
+    stringstream file;
+    cout << "Saved: " << (Tracer::save(file) ? "Yes" : "No") << "\n";
+    TraceFileHeader header;
+    int userEvents = 0;
+    uint64_t lastSquare = 0;
+    bool loaded = Tracer::load(file, header, [&](const TraceRecord& rec) {
+        if (rec.event == static_cast<uint16_t>(TraceEvent::User)) {
+            ++userEvents;
+            lastSquare = rec.args[1];
+        } else {
+            cout << "  " << traceEventInfo(rec.event).name << " " << traceEventInfo(rec.event).arg0 << "="
+                 << rec.args[0] << " " << traceEventInfo(rec.event).arg1 << "=" << rec.args[1] << "\n";
+        }
+    });
+    cout << "Loaded: " << (loaded ? "Yes" : "No") << ", " << header.count << " records, "
+         << userEvents << " from the worker thread (last arg " << lastSquare << ")\n";
+    
+    // Ring keeps only the newest RING_RECORDS events of a thread
+    Tracer::clear();
+    for (size_t i = 0; i < Tracer::RING_RECORDS + 100; ++i) Tracer::record(TraceEvent::User, i, 0);
+    stringstream wrapped;
+    Tracer::save(wrapped);
+    uint64_t oldest = ~0ULL;
+    Tracer::load(wrapped, header, [&](const TraceRecord& rec) { oldest = min<uint64_t>(oldest, rec.args[0]); });
+    cout << "After wrapping: " << header.count << " records, oldest kept #" << oldest << "\n";
+    
+    stringstream garbage("not a trace");
+    cout << "Load garbage: " << (Tracer::load(garbage, header, [](const TraceRecord&) {}) ? "Yes" : "No") << "\n";
+    Tracer::clear();
+}
+
+void testLruCache() {
+    cout << "\n=== TESTING LRU AND CLOCK CACHES ===\n";
+    
+    LruCache<int, string> lru(CacheCapacity::entries(3));
+    string evicted;
+    lru.set_eviction_callback([&](const int& k, string& v) { evicted += to_string(k) + "=" + v + " "; });
+    lru.put(1, "one");
+    lru.put(2, "two");
+    lru.put(3, "three");
+    lru.get(1);            // 2 is now the least recently used
+    lru.put(4, "four");
+    lru.put(3, "THREE");   // overwrite, no eviction
+    lru.put(5, "five");
+    lru.print();
+    cout << "Evicted: " << evicted << "\n";
+    cout << "Contains 2: " << (lru.contains(2) ? "Yes" : "No") << ", get(3): " << *lru.get(3) << "\n";
+    lru.get(42);
+    cout << "Hits: " << lru.hits() << ", misses: " << lru.misses() << ", evictions: " << lru.evictions() << "\n";
+    cout << "Erase 5: " << (lru.erase(5) ? "Yes" : "No") << ", size " << lru.size() << "\n";
+    
+    // Byte budget, charged by string length
+    LruCache<string, string> bytes(CacheCapacity::bytes(20),
+                                   [](const string& k, const string& v) { return k.size() + v.size(); });
+    bytes.put("a", "123456789");   // 10 bytes
+    bytes.put("b", "12345678");    // 9 bytes
+    bytes.put("c", "1234");        // 5 bytes, evicts "a"
+    cout << "Byte cache: size " << bytes.size() << ", " << bytes.bytes_used() << " bytes, has a: "
+         << (bytes.contains("a") ? "Yes" : "No") << "\n";
+    cout << "Oversized put: " << (bytes.put("big", string(30, 'x')) ? "Yes" : "No") << "\n";
+    
+    // Growing a hot entry must evict around it, never the entry itself
+    ClockCache<int, string> grow(CacheCapacity::bytes(10), [](const int&, const string& v) { return v.size(); });
+    grow.put(1, "aaaaa");
+    grow.put(2, "bbbb");
+    for (int i = 0; i < 3; ++i) grow.get(2);
+    bool grew = grow.put(1, "ccccccc");
+    cout << "Grow in place: " << (grew ? "Yes" : "No") << ", has 1: " << (grow.contains(1) ? "Yes" : "No")
+         << ", has 2: " << (grow.contains(2) ? "Yes" : "No") << "\n";
+    
+    LruCache<string, int> viewKeys(CacheCapacity::entries(2));
+    viewKeys.put(string_view("view"), 1);
+    cout << "Put through string_view: " << (viewKeys.contains("view") ? "Yes" : "No") << "\n";
+    
+    // A one-off scan pushes hot keys out of an LRU but not out of a CLOCK
+    LruCache<int, int> lruScan(CacheCapacity::entries(8));
+    ClockCache<int, int> clockScan(CacheCapacity::entries(8));
+    for (int round = 0; round < 3; ++round) {
+        for (int k = 0; k < 4; ++k) {
+            if (!lruScan.get(k)) lruScan.put(k, k);
+            if (!clockScan.get(k)) clockScan.put(k, k);
+        }
+    }
+    for (int k = 100; k < 108; ++k) {
+        lruScan.put(k, k);
+        clockScan.put(k, k);
+    }
+    int lruHot = 0, clockHot = 0;
+    for (int k = 0; k < 4; ++k) {
+        lruHot += lruScan.contains(k);
+        clockHot += clockScan.contains(k);
+    }
+    cout << "Hot keys surviving a scan: LRU " << lruHot << "/4, CLOCK " << clockHot << "/4\n";
+    
+    // Sharded front end hit from several threads
+    ShardedLruCache<int, int, 4> sharded(CacheCapacity::entries(400));
+    Vector<thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.push_back(thread([&sharded, t] {
+            for (int i = 0; i < 2000; ++i) {
+                int k = (i * 7 + t) % 300;
+                if (!sharded.get(k)) sharded.put(k, k * 2);
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+    optional<int> v = sharded.get(21);
+    CacheStats total = sharded.stats();
+    cout << "Sharded: size " << sharded.size() << ", get(21) = " << (v ? *v : -1) << ", lookups "
+         << total.hits + total.misses << "\n";
+}
+
+void testArtMap() {
+    cout << "\n=== TESTING ADAPTIVE RADIX TREE MAP ===\n";
+    
+    ArtMap<string, int> routes;
+    routes.insert("/api/v1/users", 1);
+    routes.insert("/api/v1/orders", 2);
+    routes.insert("/api", 3);                // a prefix of the others
+    routes.insert("/api/v2/users", 4);
+    routes.insert("/health", 5);
+    routes.insert("/api/v1/users", 10);      // overwrite
+    routes["/api/v1/users/me"] = 6;
+    routes.print();
+    cout << "Size: " << routes.size() << ", find /api/v1/users: " << *routes.find("/api/v1/users")
+         << ", contains /api/v1: " << (routes.contains(string_view("/api/v1")) ? "Yes" : "No") << "\n";
+    
+    cout << "Prefix /api/v1/: ";
+    routes.for_each_prefix("/api/v1/", [](const string& k, int v) { cout << k << "=" << v << " "; });
+    cout << "\n";
+    
+    routes.erase("/api");
+    routes.erase("/api/v1/orders");
+    routes.erase("/missing");
+    cout << "After erase: ";
+    routes.for_each([](const string& k, int) { cout << k << " "; });
+    cout << "\n";
+    
+    // Integer keys sort numerically, negatives first; enough of them to
+    // grow inner nodes through every size and back
+    ArtMap<long long, int> numbers;
+    for (long long k = -300; k < 300; ++k) numbers.insert(k * 1000003, static_cast<int>(k));
+    long long previous = numeric_limits<long long>::min();
+    bool ordered = true;
+    numbers.for_each([&](long long k, int) {
+        ordered = ordered && k > previous;
+        previous = k;
+    });
+    for (long long k = -300; k < 290; ++k) numbers.erase(k * 1000003);
+    cout << "Integers ordered: " << (ordered ? "Yes" : "No") << ", left after erase: " << numbers.size()
+         << ", find 295*1000003: " << *numbers.find(295LL * 1000003) << "\n";
+    
+    ArtMap<long long, int> copy = numbers.clone();
+    numbers.erase(295LL * 1000003);
+    cout << "Clone size: " << copy.size() << " (original " << numbers.size() << ")\n";
+}
+
+void testStringPool() {
+    cout << "\n=== TESTING STRING POOL AND INTERNED CONTAINERS ===\n";
+    
+    StringPool pool;
+    InternedId get = pool.intern("GET");
+    InternedId post = pool.intern("POST");
+    InternedId again = pool.intern(string("GE") + "T");
+    cout << "GET == GET again: " << (get == again ? "Yes" : "No") << ", GET == POST: " << (get == post ? "Yes" : "No")
+         << ", distinct strings: " << pool.size() << "\n";
+    cout << "view(post): " << pool.view(post) << ", c_str(get): " << pool.c_str(get)
+         << ", find(PUT): " << (pool.find("PUT") ? "found" : "absent") << "\n";
+    
+    // Two maps keyed on the same strings share one copy of each
+    InternedMap<int> hits(pool);
+    InternedMap<string> owners(pool);
+    const char* paths[] = {"/index.html", "/about", "/index.html", "/contact", "/about", "/index.html"};
+    for (const char* path : paths) hits[path] += 1;
+    owners.insert("/index.html", "web");
+    owners.insert("/contact", "sales");
+    hits.print();
+    owners.print();
+    cout << "Pool after both maps: " << pool.size() << " strings, " << pool.string_bytes() << " bytes\n";
+    cout << "hits[/about]: " << *hits.find("/about") << ", owners has /about: "
+         << (owners.contains("/about") ? "Yes" : "No") << "\n";
+    hits.erase("/about");
+    cout << "After erase: " << hits.size() << " paths\n";
+    
+    InternedSet methods(pool);
+    methods.insert("GET");
+    methods.insert(post);
+    methods.insert("GET");
+    cout << "Set size: " << methods.size() << ", contains POST: " << (methods.contains("POST") ? "Yes" : "No") << "\n";
+    
+    // Ids order by interning; InternedLess orders by string
+    Map<InternedId, int, InternedLess> alphabetical(InternedLess{&pool});
+    alphabetical.insert(pool.intern("pear"), 1);
+    alphabetical.insert(pool.intern("apple"), 2);
+    alphabetical.insert(pool.intern("fig"), 3);
+    cout << "Alphabetical: ";
+    alphabetical.for_each([&](InternedId id, int v) { cout << pool.view(id) << "=" << v << " "; });
+    cout << "\n";
+    
+    Vector<InternedId> log;
+    for (int i = 0; i < 1000; ++i) log.push_back(i % 3 ? get : post);
+    cout << "Vector<InternedId> of 1000 requests: " << log.memory_usage().total() << " bytes\n";
+    
+    // A moved-from pool is an empty pool, not a broken one
+    StringPool moved(std::move(pool));
+    InternedId fresh = pool.intern("HEAD");
+    cout << "Moved pool: " << moved.size() << " strings, view(get): " << moved.view(get)
+         << "; source reused: " << pool.size() << " string, view: " << pool.view(fresh)
+         << ", find(GET): " << (pool.find("GET") ? "found" : "absent") << "\n";
+}
+
+void testBitmapSet() {
+    cout << "\n=== TESTING COMPRESSED BITMAP SET ===\n";
+    
+    BitmapSet<int> ids;
+    for (int v : {42, -7, 70000, 3, 42, 65536}) ids.insert(v);
+    ids.print();
+    cout << "Size: " << ids.size() << ", contains 70000: " << (ids.contains(70000) ? "Yes" : "No")
+         << ", contains 4: " << (ids.contains(4) ? "Yes" : "No") << ", min " << ids.min() << ", max " << ids.max() << "\n";
+    ids.erase(3);
+    ids.erase(1000);
+    cout << "After erase: size " << ids.size() << "\n";
+    
+    // A chunk switches from array to bitmap past 4096 values and back
+    BitmapSet<uint32_t> dense;
+    for (uint32_t v = 0; v < 10000; v += 2) dense.insert(v);
+    size_t denseBytes = dense.memory_usage().total();
+    for (uint32_t v = 0; v < 10000; v += 2) {
+        if (v % 10) dense.erase(v);
+    }
+    cout << "5000 values: " << denseBytes << " bytes; after erasing 80%: " << dense.memory_usage().total()
+         << " bytes, size " << dense.size() << "\n";
+    
+    // One million consecutive ids in a handful of runs
+    BitmapSet<uint32_t> range;
+    range.insert_range(1000000, 1999999);
+    range.insert(5);
+    cout << "Range: size " << range.size() << ", " << range.memory_usage().total() << " bytes, contains 1500000: "
+         << (range.contains(1500000) ? "Yes" : "No") << "\n";
+    
+    BitmapSet<uint32_t> evens, threes;
+    for (uint32_t v = 0; v < 100000; v += 2) evens.insert(v);
+    for (uint32_t v = 0; v < 100000; v += 3) threes.insert(v);
+    cout << "Evens & threes: " << evens.intersection_size(threes) << ", evens | threes: " << evens.union_size(threes)
+         << "\n";
+    BitmapSet<uint32_t> sixes = evens.clone();
+    sixes.intersect(threes);
+    evens.unite(threes);
+    cout << "Intersect size " << sixes.size() << ", unite size " << evens.size() << "\n";
+    
+    // optimize() re-encodes a bitmap of a few long runs as runs
+    BitmapSet<uint32_t> blocks;
+    for (uint32_t v = 0; v < 60000; ++v) {
+        if ((v / 10000) % 2 == 0) blocks.insert(v);
+    }
+    size_t before = blocks.memory_usage().total();
+    blocks.optimize();
+    cout << "Blocks before optimize: " << before << " bytes, after: " << blocks.memory_usage().total() << " bytes\n";
+    
+    // Scattered inserts into a run chunk turn it back into a bitmap
+    BitmapSet<uint32_t> seeded;
+    seeded.insert_range(0, 0);
+    for (uint32_t v = 2; v < 65536; v += 2) seeded.insert(v);
+    cout << "Run-seeded evens: size " << seeded.size() << ", " << seeded.memory_usage().total() << " bytes, contains 4096: "
+         << (seeded.contains(4096) ? "Yes" : "No") << ", contains 4097: " << (seeded.contains(4097) ? "Yes" : "No") << "\n";
+}
+
+void testConcurrentStack() {
+    cout << "\n=== TESTING LOCK-FREE CONCURRENT STACK ===\n";
+    
+    ConcurrentStack<string> words;
+    words.push("alpha");
+    words.push(string("beta"));
+    words.emplace(3, 'g');
+    words.print();
+    optional<string> top = words.pop();
+    cout << "Popped: " << *top << ", size " << words.size() << "\n";
+    
+    // A chain is built privately and published with one CAS
+    auto chain = words.make_chain();
+    for (const char* w : {"x", "y", "z"}) chain.push(w);
+    cout << "Chain of " << chain.size() << ", top " << chain.top() << "\n";
+    words.push_chain(std::move(chain));
+    words.print();
+    
+    auto batch = words.pop_batch(2);
+    cout << "Batch of " << batch.size() << ": ";
+    batch.for_each([](const string& w) { cout << w << " "; });
+    cout << "\n";
+    auto rest = words.pop_all();
+    cout << "Rest: " << rest.size() << ", stack empty: " << (words.empty() ? "Yes" : "No") << "\n";
+    rest.clear();
+    words.memory_usage().print();
+    
+    // A shared pool of buffers: every thread takes one, uses it, puts it back
+    ConcurrentStack<int> pool;
+    const int BUFFERS = 16;
+    for (int i = 0; i < BUFFERS; ++i) pool.push(i);
+    atomic<long> uses(0);
+    Vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.push_back(thread([&] {
+            for (int i = 0; i < 20000; ++i) {
+                if (i % 8 == 0) {
+                    auto taken = pool.pop_batch(4);
+                    uses += taken.size();
+                    pool.push_chain(std::move(taken));
+                } else if (optional<int> buffer = pool.pop()) {
+                    ++uses;
+                    pool.push(*buffer);
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    long sum = 0;
+    auto all = pool.pop_all();
+    all.for_each([&](int b) { sum += b; });
+    cout << "Buffers back: " << all.size() << ", id sum " << sum << " (expect " << BUFFERS * (BUFFERS - 1) / 2
+         << "), uses > 0: " << (uses > 0 ? "Yes" : "No") << "\n";
+}
+
+void testBalancePolicies() {
+    cout << "\n=== TESTING TREE BALANCING POLICIES ===\n";
+    
+    Map<int, string, less<int>, AvlBalance> avl;
+    Map<int, string, less<int>, WavlBalance> wavl;
+    Map<int, string, less<int>, RedBlackBalance> redBlack;
+    for (int i = 1; i <= 1000; ++i) {
+        avl.insert(i, to_string(i));
+        wavl.insert(i, to_string(i));
+        redBlack.insert(i, to_string(i));
+    }
+    cout << "Ascending inserts, heights: AVL " << avl.height() << ", WAVL " << wavl.height() << ", red-black "
+         << redBlack.height() << "\n";
+    avl.balance_stats().print();
+    redBlack.balance_stats().print();
+    
+    avl.reset_balance_stats();
+    wavl.reset_balance_stats();
+    redBlack.reset_balance_stats();
+    for (int i = 1; i <= 1000; i += 3) {
+        avl.erase(i);
+        wavl.erase(i);
+        redBlack.erase(i);
+    }
+    cout << "After erasing a third: sizes " << avl.size() << "/" << wavl.size() << "/" << redBlack.size()
+         << ", find(500): " << *redBlack.find(500) << ", contains(499): " << (wavl.contains(499) ? "Yes" : "No")
+         << "\n";
+    cout << "Erase rotations: AVL " << avl.balance_stats().rotations << ", WAVL " << wavl.balance_stats().rotations
+         << ", red-black " << redBlack.balance_stats().rotations << "\n";
+    
+    // The policy is invisible to everything else
+    Set<int, less<int>, WavlBalance> left;
+    Set<int, less<int>, WavlBalance> right;
+    for (int i = 0; i < 10; ++i) (i % 2 ? left : right).insert(i);
+    left.merge(right);
+    auto node = left.extract(4);
+    node.value() = 40;
+    left.insert(std::move(node));
+    left.print();
+    cout << "Min " << left.min() << ", max " << left.max() << "\n";
+}
+
+void testMappedVector() {
+    cout << "\n=== TESTING MMAP-BACKED VECTOR STORAGE ===\n";
+    
+    // Past 2 MiB the buffer is mapped, and growth extends the mapping
+    Vector<long, MappedStorage<>> big;
+    for (long i = 0; i < 1000000; ++i) big.push_back(i);
+    big.push_back(big[0]);   // the argument lives in the buffer that moves
+    long sum = 0;
+    for (size_t i = 0; i < big.size(); ++i) sum += big[i];
+    cout << "Size " << big.size() << ", capacity " << big.capacity() << ", sum " << sum << ", back " << big.back()
+         << "\n";
+    big.memory_usage().print();
+    
+    Vector<int, MappedStorage<true>> filled;
+    filled.resize(3000000, 7);
+    filled.resize(4000000, filled[0]);
+    filled.insert(1, 8);
+    cout << "Prefaulted: size " << filled.size() << ", [0..2] " << filled[0] << " " << filled[1] << " " << filled[2]
+         << ", last " << filled.back() << "\n";
+    
+    // Elements that are not trivially relocatable are moved one by one
+    Vector<string, MappedStorage<>> words;
+    for (int i = 0; i < 100000; ++i) {
+        string word("w");
+        word += to_string(i);
+        words.push_back(std::move(word));
+    }
+    cout << "Strings: " << words.size() << ", last " << words.back() << "\n";
+}
+
+void testSparseMap() {
+    cout << "\n=== TESTING SPARSE SET / SPARSE MAP ===\n";
+    
+    SparseMap<string> names;
+    names.insert(3, "player");
+    names.insert(10, "door");
+    names.insert(7, "torch");
+    names[12] = "chest";
+    names.insert(10, "gate");
+    names.print();
+    cout << "find(7): " << *names.find(7) << ", contains(4): " << (names.contains(4) ? "Yes" : "No") << "\n";
+    
+    // Erasing moves the last entry into the hole, keeping values packed
+    names.erase(3);
+    names.erase(99);
+    names.print();
+    cout << "Dense order: ";
+    for (size_t i = 0; i < names.size(); ++i) cout << names.key_at(i) << "=" << names.value_at(i) << " ";
+    cout << "\n";
+    
+    // clear() starts a new generation instead of touching the sparse array
+    SparseSet<> alive;
+    alive.reserve(100000, 1000);
+    for (uint32_t id = 0; id < 100000; id += 100) alive.insert(id);
+    size_t before = alive.memory_usage().total();
+    alive.clear();
+    cout << "After clear: size " << alive.size() << ", contains 500: " << (alive.contains(500) ? "Yes" : "No")
+         << ", memory kept: " << (alive.memory_usage().total() == before ? "Yes" : "No") << "\n";
+    alive.insert(500);
+    alive.insert(500);
+    alive.print();
+    
+    SparseMap<int> counts;
+    for (int i = 0; i < 20; ++i) ++counts[static_cast<uint32_t>(i % 6)];
+    int total = 0;
+    counts.for_each([&](uint32_t id, int& n) { total += n * static_cast<int>(id); });
+    cout << "Counts: size " << counts.size() << ", weighted total " << total << "\n";
+    
+    // Signed ids work, but a negative one is never present
+    SparseMap<string, int> signedIds;
+    signedIds[7] = "seven";
+    try {
+        signedIds[-1] = "minus one";
+    } catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << "\n";
+    }
+    cout << "Signed-id map: size " << signedIds.size() << ", contains -1: "
+         << (signedIds.contains(-1) ? "Yes" : "No") << ", find(-1): " << (signedIds.find(-1) ? "found" : "null") << "\n";
+}
+
 void testEdgeCases() {
     cout << "\n=== TESTING EDGE CASES ===\n";
     
@@ -270,11 +1416,31 @@ int main() {
     
     try {
         testVector();
+        testVectorRelocation();
         testMap();
         testSet();
         testStack();
         testQueue();
         testLinkedList();
+        testPriorityQueue();
+        testPersistentMap();
+        testDeque();
+        testIntrusive();
+        testAsyncChannel();
+        testCompactTree();
+        testBloomFilter();
+        testNodeAllocator();
+        testStaticMap();
+        testConcurrentOrderedMap();
+        testTracer();
+        testLruCache();
+        testArtMap();
+        testStringPool();
+        testBitmapSet();
+        testConcurrentStack();
+        testBalancePolicies();
+        testMappedVector();
+        testSparseMap();
         performanceTest();
         testEdgeCases();
         
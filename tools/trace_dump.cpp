@@ -0,0 +1,94 @@
+// Decodes a binary trace written by Tracer::save() and prints it in time order:
+//
+//     trace_dump trace.bin             every event, oldest first
+//     trace_dump trace.bin --summary   event counts per type only
+#include "../include/debug.hpp"
+#include "../include/vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+// Arguments that carry an object's address print in hex
+void printArg(const char* name, uint64_t value) {
+    bool address = strcmp(name, "node") == 0 || strcmp(name, "queue") == 0;
+    cout << name << "=";
+    if (address) cout << "0x" << hex << value << dec;
+    else cout << value;
+}
+
+void printEvent(const TraceRecord& rec, uint64_t startTicks, double nsPerTick) {
+    TraceEventInfo info = traceEventInfo(rec.event);
+    double us = static_cast<double>(rec.ticks - startTicks) * nsPerTick / 1000.0;
+    cout << setw(14) << fixed << setprecision(3) << us << "  " << setw(6) << rec.thread << "  ";
+    if (info.name) cout << left << setw(20) << info.name << right;
+    else cout << "event#" << left << setw(14) << rec.event << right;
+    printArg(info.arg0, rec.args[0]);
+    cout << " ";
+    printArg(info.arg1, rec.args[1]);
+    cout << "\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " TRACE_FILE [--summary]\n";
+        return 2;
+    }
+    bool summary = argc > 2 && strcmp(argv[2], "--summary") == 0;
+
+    ifstream in(argv[1], ios::binary);
+    if (!in) {
+        cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    TraceFileHeader header;
+    Vector<TraceRecord> records;
+    if (!Tracer::load(in, header, [&](const TraceRecord& rec) { records.push_back(rec); })) {
+        cerr << argv[1] << ": not a trace file, or truncated\n";
+        return 1;
+    }
+    if (records.empty()) {
+        cout << "trace: no events\n";
+        return 0;
+    }
+
+    // Each thread's ring is in order already; interleave them by timestamp
+    TraceRecord* first = &records[0];
+    stable_sort(first, first + records.size(),
+                [](const TraceRecord& a, const TraceRecord& b) { return a.ticks < b.ticks; });
+    uint64_t startTicks = records[0].ticks;
+    uint32_t threads = 0;
+    for (size_t i = 0; i < records.size(); ++i) threads = max(threads, records[i].thread);
+    double spanUs = static_cast<double>(records.back().ticks - startTicks) * header.nsPerTick / 1000.0;
+    cout << "trace: " << records.size() << " events, " << threads << " threads, " << fixed << setprecision(3)
+         << spanUs << " us span\n";
+
+    if (summary) {
+        Vector<uint16_t> ids;
+        Vector<size_t> counts;
+        for (size_t i = 0; i < records.size(); ++i) {
+            size_t k = 0;
+            while (k < ids.size() && ids[k] != records[i].event) ++k;
+            if (k == ids.size()) {
+                ids.push_back(records[i].event);
+                counts.push_back(0);
+            }
+            ++counts[k];
+        }
+        for (size_t k = 0; k < ids.size(); ++k) {
+            const char* name = traceEventInfo(ids[k]).name;
+            if (name) cout << left << setw(20) << name << right;
+            else cout << "event#" << left << setw(14) << ids[k] << right;
+            cout << counts[k] << "\n";
+        }
+        return 0;
+    }
+
+    cout << setw(14) << "time(us)" << "  " << setw(6) << "thread" << "  event\n";
+    for (size_t i = 0; i < records.size(); ++i) printEvent(records[i], startTicks, header.nsPerTick);
+    return 0;
+}
\ No newline at end of file